@@ -36,7 +36,7 @@ export default function App() {
       {initData.view === "config" ? (
         <ConfigView config={initData.config!} />
       ) : (
-        <HistoryView initialHistory={initData.history ?? []} />
+        <HistoryView initialPage={initData.history} />
       )}
     </div>
   );
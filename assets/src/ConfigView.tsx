@@ -19,9 +19,11 @@ interface ConfigViewProps {
 
 export default function ConfigView({ config }: ConfigViewProps) {
   const [url, setUrl] = useState(config.url);
+  const [format, setFormat] = useState(config.format ?? "");
   const [interval, setInterval] = useState(config.interval);
   const [loggingEnabled, setLoggingEnabled] = useState(config.loggingEnabled);
   const [historyLimit, setHistoryLimit] = useState(String(config.historyLimit));
+  const [endpoints, setEndpoints] = useState(config.endpoints ?? "");
 
   // 0=none, 1=checking, 2=valid, 3=invalid
   const [validationState, setValidationState] = useState<number>(0);
@@ -37,13 +39,11 @@ export default function ConfigView({ config }: ConfigViewProps) {
     // Trigger initial validation if URL is non-empty
     if (config.url.trim()) {
       setValidationState(1);
-      validateUrl(config.url.trim());
+      validateUrl(config.url.trim(), (config.format ?? "").trim());
     }
-  }, [config.url, handleValidationResult]);
-
-  const handleUrlChange = (newUrl: string) => {
-    setUrl(newUrl);
+  }, [config.url, config.format, handleValidationResult]);
 
+  const scheduleValidation = (newUrl: string, newFormat: string) => {
     if (debounceRef.current) clearTimeout(debounceRef.current);
 
     const trimmed = newUrl.trim();
@@ -54,23 +54,35 @@ export default function ConfigView({ config }: ConfigViewProps) {
 
     setValidationState(1);
     debounceRef.current = setTimeout(() => {
-      validateUrl(trimmed);
+      validateUrl(trimmed, newFormat.trim());
     }, 500);
   };
 
+  const handleUrlChange = (newUrl: string) => {
+    setUrl(newUrl);
+    scheduleValidation(newUrl, format);
+  };
+
+  const handleFormatChange = (newFormat: string) => {
+    setFormat(newFormat);
+    scheduleValidation(url, newFormat);
+  };
+
   const handleSave = () => {
     const trimmedUrl = url.trim();
     if (!trimmedUrl) return;
 
     let hl = parseInt(historyLimit, 10);
     if (isNaN(hl) || hl < 10) hl = 10;
-    if (hl > 10000) hl = 10000;
+    if (hl > 100000) hl = 100000;
 
     saveSettings({
       url: trimmedUrl,
       interval,
       loggingEnabled,
       historyLimit: hl,
+      format: format.trim(),
+      endpoints,
     });
   };
 
@@ -100,6 +112,21 @@ export default function ConfigView({ config }: ConfigViewProps) {
         />
       </div>
 
+      <div data-row className="flex items-start justify-between gap-3">
+        <div className="flex flex-col shrink-0">
+          <Label htmlFor="format">Response Format</Label>
+          <span className="text-[10px] text-neutral-500 leading-tight mt-1.5">xml, json:path=value,<br />text:keyword, http</span>
+        </div>
+        <Input
+          id="format"
+          value={format}
+          onChange={(e) => handleFormatChange(e.target.value)}
+          placeholder="xml"
+          spellCheck={false}
+          className="w-40"
+        />
+      </div>
+
       <div data-row className="flex items-center justify-between">
         <Label>API URL Status</Label>
         {validationBadge()}
@@ -133,18 +160,34 @@ export default function ConfigView({ config }: ConfigViewProps) {
       </div>
 
       <div data-row className="flex items-center justify-between">
-        <Label htmlFor="history-limit">History Limit (10-10000)</Label>
+        <Label htmlFor="history-limit">History Limit (10-100000)</Label>
         <Input
           id="history-limit"
           type="number"
           min={10}
-          max={10000}
+          max={100000}
           value={historyLimit}
           onChange={(e) => setHistoryLimit(e.target.value)}
           className="w-40"
         />
       </div>
 
+      <div data-row className="flex items-start justify-between gap-3">
+        <div className="flex flex-col shrink-0">
+          <Label htmlFor="endpoints">Additional Endpoints</Label>
+          <span className="text-[10px] text-neutral-500 leading-tight mt-1.5">One URL per line,<br />optional interval (s)<br />and format</span>
+        </div>
+        <textarea
+          id="endpoints"
+          value={endpoints}
+          onChange={(e) => setEndpoints(e.target.value)}
+          placeholder="https://example.com/health 120"
+          rows={3}
+          spellCheck={false}
+          className="flex-1 min-w-0 rounded-md border border-neutral-300 bg-transparent px-3 py-1 text-xs shadow-sm focus-visible:outline-none focus-visible:ring-1 focus-visible:ring-neutral-400"
+        />
+      </div>
+
       <div className="flex justify-end gap-2 pt-1">
         <Button variant="outline" size="sm" className="min-w-[5rem]" onClick={() => closeDialog()}>
           Cancel
@@ -1,35 +1,100 @@
-import { useState, useEffect, useCallback } from "react";
+import { useState, useEffect, useLayoutEffect, useCallback, useRef } from "react";
 import { Button } from "./components/ui/button";
 import {
-  onHistoryUpdate,
+  onHistoryPage,
+  onHistoryAppend,
+  getHistoryPage,
   clearHistory,
   closeDialog,
   type HistoryEntry,
+  type HistoryPage,
 } from "./lib/bridge";
 
+// Rows are kept to one line so only the visible ones need to exist
+const ROW_HEIGHT = 28;
+const VIEW_HEIGHT = 400;
+const OVERSCAN = 10;
+const PAGE_SIZE = 100;
+
 interface HistoryViewProps {
-  initialHistory: HistoryEntry[];
+  initialPage?: HistoryPage;
 }
 
-export default function HistoryView({ initialHistory }: HistoryViewProps) {
-  const [history, setHistory] = useState<HistoryEntry[]>(initialHistory);
-  const [selectedIndex, setSelectedIndex] = useState<number>(-1);
+export default function HistoryView({ initialPage }: HistoryViewProps) {
+  // Loaded entries by ID; IDs stay fixed while display indices shift
+  const entriesRef = useRef(new Map<number, HistoryEntry>());
+  const pendingRef = useRef(new Set<number>());
+  const scrollRef = useRef<HTMLDivElement>(null);
+  const newestRef = useRef(-1);
+  const shiftRef = useRef(0);
+  const [total, setTotal] = useState(0);
+  const [newest, setNewest] = useState(-1);
+  const [showEndpoint, setShowEndpoint] = useState(false);
+  const [, setVersion] = useState(0);
+  const [scrollTop, setScrollTop] = useState(0);
+  const [selectedId, setSelectedId] = useState<number>(-1);
 
-  const handleHistoryUpdate = useCallback((entries: HistoryEntry[]) => {
-    setHistory(entries);
-    setSelectedIndex(-1);
+  const applyPage = useCallback((page: HistoryPage) => {
+    const entries = entriesRef.current;
+    const oldest = page.newest - page.total + 1;
+    for (const id of entries.keys()) {
+      if (id < oldest || id > page.newest) entries.delete(id);
+    }
+    for (const entry of page.entries) entries.set(entry.id, entry);
+    pendingRef.current.delete(page.offset);
+    newestRef.current = page.newest;
+    setTotal(page.total);
+    setNewest(page.newest);
+    setShowEndpoint(page.showEndpoint);
+    setSelectedId((id) => (entries.has(id) ? id : -1));
+    setVersion((v) => v + 1);
   }, []);
 
+  // Only the visible rows re-render; rows being read stay in place while new
+  // ones arrive above them
+  const applyAppend = useCallback((delta: HistoryPage) => {
+    const added = delta.newest - newestRef.current;
+    const el = scrollRef.current;
+    if (el && el.scrollTop > 0 && added > 0) shiftRef.current += added * ROW_HEIGHT;
+    applyPage(delta);
+  }, [applyPage]);
+
+  useLayoutEffect(() => {
+    const el = scrollRef.current;
+    if (el && shiftRef.current) {
+      el.scrollTop += shiftRef.current;
+      shiftRef.current = 0;
+    }
+  }, [newest]);
+
+  useEffect(() => {
+    if (initialPage) applyPage(initialPage);
+    onHistoryPage(applyPage);
+    onHistoryAppend(applyAppend);
+  }, [initialPage, applyPage, applyAppend]);
+
+  const first = Math.max(0, Math.floor(scrollTop / ROW_HEIGHT) - OVERSCAN);
+  const last = Math.min(total, Math.ceil((scrollTop + VIEW_HEIGHT) / ROW_HEIGHT) + OVERSCAN);
+
+  // Request the pages covering any visible row not loaded yet
   useEffect(() => {
-    onHistoryUpdate(handleHistoryUpdate);
-  }, [handleHistoryUpdate]);
+    for (let i = first; i < last; i++) {
+      if (entriesRef.current.has(newest - i)) continue;
+      const offset = Math.floor(i / PAGE_SIZE) * PAGE_SIZE;
+      if (!pendingRef.current.has(offset)) {
+        pendingRef.current.add(offset);
+        getHistoryPage(offset, PAGE_SIZE);
+      }
+      i = offset + PAGE_SIZE - 1;
+    }
+  }, [first, last, newest, total]);
 
   const handleCopy = useCallback(() => {
-    if (selectedIndex < 0 || selectedIndex >= history.length) return;
-    const entry = history[selectedIndex];
-    const text = `${entry.time}\nFrom ${entry.from} to ${entry.to}\n${entry.message}`;
+    const entry = entriesRef.current.get(selectedId);
+    if (!entry) return;
+    const text = `${entry.time}\n${entry.endpoint ? `${entry.endpoint}\n` : ""}From ${entry.from} to ${entry.to}\n${entry.message}${entry.timings ? `\n${entry.timings}` : ""}`;
     navigator.clipboard.writeText(text).catch(() => {});
-  }, [selectedIndex, history]);
+  }, [selectedId]);
 
   useEffect(() => {
     const handler = (e: KeyboardEvent) => {
@@ -41,40 +106,75 @@ export default function HistoryView({ initialHistory }: HistoryViewProps) {
     return () => window.removeEventListener("keydown", handler);
   }, [handleCopy]);
 
+  const rows = [];
+  for (let i = first; i < last; i++) {
+    const id = newest - i;
+    const entry = entriesRef.current.get(id);
+    rows.push(
+      <tr
+        key={id}
+        style={{ height: ROW_HEIGHT }}
+        className={`border-b border-neutral-100 cursor-pointer transition-colors ${
+          selectedId === id
+            ? "bg-neutral-900 text-white"
+            : "hover:bg-neutral-50"
+        }`}
+        onClick={() => entry && setSelectedId(id)}
+      >
+        {entry ? (
+          <>
+            <td className="px-3 whitespace-nowrap">{entry.time}</td>
+            {showEndpoint && <td className="px-3 truncate" title={entry.endpoint}>{entry.endpoint}</td>}
+            <td className="px-3 whitespace-nowrap">{entry.from}</td>
+            <td className="px-3 whitespace-nowrap">{entry.to}</td>
+            <td className="px-3 truncate" title={entry.message}>{entry.message}</td>
+            <td className="px-3 whitespace-nowrap text-right" title={entry.timings}>
+              {entry.timings ? entry.timings.split(" (")[0] : ""}
+            </td>
+          </>
+        ) : (
+          <td className="px-3 text-neutral-300" colSpan={showEndpoint ? 6 : 5}>…</td>
+        )}
+      </tr>
+    );
+  }
+
   return (
     <div className="p-4 flex flex-col gap-3" style={{ minHeight: "100%" }}>
-      <div className="flex-1 overflow-y-auto border border-neutral-200 rounded-md" style={{ maxHeight: "400px" }}>
-        {history.length === 0 ? (
+      <div
+        ref={scrollRef}
+        className="flex-1 overflow-y-auto border border-neutral-200 rounded-md"
+        style={{ maxHeight: `${VIEW_HEIGHT}px` }}
+        onScroll={(e) => setScrollTop(e.currentTarget.scrollTop)}
+      >
+        {total === 0 ? (
           <div className="p-6 text-center text-sm text-neutral-400">
             No status changes recorded yet.
           </div>
         ) : (
-          <table className="w-full text-xs">
+          <table className="w-full text-xs table-fixed">
+            <colgroup>
+              <col style={{ width: "9.5rem" }} />
+              {showEndpoint && <col style={{ width: "25%" }} />}
+              <col style={{ width: "4.5rem" }} />
+              <col style={{ width: "4.5rem" }} />
+              <col />
+              <col style={{ width: "4.5rem" }} />
+            </colgroup>
             <thead className="bg-neutral-50 sticky top-0">
               <tr className="border-b border-neutral-200">
                 <th className="text-left px-3 py-2 font-medium text-neutral-600">Time</th>
+                {showEndpoint && <th className="text-left px-3 py-2 font-medium text-neutral-600">Endpoint</th>}
                 <th className="text-left px-3 py-2 font-medium text-neutral-600">From</th>
                 <th className="text-left px-3 py-2 font-medium text-neutral-600">To</th>
                 <th className="text-left px-3 py-2 font-medium text-neutral-600">Message</th>
+                <th className="text-right px-3 py-2 font-medium text-neutral-600">Took</th>
               </tr>
             </thead>
             <tbody>
-              {history.map((entry, i) => (
-                <tr
-                  key={i}
-                  className={`border-b border-neutral-100 cursor-pointer transition-colors ${
-                    selectedIndex === i
-                      ? "bg-neutral-900 text-white"
-                      : "hover:bg-neutral-50"
-                  }`}
-                  onClick={() => setSelectedIndex(i)}
-                >
-                  <td className="px-3 py-1.5 whitespace-nowrap">{entry.time}</td>
-                  <td className="px-3 py-1.5 whitespace-nowrap">{entry.from}</td>
-                  <td className="px-3 py-1.5 whitespace-nowrap">{entry.to}</td>
-                  <td className="px-3 py-1.5">{entry.message}</td>
-                </tr>
-              ))}
+              {first > 0 && <tr style={{ height: first * ROW_HEIGHT }} />}
+              {rows}
+              {last < total && <tr style={{ height: (total - last) * ROW_HEIGHT }} />}
             </tbody>
           </table>
         )}
@@ -4,6 +4,8 @@ export interface ConfigData {
   loggingEnabled: boolean;
   historyLimit: number;
   logPath?: string;
+  format?: string;
+  endpoints?: string;
 }
 
 export interface ValidationResult {
@@ -11,32 +13,73 @@ export interface ValidationResult {
 }
 
 export interface HistoryEntry {
+  id: number;
   time: string;
+  endpoint?: string;
   from: string;
   to: string;
   message: string;
+  timings?: string;   // "812 ms (dns 12, connect 30, ...)" of the poll behind the change, empty if not timed
+}
+
+// A slice of the history, newest first; entry i of the slice is display index offset + i
+export interface HistoryPage {
+  offset: number;
+  total: number;
+  newest: number; // ID of display index 0
+  showEndpoint: boolean;
+  entries: HistoryEntry[];
+}
+
+export type MetricsResolution = "raw" | "minute" | "hour";
+
+// One poll (raw) or one minute/hour rollup; latencies in milliseconds
+export interface MetricsPoint {
+  time: string;
+  latency?: number;
+  bytes?: number;
+  attempts?: number;
+  ok?: boolean;
+  count?: number;
+  errors?: number;
+  min?: number;
+  avg?: number;
+  p95?: number;
+  max?: number;
+}
+
+export interface MetricsData {
+  url: string;
+  resolution: MetricsResolution;
+  points: MetricsPoint[];
 }
 
 export interface InitData {
   view: "config" | "history";
   config?: ConfigData;
-  history?: HistoryEntry[];
+  history?: HistoryPage;
 }
 
 type InitCallback = (data: InitData) => void;
 type ValidationCallback = (result: ValidationResult) => void;
-type HistoryUpdateCallback = (entries: HistoryEntry[]) => void;
+type HistoryPageCallback = (page: HistoryPage) => void;
+type MetricsCallback = (data: MetricsData) => void;
 
 let initCallback: InitCallback | null = null;
 let validationCallback: ValidationCallback | null = null;
-let historyUpdateCallback: HistoryUpdateCallback | null = null;
+let historyPageCallback: HistoryPageCallback | null = null;
+let historyAppendCallback: HistoryPageCallback | null = null;
+let pendingAppend: HistoryPage | null = null;
+let metricsCallback: MetricsCallback | null = null;
 
 // Extend window for C <-> JS bridge
 declare global {
   interface Window {
     onInit: (data: InitData) => void;
     onValidationResult: (result: ValidationResult) => void;
-    onHistoryUpdate: (entries: HistoryEntry[]) => void;
+    onHistoryPage: (page: HistoryPage) => void;
+    onHistoryAppend: (delta: HistoryPage) => void;
+    onMetrics: (data: MetricsData) => void;
     chrome?: {
       webview?: {
         postMessage: (s: string) => void;
@@ -54,8 +97,27 @@ window.onValidationResult = (result: ValidationResult) => {
   validationCallback?.(result);
 };
 
-window.onHistoryUpdate = (entries: HistoryEntry[]) => {
-  historyUpdateCallback?.(entries);
+window.onHistoryPage = (page: HistoryPage) => {
+  historyPageCallback?.(page);
+};
+
+// New entries (newest first). Deltas arriving within one frame are merged
+// and delivered together.
+window.onHistoryAppend = (delta: HistoryPage) => {
+  if (pendingAppend) {
+    pendingAppend = { ...delta, entries: [...delta.entries, ...pendingAppend.entries] };
+    return;
+  }
+  pendingAppend = delta;
+  requestAnimationFrame(() => {
+    const merged = pendingAppend;
+    pendingAppend = null;
+    if (merged) historyAppendCallback?.(merged);
+  });
+};
+
+window.onMetrics = (data: MetricsData) => {
+  metricsCallback?.(data);
 };
 
 export function onInit(cb: InitCallback) {
@@ -66,8 +128,16 @@ export function onValidation(cb: ValidationCallback) {
   validationCallback = cb;
 }
 
-export function onHistoryUpdate(cb: HistoryUpdateCallback) {
-  historyUpdateCallback = cb;
+export function onHistoryPage(cb: HistoryPageCallback) {
+  historyPageCallback = cb;
+}
+
+export function onHistoryAppend(cb: HistoryPageCallback) {
+  historyAppendCallback = cb;
+}
+
+export function onMetrics(cb: MetricsCallback) {
+  metricsCallback = cb;
 }
 
 function postMessage(msg: Record<string, unknown>) {
@@ -82,8 +152,8 @@ export function getInit() {
   postMessage({ action: "getInit" });
 }
 
-export function validateUrl(url: string) {
-  postMessage({ action: "validateUrl", url });
+export function validateUrl(url: string, format: string) {
+  postMessage({ action: "validateUrl", url, format });
 }
 
 export function saveSettings(config: ConfigData) {
@@ -93,9 +163,20 @@ export function saveSettings(config: ConfigData) {
     interval: config.interval,
     loggingEnabled: config.loggingEnabled,
     historyLimit: config.historyLimit,
+    format: config.format ?? "",
+    endpoints: config.endpoints ?? "",
   });
 }
 
+// url defaults to the primary API URL; hours limits how far back to go
+export function getMetrics(url: string, resolution: MetricsResolution, hours = 0) {
+  postMessage({ action: "getMetrics", url, resolution, hours });
+}
+
+export function getHistoryPage(offset: number, limit: number) {
+  postMessage({ action: "getHistoryPage", offset, limit });
+}
+
 export function clearHistory() {
   postMessage({ action: "clearHistory" });
 }
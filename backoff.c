@@ -0,0 +1,45 @@
+// backoff.c
+#include "backoff.h"
+
+unsigned backoff_random(unsigned* state) {
+    unsigned x = *state ? *state : 0x9E3779B9u;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+unsigned backoff_jitter(unsigned baseMs, unsigned capMs, int n, unsigned* rng) {
+    unsigned long long ceiling = baseMs;
+    for (int i = 0; i < n && ceiling < capMs; i++) ceiling *= 2;
+    if (ceiling > capMs) ceiling = capMs;
+    return (unsigned)(backoff_random(rng) % (ceiling + 1));
+}
+
+void breaker_init(Breaker* b) {
+    b->state = BREAKER_CLOSED;
+    b->errors = 0;
+}
+
+int breaker_probe(Breaker* b) {
+    if (b->state != BREAKER_OPEN) return 0;
+    b->state = BREAKER_HALF_OPEN;
+    return 1;
+}
+
+BreakerChange breaker_record(Breaker* b, int threshold, int error) {
+    if (!error) {
+        BreakerState was = b->state;
+        b->state = BREAKER_CLOSED;
+        b->errors = 0;
+        return was == BREAKER_CLOSED ? BREAKER_UNCHANGED : BREAKER_CLOSED_AGAIN;
+    }
+
+    b->errors++;
+    if (b->state == BREAKER_HALF_OPEN || (b->state == BREAKER_CLOSED && threshold > 0 && b->errors >= threshold)) {
+        b->state = BREAKER_OPEN;
+        return BREAKER_OPENED;
+    }
+    return BREAKER_UNCHANGED;
+}
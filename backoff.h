@@ -0,0 +1,48 @@
+// backoff.h
+// Retry backoff and circuit breaker for failing endpoints.
+//
+// Delays use full jitter: a uniformly random delay between 0 and a ceiling
+// that doubles with every consecutive failure (base * 2^n, capped), so
+// clients that failed together spread out instead of retrying in lockstep.
+//
+// The breaker counts consecutive errors. Once the threshold is reached it
+// opens and the caller stops polling for the open period; the first poll
+// after that is a single probe (half-open) whose outcome closes the breaker
+// or opens it again.
+// Not thread-safe: each Breaker and random state belongs to one caller.
+#ifndef BACKOFF_H
+#define BACKOFF_H
+
+typedef enum {
+    BREAKER_CLOSED,               // Polling normally
+    BREAKER_OPEN,                 // Too many errors, not polling until the open period ends
+    BREAKER_HALF_OPEN             // One probe in flight
+} BreakerState;
+
+typedef enum {
+    BREAKER_UNCHANGED,
+    BREAKER_OPENED,               // Threshold reached, or the probe failed
+    BREAKER_CLOSED_AGAIN          // The probe succeeded
+} BreakerChange;
+
+typedef struct {
+    BreakerState state;
+    int errors;                   // Consecutive errors
+} Breaker;
+
+// Next value of a xorshift32 generator; *state must not be 0
+unsigned backoff_random(unsigned* state);
+
+// Random delay in [0, min(capMs, baseMs * 2^n)]
+unsigned backoff_jitter(unsigned baseMs, unsigned capMs, int n, unsigned* rng);
+
+void breaker_init(Breaker* b);
+
+// Called when an open breaker's period has ended: the next poll is the probe.
+// Returns 1 if the breaker moved to half-open.
+int breaker_probe(Breaker* b);
+
+// Counts a poll outcome; threshold 0 never opens the breaker
+BreakerChange breaker_record(Breaker* b, int threshold, int error);
+
+#endif // BACKOFF_H
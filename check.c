@@ -0,0 +1,227 @@
+// check.c
+#include "check.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK_OP_FINISHED 2
+
+void check_buffer_init(CheckBuffer* buf, size_t max) {
+    memset(buf, 0, sizeof(*buf));
+    buf->max = max;
+}
+
+void check_buffer_free(CheckBuffer* buf) {
+    free(buf->data);
+    memset(buf, 0, sizeof(*buf));
+}
+
+// Doubles the allocation until it holds want bytes, never beyond max.
+// On allocation failure the buffer keeps its current capacity.
+static void check_buffer_reserve(CheckBuffer* buf, size_t want) {
+    if (want > buf->max) want = buf->max;
+    if (want <= buf->cap) return;
+
+    size_t cap = buf->cap ? buf->cap : CHECK_BUFFER_INITIAL;
+    while (cap < want) cap *= 2;
+    if (cap > buf->max) cap = buf->max;
+
+    char* data = (char*)realloc(buf->data, cap + 1);
+    if (!data) return;
+    if (!buf->data) data[0] = '\0';
+    buf->data = data;
+    buf->cap = cap;
+}
+
+void check_buffer_reset(CheckBuffer* buf) {
+    buf->len = 0;
+    buf->truncated = 0;
+    if (buf->data) buf->data[0] = '\0';
+}
+
+void check_buffer_append(CheckBuffer* buf, const char* data, size_t len) {
+    check_buffer_reserve(buf, buf->len + len);
+    size_t space = buf->cap > buf->len ? buf->cap - buf->len : 0;
+    if (len > space) {
+        buf->truncated = 1;
+        len = space;
+    }
+    if (len == 0) return;
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+    buf->data[buf->len] = '\0';
+}
+
+void check_init(CheckRequest* req, const CheckTransport* transport, void* context,
+                CheckBuffer* body, int maxAttempts, unsigned retryDelayMs) {
+    memset(req, 0, sizeof(*req));
+    req->transport = transport;
+    req->context = context;
+    req->body = body;
+    req->state = CHECK_IDLE;
+    req->maxAttempts = maxAttempts > 0 ? maxAttempts : 1;
+    req->retryDelayMs = retryDelayMs;
+}
+
+const char* check_state_name(CheckState state) {
+    switch (state) {
+        case CHECK_IDLE:       return "idle";
+        case CHECK_SENDING:    return "sending";
+        case CHECK_RECEIVING:  return "receiving";
+        case CHECK_QUERYING:   return "querying";
+        case CHECK_READING:    return "reading";
+        case CHECK_RETRY_WAIT: return "retry-wait";
+        case CHECK_DONE:       return "done";
+        default:               return "unknown";
+    }
+}
+
+static int check_finish(CheckRequest* req, CheckOutcome outcome, int closeRequest) {
+    if (closeRequest) req->transport->close(req);
+    req->outcome = outcome;
+    req->state = CHECK_DONE;
+    req->transport->finished(req);
+    return CHECK_OP_FINISHED;
+}
+
+static int check_send(CheckRequest* req, CheckEvent* out) {
+    req->attempt++;
+    check_buffer_reset(req->body);
+    req->stoppedEarly = 0;
+    req->readFailed = 0;
+    req->statusCode = 0;
+    req->state = CHECK_SENDING;
+    return req->transport->send(req, out);
+}
+
+static int check_query(CheckRequest* req, CheckEvent* out) {
+    req->state = CHECK_QUERYING;
+    return req->transport->query_data(req, out);
+}
+
+// Reads straight into the tail of the body, growing it as needed; bytes beyond
+// its maximum go to the discard sink and mark the body as truncated
+static int check_read(CheckRequest* req, size_t available, CheckEvent* out) {
+    CheckBuffer* body = req->body;
+    check_buffer_reserve(body, body->len + available);
+
+    size_t limit = body->cap < body->max ? body->cap : body->max;
+    size_t space = limit > body->len ? limit - body->len : 0;
+    char* dst;
+    size_t len;
+
+    if (space > 0) {
+        dst = body->data + body->len;
+        len = available < space ? available : space;
+        req->readingDiscard = 0;
+    } else {
+        dst = req->discard;
+        len = available < sizeof(req->discard) ? available : sizeof(req->discard);
+        req->readingDiscard = 1;
+        body->truncated = 1;
+    }
+
+    req->state = CHECK_READING;
+    return req->transport->read(req, dst, len, out);
+}
+
+static int check_on_error(CheckRequest* req, const CheckEvent* ev, CheckEvent* out) {
+    const char* what = ev->what;
+    if (!what) {
+        if (req->state == CHECK_QUERYING || req->state == CHECK_READING) what = "Read failed";
+        else what = (req->state == CHECK_RECEIVING) ? "No response" : "Request failed";
+    }
+    req->error = ev->error;
+    snprintf(req->errorMessage, sizeof(req->errorMessage), "%s: %lu", what, ev->error);
+
+    // Errors while reading the body keep what was received so far
+    if (req->state == CHECK_QUERYING || req->state == CHECK_READING) {
+        req->readFailed = 1;
+        return check_finish(req, CHECK_OUTCOME_BODY, 1);
+    }
+
+    req->transport->close(req);
+    if (req->attempt < req->maxAttempts) {
+        req->state = CHECK_RETRY_WAIT;
+        return req->transport->wait_retry(req, req->retryDelayMs, out);
+    }
+    return check_finish(req, CHECK_OUTCOME_NETWORK_ERROR, 0);
+}
+
+// Applies one completion and issues the next operation
+static int check_apply(CheckRequest* req, const CheckEvent* ev, CheckEvent* out) {
+    switch (ev->type) {
+        case CHECK_EV_START:
+            if (req->state != CHECK_IDLE) return CHECK_OP_PENDING;
+            return check_send(req, out);
+
+        case CHECK_EV_RETRY_TIMER:
+            if (req->state != CHECK_RETRY_WAIT) return CHECK_OP_PENDING;
+            return check_send(req, out);
+
+        case CHECK_EV_SENT:
+            if (req->state != CHECK_SENDING) return CHECK_OP_PENDING;
+            req->state = CHECK_RECEIVING;
+            return req->transport->receive(req, out);
+
+        case CHECK_EV_HEADERS:
+            if (req->state != CHECK_RECEIVING) return CHECK_OP_PENDING;
+            req->statusCode = ev->status;
+            if (ev->status == 304) {
+                // Only a conditional request gets this; there is no body to read
+                return check_finish(req, CHECK_OUTCOME_NOT_MODIFIED, 1);
+            }
+            if (ev->status < 200 || ev->status > 299) {
+                // HTTP errors are answers from the server, retrying would not change them
+                snprintf(req->errorMessage, sizeof(req->errorMessage), "HTTP %lu", ev->status);
+                return check_finish(req, CHECK_OUTCOME_HTTP_ERROR, 1);
+            }
+            return check_query(req, out);
+
+        case CHECK_EV_DATA_AVAILABLE:
+            if (req->state != CHECK_QUERYING) return CHECK_OP_PENDING;
+            if (ev->size == 0) return check_finish(req, CHECK_OUTCOME_BODY, 1);
+            return check_read(req, ev->size, out);
+
+        case CHECK_EV_READ_COMPLETE: {
+            if (req->state != CHECK_READING) return CHECK_OP_PENDING;
+            const char* chunk = req->discard;
+            if (!req->readingDiscard) {
+                chunk = req->body->data + req->body->len;
+                req->body->len += ev->size;
+                req->body->data[req->body->len] = '\0';
+            }
+            if (ev->size == 0) return check_finish(req, CHECK_OUTCOME_BODY, 1);
+            if (req->onBody && req->onBody(req, chunk, ev->size)) {
+                // Closing the request abandons the rest of the body
+                req->stoppedEarly = 1;
+                return check_finish(req, CHECK_OUTCOME_BODY, 1);
+            }
+            return check_query(req, out);
+        }
+
+        case CHECK_EV_ERROR:
+            if (req->state == CHECK_IDLE || req->state == CHECK_RETRY_WAIT || req->state == CHECK_DONE) {
+                return CHECK_OP_PENDING;
+            }
+            return check_on_error(req, ev, out);
+    }
+    return CHECK_OP_PENDING;
+}
+
+void check_start(CheckRequest* req) {
+    CheckEvent ev = {0};
+    ev.type = CHECK_EV_START;
+    check_step(req, &ev);
+}
+
+void check_step(CheckRequest* req, const CheckEvent* ev) {
+    CheckEvent current = *ev;
+    for (;;) {
+        CheckEvent next = {0};
+        // Nothing may touch req once an operation is pending (its completion can
+        // already be running on another thread) or once the check has finished
+        if (check_apply(req, &current, &next) != CHECK_OP_DONE) return;
+        current = next;
+    }
+}
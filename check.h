@@ -0,0 +1,125 @@
+// check.h
+// Request/response state machine for one endpoint check.
+//
+// The machine never performs I/O itself: every step is handed to a
+// CheckTransport, which either completes the operation immediately or
+// reports the completion later through check_step(). The WinHTTP async
+// transport lives in main.c; any other transport (e.g. a scripted fake)
+// can drive the same machine without Windows.
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stddef.h>
+
+#define CHECK_BUFFER_INITIAL 4096   // First allocation of a response buffer
+
+// Growable response body. The transport reads straight into its tail; it is
+// owned by the caller so it can be reused across checks without reallocating.
+typedef struct {
+    char* data;          // NUL-terminated, NULL until the first read
+    size_t len;
+    size_t cap;          // Allocated bytes, excluding the terminator
+    size_t max;          // Bytes kept at most; anything beyond is drained and dropped
+    int truncated;       // Body was longer than max
+} CheckBuffer;
+
+typedef enum {
+    CHECK_IDLE,
+    CHECK_SENDING,        // Request handed to the transport, waiting for it to be sent
+    CHECK_RECEIVING,      // Waiting for response headers
+    CHECK_QUERYING,       // Waiting to learn how much body data is available
+    CHECK_READING,        // Waiting for a body read to complete
+    CHECK_RETRY_WAIT,     // Attempt failed, retry timer armed
+    CHECK_DONE
+} CheckState;
+
+typedef enum {
+    CHECK_EV_START,
+    CHECK_EV_SENT,            // Request was sent
+    CHECK_EV_HEADERS,         // Headers received; status = HTTP status code
+    CHECK_EV_DATA_AVAILABLE,  // size = bytes available, 0 at end of body
+    CHECK_EV_READ_COMPLETE,   // size = bytes read, 0 at end of body
+    CHECK_EV_ERROR,           // error = transport error code, what = optional description
+    CHECK_EV_RETRY_TIMER      // Retry delay elapsed
+} CheckEventType;
+
+typedef struct {
+    CheckEventType type;
+    unsigned long status;
+    size_t size;
+    unsigned long error;
+    const char* what;
+} CheckEvent;
+
+typedef enum {
+    CHECK_OUTCOME_NONE,
+    CHECK_OUTCOME_BODY,           // HTTP 2xx, body in *req->body; partial if truncated, stoppedEarly or readFailed
+    CHECK_OUTCOME_HTTP_ERROR,     // Non-2xx status, not retried
+    CHECK_OUTCOME_NOT_MODIFIED,   // HTTP 304: the caller's copy from a conditional request is current
+    CHECK_OUTCOME_NETWORK_ERROR   // All attempts failed before a response arrived
+} CheckOutcome;
+
+// Return values of transport operations
+#define CHECK_OP_PENDING 0   // Completion will be delivered through check_step()
+#define CHECK_OP_DONE    1   // Completed synchronously, *ev holds the completion
+
+typedef struct CheckRequest CheckRequest;
+
+// Receives each body chunk as it arrives (including bytes beyond body->max);
+// returns non-zero once nothing more needs to be read
+typedef int (*CheckBodySink)(CheckRequest* req, const char* data, size_t len);
+
+typedef struct {
+    int  (*send)(CheckRequest* req, CheckEvent* ev);
+    int  (*receive)(CheckRequest* req, CheckEvent* ev);
+    int  (*query_data)(CheckRequest* req, CheckEvent* ev);
+    int  (*read)(CheckRequest* req, char* buf, size_t len, CheckEvent* ev);
+    int  (*wait_retry)(CheckRequest* req, unsigned delayMs, CheckEvent* ev);
+    void (*close)(CheckRequest* req);      // Release per-attempt resources
+    void (*finished)(CheckRequest* req);   // Outcome is final; req may be freed here
+} CheckTransport;
+
+struct CheckRequest {
+    const CheckTransport* transport;
+    void* context;                 // Owned by the transport
+    CheckState state;
+    int attempt;
+    int maxAttempts;
+    unsigned retryDelayMs;
+
+    CheckOutcome outcome;
+    unsigned long statusCode;
+    unsigned long error;
+    char errorMessage[128];
+
+    CheckBuffer* body;             // Owned by the caller
+    CheckBodySink onBody;          // Optional, set after check_init()
+    int stoppedEarly;              // onBody ended the read before the end of the body
+    int readFailed;                // A transport error ended the read before the end of the body
+    char discard[512];             // Sink for body bytes beyond body->max
+    int readingDiscard;
+};
+
+void check_buffer_init(CheckBuffer* buf, size_t max);
+void check_buffer_free(CheckBuffer* buf);
+
+// Empties the buffer, keeping its allocation
+void check_buffer_reset(CheckBuffer* buf);
+
+// Appends data, keeping at most max bytes; anything beyond marks it truncated
+void check_buffer_append(CheckBuffer* buf, const char* data, size_t len);
+
+void check_init(CheckRequest* req, const CheckTransport* transport, void* context,
+                CheckBuffer* body, int maxAttempts, unsigned retryDelayMs);
+
+// Starts the first attempt
+void check_start(CheckRequest* req);
+
+// Feeds a completion into the machine. Runs until an operation is pending or
+// the check has finished; req must not be touched by the caller afterwards
+// if it may have finished.
+void check_step(CheckRequest* req, const CheckEvent* ev);
+
+const char* check_state_name(CheckState state);
+
+#endif // CHECK_H
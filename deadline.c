@@ -0,0 +1,125 @@
+// deadline.c
+#include "deadline.h"
+#include <stdlib.h>
+#include <string.h>
+
+int sched_init(Scheduler* s, int capacity) {
+    memset(s, 0, sizeof(*s));
+    s->heap = (SchedEntry*)malloc((size_t)capacity * sizeof(SchedEntry));
+    s->pos = (int*)malloc((size_t)capacity * sizeof(int));
+    if (!s->heap || !s->pos) {
+        sched_free(s);
+        return 0;
+    }
+    for (int i = 0; i < capacity; i++) s->pos[i] = -1;
+    s->capacity = capacity;
+    return 1;
+}
+
+void sched_free(Scheduler* s) {
+    free(s->heap);
+    free(s->pos);
+    memset(s, 0, sizeof(*s));
+}
+
+// --- Heap maintenance ---
+
+static void sched_place(Scheduler* s, int index, SchedEntry e) {
+    s->heap[index] = e;
+    s->pos[e.item] = index;
+}
+
+static void sched_up(Scheduler* s, int index) {
+    SchedEntry e = s->heap[index];
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (s->heap[parent].due <= e.due) break;
+        sched_place(s, index, s->heap[parent]);
+        index = parent;
+    }
+    sched_place(s, index, e);
+}
+
+static void sched_down(Scheduler* s, int index) {
+    SchedEntry e = s->heap[index];
+    for (;;) {
+        int child = 2 * index + 1;
+        if (child >= s->count) break;
+        if (child + 1 < s->count && s->heap[child + 1].due < s->heap[child].due) child++;
+        if (e.due <= s->heap[child].due) break;
+        sched_place(s, index, s->heap[child]);
+        index = child;
+    }
+    sched_place(s, index, e);
+}
+
+// Takes the entry at index out of the heap
+static void sched_remove_at(Scheduler* s, int index) {
+    s->pos[s->heap[index].item] = -1;
+    s->count--;
+    if (index == s->count) return;
+
+    SchedEntry last = s->heap[s->count];
+    unsigned long long removed = s->heap[index].due;
+    sched_place(s, index, last);
+    if (last.due < removed) sched_up(s, index);
+    else sched_down(s, index);
+}
+
+// --- Public API ---
+
+void sched_set(Scheduler* s, int item, unsigned long long due) {
+    if (item < 0 || item >= s->capacity) return;
+
+    int index = s->pos[item];
+    if (index < 0) {
+        SchedEntry e = { due, item };
+        sched_place(s, s->count, e);
+        sched_up(s, s->count++);
+        return;
+    }
+
+    unsigned long long old = s->heap[index].due;
+    s->heap[index].due = due;
+    if (due < old) sched_up(s, index);
+    else sched_down(s, index);
+}
+
+void sched_cancel(Scheduler* s, int item) {
+    if (item < 0 || item >= s->capacity || s->pos[item] < 0) return;
+    sched_remove_at(s, s->pos[item]);
+}
+
+int sched_due(const Scheduler* s, int item, unsigned long long* due) {
+    if (item < 0 || item >= s->capacity || s->pos[item] < 0) return 0;
+    *due = s->heap[s->pos[item]].due;
+    return 1;
+}
+
+int sched_next(const Scheduler* s, unsigned long long* due) {
+    if (s->count == 0) return 0;
+    *due = s->heap[0].due;
+    return 1;
+}
+
+int sched_pop_due(Scheduler* s, unsigned long long now, unsigned long long* due) {
+    if (s->count == 0 || s->heap[0].due > now) return -1;
+    int item = s->heap[0].item;
+    *due = s->heap[0].due;
+    sched_remove_at(s, 0);
+    return item;
+}
+
+unsigned long long sched_next_rate(unsigned long long due, unsigned long long interval,
+                                   unsigned long long now, unsigned* missed) {
+    if (interval == 0) interval = 1;
+    unsigned long long next = due + interval;
+    unsigned skipped = 0;
+    if (next <= now) {
+        unsigned long long behind = (now - next) / interval + 1;
+        next += behind * interval;
+        skipped = (unsigned)behind;
+    }
+    if (missed) *missed = skipped;
+    return next;
+}
@@ -0,0 +1,59 @@
+// deadline.h
+// Deadline scheduler: a binary min-heap of absolute monotonic deadlines.
+//
+// Each item (0..capacity-1, e.g. a monitor table slot) has at most one
+// deadline. The owner arms a single timer for sched_next() and, when it
+// fires, pops every item that is due, so a wakeup happens only when some
+// deadline has passed and costs O(log n) per item run, however many items
+// are scheduled.
+//
+// sched_next_rate() gives the next fixed-rate deadline: deadlines stay on the
+// grid set by the first one, however late each run starts, and whole periods
+// that were missed are skipped rather than run back to back. Fixed-delay
+// callers simply schedule "finished + interval".
+// Times are milliseconds on any monotonic clock.
+// Not thread-safe: callers serialize access.
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+typedef enum {
+    SCHED_FIXED_RATE,             // Next run one interval after the previous deadline
+    SCHED_FIXED_DELAY             // Next run one interval after the previous run finished
+} SchedMode;
+
+typedef struct {
+    unsigned long long due;
+    int item;
+} SchedEntry;
+
+typedef struct {
+    SchedEntry* heap;             // Earliest deadline first
+    int* pos;                     // Heap index of each item, -1 when not scheduled
+    int count;
+    int capacity;
+} Scheduler;
+
+// Returns 0 when out of memory
+int sched_init(Scheduler* s, int capacity);
+void sched_free(Scheduler* s);
+
+// Schedules an item, moving it if it already has a deadline
+void sched_set(Scheduler* s, int item, unsigned long long due);
+void sched_cancel(Scheduler* s, int item);
+
+// Deadline of an item; returns 0 if it has none
+int sched_due(const Scheduler* s, int item, unsigned long long* due);
+
+// Earliest deadline; returns 0 when nothing is scheduled
+int sched_next(const Scheduler* s, unsigned long long* due);
+
+// Removes an item whose deadline is at or before now and returns it with
+// its deadline, earliest first; -1 when none is due
+int sched_pop_due(Scheduler* s, unsigned long long now, unsigned long long* due);
+
+// First deadline after now on the grid due + k * interval (k >= 1); missed
+// (may be NULL) receives the number of grid points skipped
+unsigned long long sched_next_rate(unsigned long long due, unsigned long long interval,
+                                   unsigned long long now, unsigned* missed);
+
+#endif // DEADLINE_H
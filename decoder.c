@@ -0,0 +1,368 @@
+// decoder.c
+#include "decoder.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#define JSON_MAX_DEPTH 64
+
+static DecodeVerdict decoder_invalid(const char* what, char* message, size_t messageLen,
+                                     const char** reason) {
+    snprintf(message, messageLen, "%s", what);
+    if (reason) *reason = what;
+    return DECODE_INVALID;
+}
+
+// ============================================================================
+// xml: <r>/<result> + <message> (streamed through xmlstatus)
+// ============================================================================
+
+static int xml_configure(DecoderConfig* cfg, const char* args) {
+    (void)cfg;
+    return args == NULL;
+}
+
+static int xml_feed(DecoderState* st, const char* data, size_t len) {
+    return xml_status_feed(&st->xml, data, len) == XML_STATUS_DONE;
+}
+
+static DecodeVerdict xml_finish(DecoderState* st, unsigned long status, const char* body, size_t len,
+                                char* message, size_t messageLen, const char** reason) {
+    (void)status;
+    (void)body;
+    (void)len;
+    switch (xml_status_verdict(&st->xml, message, messageLen, reason)) {
+        case XML_STATUS_SUCCESS: return DECODE_SUCCESS;
+        case XML_STATUS_FAIL:    return DECODE_FAIL;
+        default:                 return DECODE_INVALID;
+    }
+}
+
+static const ResponseDecoder xml_decoder = { "xml", xml_configure, xml_feed, xml_finish };
+
+// ============================================================================
+// json:<path>=<value> (evaluated in place on the collected body)
+// ============================================================================
+
+typedef struct {
+    const char* p;
+    const char* end;
+    int depth;
+} JsonCursor;
+
+static void json_skip_ws(JsonCursor* c) {
+    while (c->p < c->end && isspace((unsigned char)*c->p)) c->p++;
+}
+
+// At '"': moves past the closing quote; [*start, *start + *len) is the raw contents
+static int json_string(JsonCursor* c, const char** start, size_t* len) {
+    if (c->p >= c->end || *c->p != '"') return 0;
+    const char* s = ++c->p;
+    while (c->p < c->end && *c->p != '"') {
+        if (*c->p == '\\') c->p++;
+        c->p++;
+    }
+    if (c->p >= c->end) return 0;
+    *start = s;
+    *len = (size_t)(c->p - s);
+    c->p++;
+    return 1;
+}
+
+static int json_skip_value(JsonCursor* c) {
+    json_skip_ws(c);
+    if (c->p >= c->end) return 0;
+
+    char open = *c->p;
+    if (open == '"') {
+        const char* s;
+        size_t n;
+        return json_string(c, &s, &n);
+    }
+
+    if (open == '{' || open == '[') {
+        char close = (open == '{') ? '}' : ']';
+        if (++c->depth > JSON_MAX_DEPTH) return 0;
+        c->p++;
+        json_skip_ws(c);
+        if (c->p < c->end && *c->p == close) {
+            c->p++;
+            c->depth--;
+            return 1;
+        }
+        for (;;) {
+            if (open == '{') {
+                const char* key;
+                size_t keyLen;
+                json_skip_ws(c);
+                if (!json_string(c, &key, &keyLen)) return 0;
+                json_skip_ws(c);
+                if (c->p >= c->end || *c->p != ':') return 0;
+                c->p++;
+            }
+            if (!json_skip_value(c)) return 0;
+            json_skip_ws(c);
+            if (c->p >= c->end) return 0;
+            if (*c->p == ',') {
+                c->p++;
+                continue;
+            }
+            if (*c->p != close) return 0;
+            c->p++;
+            c->depth--;
+            return 1;
+        }
+    }
+
+    // Number, true, false or null
+    const char* s = c->p;
+    while (c->p < c->end && !strchr(",}] \t\r\n", *c->p)) c->p++;
+    return c->p > s;
+}
+
+// Follows the key path from the value at the cursor; on success [*start, *end)
+// is the raw text of the value it names
+static int json_find(JsonCursor* c, const char* path, const char** start, const char** end) {
+    json_skip_ws(c);
+    if (!*path) {
+        const char* s = c->p;
+        if (!json_skip_value(c)) return 0;
+        *start = s;
+        *end = c->p;
+        return 1;
+    }
+    if (c->p >= c->end) return 0;
+
+    size_t segLen = strcspn(path, ".");
+    const char* rest = path[segLen] ? path + segLen + 1 : path + segLen;
+
+    if (*c->p == '{') {
+        c->p++;
+        for (;;) {
+            const char* key;
+            size_t keyLen;
+            json_skip_ws(c);
+            if (!json_string(c, &key, &keyLen)) return 0;   // Also the end of the object
+            json_skip_ws(c);
+            if (c->p >= c->end || *c->p != ':') return 0;
+            c->p++;
+            if (keyLen == segLen && memcmp(key, path, segLen) == 0) {
+                return json_find(c, rest, start, end);
+            }
+            if (!json_skip_value(c)) return 0;
+            json_skip_ws(c);
+            if (c->p >= c->end || *c->p != ',') return 0;
+            c->p++;
+        }
+    }
+
+    if (*c->p == '[' && segLen > 0 && strspn(path, "0123456789") >= segLen) {
+        size_t index = 0;
+        for (size_t i = 0; i < segLen; i++) index = index * 10 + (size_t)(path[i] - '0');
+        c->p++;
+        for (size_t i = 0;; i++) {
+            json_skip_ws(c);
+            if (c->p >= c->end || *c->p == ']') return 0;
+            if (i == index) return json_find(c, rest, start, end);
+            if (!json_skip_value(c)) return 0;
+            json_skip_ws(c);
+            if (c->p >= c->end || *c->p != ',') return 0;
+            c->p++;
+        }
+    }
+    return 0;
+}
+
+static int json_configure(DecoderConfig* cfg, const char* args) {
+    if (!args) return 0;
+    const char* eq = strchr(args, '=');
+    if (!eq || eq == args || !eq[1]) return 0;
+
+    size_t pathLen = (size_t)(eq - args);
+    size_t expectLen = strlen(eq + 1);
+    if (pathLen >= sizeof(cfg->path) || expectLen >= sizeof(cfg->expect)) return 0;
+
+    memcpy(cfg->path, args, pathLen);
+    cfg->path[pathLen] = '\0';
+    memcpy(cfg->expect, eq + 1, expectLen + 1);
+    cfg->expectLen = expectLen;
+    return 1;
+}
+
+static DecodeVerdict json_finish(DecoderState* st, unsigned long status, const char* body, size_t len,
+                                 char* message, size_t messageLen, const char** reason) {
+    (void)status;
+    const DecoderConfig* cfg = st->config;
+    JsonCursor c = { body, body + len, 0 };
+
+    json_skip_ws(&c);
+    if (c.p >= c.end) return decoder_invalid("Empty response", message, messageLen, reason);
+    if (*c.p != '{' && *c.p != '[') return decoder_invalid("Not a JSON document", message, messageLen, reason);
+
+    const char* start;
+    const char* end;
+    if (!json_find(&c, cfg->path, &start, &end)) {
+        return decoder_invalid("Key path not found", message, messageLen, reason);
+    }
+
+    // Compare strings by their contents, other values by their literal text
+    if (end - start >= 2 && *start == '"') {
+        start++;
+        end--;
+    }
+    size_t valueLen = (size_t)(end - start);
+    int valueShown = valueLen > 64 ? 64 : (int)valueLen;
+
+    if (valueLen == cfg->expectLen) {
+        size_t i = 0;
+        while (i < valueLen && tolower((unsigned char)start[i]) == tolower((unsigned char)cfg->expect[i])) i++;
+        if (i == valueLen) {
+            snprintf(message, messageLen, "%s=%.*s", cfg->path, valueShown, start);
+            return DECODE_SUCCESS;
+        }
+    }
+    snprintf(message, messageLen, "%s=%.*s (expected %s)", cfg->path, valueShown, start, cfg->expect);
+    return DECODE_FAIL;
+}
+
+static const ResponseDecoder json_decoder = { "json", json_configure, NULL, json_finish };
+
+// ============================================================================
+// text:<keyword> (streamed; stops once the keyword is seen)
+// ============================================================================
+
+static int text_configure(DecoderConfig* cfg, const char* args) {
+    if (!args || !*args) return 0;
+    size_t n = strlen(args);
+    if (n >= sizeof(cfg->expect)) return 0;
+
+    for (size_t i = 0; i <= n; i++) cfg->expect[i] = (char)tolower((unsigned char)args[i]);
+    cfg->expectLen = n;
+
+    // next[i]: length of the longest proper prefix of expect[0..i] that is also its suffix
+    cfg->next[0] = 0;
+    size_t k = 0;
+    for (size_t i = 1; i < n; i++) {
+        while (k > 0 && cfg->expect[i] != cfg->expect[k]) k = cfg->next[k - 1];
+        if (cfg->expect[i] == cfg->expect[k]) k++;
+        cfg->next[i] = (unsigned char)k;
+    }
+    return 1;
+}
+
+static int text_feed(DecoderState* st, const char* data, size_t len) {
+    const DecoderConfig* cfg = st->config;
+    size_t m = st->matched;
+
+    for (size_t i = 0; i < len; i++) {
+        char c = (char)tolower((unsigned char)data[i]);
+        while (m > 0 && c != cfg->expect[m]) m = cfg->next[m - 1];
+        if (c == cfg->expect[m] && ++m == cfg->expectLen) {
+            st->found = 1;
+            return 1;
+        }
+    }
+    st->matched = m;
+    return 0;
+}
+
+static DecodeVerdict text_finish(DecoderState* st, unsigned long status, const char* body, size_t len,
+                                 char* message, size_t messageLen, const char** reason) {
+    (void)status;
+    (void)body;
+    if (st->found) {
+        snprintf(message, messageLen, "Found '%s'", st->config->expect);
+        return DECODE_SUCCESS;
+    }
+    if (len == 0) return decoder_invalid("Empty response", message, messageLen, reason);
+    snprintf(message, messageLen, "'%s' not found", st->config->expect);
+    return DECODE_FAIL;
+}
+
+static const ResponseDecoder text_decoder = { "text", text_configure, text_feed, text_finish };
+
+// ============================================================================
+// http: 2xx is success
+// ============================================================================
+
+static int http_configure(DecoderConfig* cfg, const char* args) {
+    (void)cfg;
+    return args == NULL;
+}
+
+static int http_feed(DecoderState* st, const char* data, size_t len) {
+    (void)st;
+    (void)data;
+    (void)len;
+    return 1;
+}
+
+static DecodeVerdict http_finish(DecoderState* st, unsigned long status, const char* body, size_t len,
+                                 char* message, size_t messageLen, const char** reason) {
+    (void)st;
+    (void)body;
+    (void)len;
+    snprintf(message, messageLen, "HTTP %lu", status);
+    if (status >= 200 && status <= 299) return DECODE_SUCCESS;
+    if (reason) *reason = "Unexpected status";
+    return DECODE_INVALID;
+}
+
+static const ResponseDecoder http_decoder = { "http", http_configure, http_feed, http_finish };
+
+// ============================================================================
+// Registry
+// ============================================================================
+
+static const ResponseDecoder* const decoders[] = {
+    &xml_decoder,
+    &json_decoder,
+    &text_decoder,
+    &http_decoder
+};
+
+int decoder_parse(const char* spec, DecoderConfig* cfg) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->decoder = &xml_decoder;
+    if (!spec || !*spec) return 1;
+
+    size_t nameLen = strcspn(spec, ":");
+    const char* args = spec[nameLen] ? spec + nameLen + 1 : NULL;
+
+    for (size_t i = 0; i < sizeof(decoders) / sizeof(decoders[0]); i++) {
+        const ResponseDecoder* d = decoders[i];
+        if (strlen(d->name) != nameLen || strncmp(d->name, spec, nameLen) != 0) continue;
+        if (!d->configure(cfg, args)) break;
+        cfg->decoder = d;
+        return 1;
+    }
+
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->decoder = &xml_decoder;
+    return 0;
+}
+
+const char* decoder_name(const DecoderConfig* cfg) {
+    return cfg->decoder->name;
+}
+
+void decoder_begin(DecoderState* st, const DecoderConfig* cfg) {
+    memset(st, 0, sizeof(*st));
+    st->config = cfg;
+    xml_status_init(&st->xml);
+}
+
+int decoder_feed(DecoderState* st, const char* data, size_t len) {
+    const ResponseDecoder* d = st->config->decoder;
+    return d->feed ? d->feed(st, data, len) : 0;
+}
+
+DecodeVerdict decoder_finish(DecoderState* st, unsigned long status, const char* body, size_t len,
+                             char* message, size_t messageLen, const char** reason) {
+    if (reason) *reason = NULL;
+    if (!body) {
+        body = "";
+        len = 0;
+    }
+    return st->config->decoder->finish(st, status, body, len, message, messageLen, reason);
+}
@@ -0,0 +1,74 @@
+// decoder.h
+// Response decoders: turn an endpoint's HTTP response into a verdict.
+//
+// Each endpoint selects a decoder with a short spec:
+//   xml                   <r>/<result> + <message> status document (default)
+//   json:<path>=<value>   Value at the dotted key path equals <value>
+//                         (case-insensitive); array elements by index, e.g.
+//                         json:status=UP or json:checks.0.state=ok
+//   text:<keyword>        Body contains <keyword> (case-insensitive)
+//   http                  Any 2xx status is success; the body is not needed
+//
+// A decoder sees the body twice: feed() gets each chunk as it arrives and may
+// end the download early, finish() evaluates the collected body in place.
+#ifndef DECODER_H
+#define DECODER_H
+
+#include <stddef.h>
+#include "xmlstatus.h"
+
+#define DECODER_SPEC_SIZE 256
+#define DECODER_ARG_SIZE  128
+
+typedef enum {
+    DECODE_INVALID,      // Response not understood
+    DECODE_SUCCESS,
+    DECODE_FAIL          // Response understood and reports a failure
+} DecodeVerdict;
+
+typedef struct ResponseDecoder ResponseDecoder;
+
+// Parsed spec; immutable once built and safe to copy
+typedef struct {
+    const ResponseDecoder* decoder;
+    char path[DECODER_ARG_SIZE];          // json: key path
+    char expect[DECODER_ARG_SIZE];        // json: success value, text: keyword (lower case)
+    size_t expectLen;
+    unsigned char next[DECODER_ARG_SIZE]; // text: KMP fallback table for the keyword
+} DecoderConfig;
+
+// Per-attempt decoding state
+typedef struct {
+    const DecoderConfig* config;
+    XmlStatusParser xml;                  // xml
+    size_t matched;                       // text: keyword characters matched so far
+    int found;                            // text: keyword seen
+} DecoderState;
+
+struct ResponseDecoder {
+    const char* name;
+    // Reads the arguments after "name:" (NULL when absent); returns 0 if they are invalid
+    int (*configure)(DecoderConfig* cfg, const char* args);
+    // Optional; returns non-zero once the rest of the body is not needed
+    int (*feed)(DecoderState* st, const char* data, size_t len);
+    DecodeVerdict (*finish)(DecoderState* st, unsigned long status, const char* body, size_t len,
+                            char* message, size_t messageLen, const char** reason);
+};
+
+// Parses a spec; an empty spec selects xml. Returns 0 (and selects xml) if the
+// spec is not understood.
+int decoder_parse(const char* spec, DecoderConfig* cfg);
+
+const char* decoder_name(const DecoderConfig* cfg);
+
+void decoder_begin(DecoderState* st, const DecoderConfig* cfg);
+
+// Returns non-zero once reading can stop
+int decoder_feed(DecoderState* st, const char* data, size_t len);
+
+// Evaluates the response. body is the collected (possibly truncated) body and
+// is not modified. *reason (optional) explains an INVALID verdict.
+DecodeVerdict decoder_finish(DecoderState* st, unsigned long status, const char* body, size_t len,
+                             char* message, size_t messageLen, const char** reason);
+
+#endif // DECODER_H
@@ -0,0 +1,454 @@
+// inflate.c
+#include "inflate.h"
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    ST_GZIP_HEADER,               // ID1 ID2 CM FLG MTIME XFL OS
+    ST_GZIP_EXTRA_LEN,
+    ST_GZIP_EXTRA,
+    ST_GZIP_NAME,
+    ST_GZIP_COMMENT,
+    ST_GZIP_HCRC,
+    ST_DEFLATE_DETECT,            // zlib header or raw deflate
+    ST_BLOCK_HEADER,
+    ST_STORED,
+    ST_CODES,
+    ST_TRAILER,
+    ST_DONE,
+    ST_ERROR
+};
+
+#define GZIP_FHCRC    0x02
+#define GZIP_FEXTRA   0x04
+#define GZIP_FNAME    0x08
+#define GZIP_FCOMMENT 0x10
+
+#define MAXBITS  15
+#define MAXLCODES 286
+#define MAXDCODES 30
+
+static const short lengthBase[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const short lengthExtra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const short distBase[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577 };
+static const short distExtra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// --- Bit input ---
+
+// Takes n (0..16) bits, LSB first; abandons the step when input runs out
+static unsigned inflate_bits(Inflater* z, int n) {
+    while (z->bitCount < n) {
+        if (z->inPos == z->inLen) longjmp(z->outOfInput, 1);
+        z->bitBuf |= (unsigned long)z->in[z->inPos++] << z->bitCount;
+        z->bitCount += 8;
+    }
+    unsigned value = (unsigned)(z->bitBuf & ((1UL << n) - 1));
+    z->bitBuf >>= n;
+    z->bitCount -= n;
+    return value;
+}
+
+static void inflate_align(Inflater* z) {
+    z->bitBuf >>= z->bitCount & 7;
+    z->bitCount &= ~7;
+}
+
+// --- Output ---
+
+// CRC-32 four bits at a time: small enough to be a constant, so concurrent
+// inflaters never race to build a table
+static const unsigned long crcNibble[16] = {
+    0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL,
+    0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+    0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL,
+    0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL };
+
+// Passes window bytes not yet seen by the sink, updating the checksums
+static void inflate_flush(Inflater* z) {
+    while (z->flushed < z->written) {
+        size_t start = z->flushed & (INFLATE_WINDOW - 1);
+        size_t n = z->written - z->flushed;
+        if (n > INFLATE_WINDOW - start) n = INFLATE_WINDOW - start;
+        const unsigned char* p = z->window + start;
+
+        if (z->format == INFLATE_GZIP) {
+            unsigned long c = z->crc ^ 0xFFFFFFFFUL;
+            for (size_t i = 0; i < n; i++) {
+                c ^= p[i];
+                c = crcNibble[c & 0x0F] ^ (c >> 4);
+                c = crcNibble[c & 0x0F] ^ (c >> 4);
+            }
+            z->crc = c ^ 0xFFFFFFFFUL;
+        } else if (!z->raw) {
+            unsigned long a = z->adlerA, b = z->adlerB;
+            for (size_t i = 0; i < n; i++) {
+                a += p[i];
+                if (a >= 65521) a -= 65521;
+                b += a;
+                if (b >= 65521) b -= 65521;
+            }
+            z->adlerA = a;
+            z->adlerB = b;
+        }
+
+        z->flushed += n;
+        if (!z->stopped && z->sink && z->sink(z->sinkCtx, (const char*)p, n)) z->stopped = 1;
+    }
+}
+
+static void inflate_put(Inflater* z, unsigned char byte) {
+    z->window[z->written & (INFLATE_WINDOW - 1)] = byte;
+    z->written++;
+    if ((z->written & (INFLATE_WINDOW - 1)) == 0) inflate_flush(z);
+}
+
+// --- Huffman codes ---
+
+// Builds a canonical code from code lengths. Returns 0 for a complete code,
+// > 0 for an incomplete one, < 0 when over-subscribed.
+static int inflate_construct(InflateHuffman* h, const short* length, int n) {
+    short offs[MAXBITS + 1];
+
+    memset(h->count, 0, sizeof(h->count));
+    for (int symbol = 0; symbol < n; symbol++) h->count[length[symbol]]++;
+    if (h->count[0] == n) return 0;
+
+    int left = 1;
+    for (int len = 1; len <= MAXBITS; len++) {
+        left <<= 1;
+        left -= h->count[len];
+        if (left < 0) return left;
+    }
+
+    offs[1] = 0;
+    for (int len = 1; len < MAXBITS; len++) offs[len + 1] = offs[len] + h->count[len];
+    for (int symbol = 0; symbol < n; symbol++) {
+        if (length[symbol] != 0) h->symbol[offs[length[symbol]]++] = (short)symbol;
+    }
+    return left;
+}
+
+static int inflate_decode(Inflater* z, const InflateHuffman* h) {
+    int code = 0, first = 0, index = 0;
+    for (int len = 1; len <= MAXBITS; len++) {
+        code |= (int)inflate_bits(z, 1);
+        int count = h->count[len];
+        if (code - count < first) return h->symbol[index + (code - first)];
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+static void inflate_fixed(Inflater* z) {
+    short lengths[288];
+    int symbol = 0;
+    for (; symbol < 144; symbol++) lengths[symbol] = 8;
+    for (; symbol < 256; symbol++) lengths[symbol] = 9;
+    for (; symbol < 280; symbol++) lengths[symbol] = 7;
+    for (; symbol < 288; symbol++) lengths[symbol] = 8;
+    inflate_construct(&z->lencode, lengths, 288);
+    for (symbol = 0; symbol < MAXDCODES; symbol++) lengths[symbol] = 5;
+    inflate_construct(&z->distcode, lengths, MAXDCODES);
+}
+
+// Reads the code tables of a dynamic block
+static const char* inflate_dynamic(Inflater* z) {
+    static const short order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+    short lengths[MAXLCODES + MAXDCODES];
+
+    int nlen = (int)inflate_bits(z, 5) + 257;
+    int ndist = (int)inflate_bits(z, 5) + 1;
+    int ncode = (int)inflate_bits(z, 4) + 4;
+    if (nlen > MAXLCODES || ndist > MAXDCODES) return "bad code counts";
+
+    int index = 0;
+    for (; index < ncode; index++) lengths[order[index]] = (short)inflate_bits(z, 3);
+    for (; index < 19; index++) lengths[order[index]] = 0;
+    if (inflate_construct(&z->lencode, lengths, 19) != 0) return "incomplete code length code";
+
+    index = 0;
+    while (index < nlen + ndist) {
+        int symbol = inflate_decode(z, &z->lencode);
+        if (symbol < 0) return "bad code length";
+        if (symbol < 16) {
+            lengths[index++] = (short)symbol;
+            continue;
+        }
+
+        short len = 0;
+        if (symbol == 16) {
+            if (index == 0) return "repeat with no previous length";
+            len = lengths[index - 1];
+            symbol = 3 + (int)inflate_bits(z, 2);
+        } else if (symbol == 17) {
+            symbol = 3 + (int)inflate_bits(z, 3);
+        } else {
+            symbol = 11 + (int)inflate_bits(z, 7);
+        }
+        if (index + symbol > nlen + ndist) return "too many lengths";
+        while (symbol--) lengths[index++] = len;
+    }
+    if (lengths[256] == 0) return "no end-of-block code";
+
+    // Incomplete codes are only allowed for a single length
+    int err = inflate_construct(&z->lencode, lengths, nlen);
+    if (err < 0 || (err > 0 && nlen - z->lencode.count[0] != 1)) return "bad literal/length code";
+    err = inflate_construct(&z->distcode, lengths + nlen, ndist);
+    if (err < 0 || (err > 0 && ndist - z->distcode.count[0] != 1)) return "bad distance code";
+    return NULL;
+}
+
+// --- Steps ---
+
+static unsigned inflate_byte(Inflater* z) {
+    return inflate_bits(z, 8);
+}
+
+static unsigned long inflate_le32(Inflater* z) {
+    unsigned long lo = inflate_bits(z, 16);
+    return lo | ((unsigned long)inflate_bits(z, 16) << 16);
+}
+
+static void inflate_fail(Inflater* z, const char* error) {
+    z->error = error;
+    z->state = ST_ERROR;
+}
+
+static int inflate_gzip_next(Inflater* z, int from) {
+    if (from < ST_GZIP_EXTRA_LEN && (z->gzipFlags & GZIP_FEXTRA)) return ST_GZIP_EXTRA_LEN;
+    if (from < ST_GZIP_NAME && (z->gzipFlags & GZIP_FNAME)) return ST_GZIP_NAME;
+    if (from < ST_GZIP_COMMENT && (z->gzipFlags & GZIP_FCOMMENT)) return ST_GZIP_COMMENT;
+    if (from < ST_GZIP_HCRC && (z->gzipFlags & GZIP_FHCRC)) return ST_GZIP_HCRC;
+    return ST_BLOCK_HEADER;
+}
+
+// Runs one step: input is consumed and output produced only if the step
+// completes, so a step cut short by the end of input can simply be retried.
+static void inflate_step(Inflater* z) {
+    switch (z->state) {
+    case ST_GZIP_HEADER: {
+        unsigned id1 = inflate_byte(z), id2 = inflate_byte(z), cm = inflate_byte(z);
+        int flags = (int)inflate_byte(z);
+        inflate_bits(z, 16);                      // MTIME
+        inflate_bits(z, 16);
+        inflate_bits(z, 16);                      // XFL, OS
+        if (id1 != 0x1F || id2 != 0x8B) { inflate_fail(z, "not gzip data"); break; }
+        if (cm != 8) { inflate_fail(z, "unknown gzip compression method"); break; }
+        if (flags & 0xE0) { inflate_fail(z, "reserved gzip flags set"); break; }
+        z->gzipFlags = flags;
+        z->state = inflate_gzip_next(z, ST_GZIP_HEADER);
+        break;
+    }
+    case ST_GZIP_EXTRA_LEN:
+        z->extraLeft = inflate_bits(z, 16);
+        z->state = ST_GZIP_EXTRA;
+        break;
+    case ST_GZIP_EXTRA:
+        if (z->extraLeft == 0) { z->state = inflate_gzip_next(z, ST_GZIP_EXTRA); break; }
+        inflate_byte(z);
+        z->extraLeft--;
+        break;
+    case ST_GZIP_NAME:
+    case ST_GZIP_COMMENT:
+        if (inflate_byte(z) == 0) z->state = inflate_gzip_next(z, z->state);
+        break;
+    case ST_GZIP_HCRC:
+        inflate_bits(z, 16);
+        z->state = ST_BLOCK_HEADER;
+        break;
+    case ST_DEFLATE_DETECT: {
+        // RFC 1950 header if it checks out, otherwise the raw deflate some servers send
+        unsigned cmf = inflate_byte(z), flg = inflate_byte(z);
+        if ((cmf & 0x0F) == 8 && (cmf >> 4) <= 7 && ((cmf << 8) | flg) % 31 == 0) {
+            if (flg & 0x20) { inflate_fail(z, "zlib preset dictionary not supported"); break; }
+            z->state = ST_BLOCK_HEADER;
+        } else {
+            z->raw = 1;
+            z->inPos = z->savedPos;
+            z->bitBuf = z->savedBitBuf;
+            z->bitCount = z->savedBitCount;
+            z->state = ST_BLOCK_HEADER;
+        }
+        break;
+    }
+    case ST_BLOCK_HEADER: {
+        int final = (int)inflate_bits(z, 1);
+        int type = (int)inflate_bits(z, 2);
+        if (type == 0) {
+            inflate_align(z);
+            unsigned len = inflate_bits(z, 16);
+            unsigned nlen = inflate_bits(z, 16);
+            if (len != (~nlen & 0xFFFF)) { inflate_fail(z, "stored block length mismatch"); break; }
+            z->storedLeft = len;
+            z->state = ST_STORED;
+        } else if (type == 1) {
+            inflate_fixed(z);
+            z->state = ST_CODES;
+        } else if (type == 2) {
+            const char* error = inflate_dynamic(z);
+            if (error) { inflate_fail(z, error); break; }
+            z->state = ST_CODES;
+        } else {
+            inflate_fail(z, "invalid block type");
+            break;
+        }
+        z->final = final;
+        break;
+    }
+    case ST_STORED:
+        // Byte aligned: drain whole bytes still in the bit buffer, then copy
+        while (z->storedLeft > 0 && z->bitCount >= 8) {
+            inflate_put(z, (unsigned char)inflate_byte(z));
+            z->storedLeft--;
+        }
+        while (z->storedLeft > 0 && z->inPos < z->inLen) {
+            inflate_put(z, z->in[z->inPos++]);
+            z->storedLeft--;
+        }
+        if (z->storedLeft == 0) z->state = z->final ? ST_TRAILER : ST_BLOCK_HEADER;
+        else longjmp(z->outOfInput, 2);           // Progress kept, wait for input
+        break;
+    case ST_CODES: {
+        int symbol = inflate_decode(z, &z->lencode);
+        if (symbol < 0) { inflate_fail(z, "bad literal/length code"); break; }
+        if (symbol < 256) { inflate_put(z, (unsigned char)symbol); break; }
+        if (symbol == 256) { z->state = z->final ? ST_TRAILER : ST_BLOCK_HEADER; break; }
+
+        symbol -= 257;
+        if (symbol >= 29) { inflate_fail(z, "bad length symbol"); break; }
+        unsigned len = (unsigned)lengthBase[symbol] + inflate_bits(z, lengthExtra[symbol]);
+        symbol = inflate_decode(z, &z->distcode);
+        if (symbol < 0 || symbol >= 30) { inflate_fail(z, "bad distance symbol"); break; }
+        size_t dist = (size_t)distBase[symbol] + inflate_bits(z, distExtra[symbol]);
+        if (dist > z->written || dist > INFLATE_WINDOW) { inflate_fail(z, "distance too far back"); break; }
+
+        while (len--) inflate_put(z, z->window[(z->written - dist) & (INFLATE_WINDOW - 1)]);
+        break;
+    }
+    case ST_TRAILER:
+        inflate_align(z);
+        if (z->format == INFLATE_GZIP) {
+            unsigned long crc = inflate_le32(z);
+            unsigned long isize = inflate_le32(z);
+            inflate_flush(z);
+            if (crc != z->crc) { inflate_fail(z, "gzip CRC mismatch"); break; }
+            if (isize != (unsigned long)(z->written & 0xFFFFFFFFUL)) { inflate_fail(z, "gzip length mismatch"); break; }
+        } else if (!z->raw) {
+            unsigned long adler = 0;
+            for (int i = 0; i < 4; i++) adler = (adler << 8) | inflate_byte(z);
+            inflate_flush(z);
+            if (adler != ((z->adlerB << 16) | z->adlerA)) { inflate_fail(z, "zlib checksum mismatch"); break; }
+        }
+        z->state = ST_DONE;
+        break;
+    }
+}
+
+// Runs steps over z->in until input runs out or decoding ends
+static void inflate_run(Inflater* z) {
+    while (z->state != ST_DONE && z->state != ST_ERROR && !z->stopped) {
+        z->savedPos = z->inPos;
+        z->savedBitBuf = z->bitBuf;
+        z->savedBitCount = z->bitCount;
+        int jumped = setjmp(z->outOfInput);
+        if (jumped == 1) {
+            z->inPos = z->savedPos;
+            z->bitBuf = z->savedBitBuf;
+            z->bitCount = z->savedBitCount;
+            return;
+        }
+        if (jumped == 2) return;
+        inflate_step(z);
+    }
+}
+
+// --- Public API ---
+
+int inflate_init(Inflater* z, InflateFormat format) {
+    memset(z, 0, sizeof(*z));
+    z->window = (unsigned char*)malloc(INFLATE_WINDOW);
+    if (!z->window) return 0;
+    z->format = format;
+    z->state = format == INFLATE_GZIP ? ST_GZIP_HEADER : ST_DEFLATE_DETECT;
+    z->adlerA = 1;
+    return 1;
+}
+
+void inflate_free(Inflater* z) {
+    free(z->window);
+    z->window = NULL;
+}
+
+InflateStatus inflate_feed(Inflater* z, const void* data, size_t len, InflateSink sink, void* ctx) {
+    const unsigned char* p = (const unsigned char*)data;
+    z->sink = sink;
+    z->sinkCtx = ctx;
+
+    while (z->state != ST_DONE && z->state != ST_ERROR && !z->stopped) {
+        if (z->holdLen > 0) {
+            // Finish the step left over from the last feed on hold + the start of this chunk
+            size_t take = INFLATE_HOLD - z->holdLen;
+            if (take > len) take = len;
+            memcpy(z->hold + z->holdLen, p, take);
+            z->in = z->hold;
+            z->inLen = z->holdLen + take;
+            z->inPos = 0;
+            inflate_run(z);
+
+            if (z->inPos >= z->holdLen) {
+                size_t used = z->inPos - z->holdLen;
+                p += used;
+                len -= used;
+                z->holdLen = 0;
+                continue;
+            }
+            if (take < len && z->state != ST_DONE && z->state != ST_ERROR && !z->stopped) {
+                inflate_fail(z, "step larger than the input hold");
+                break;
+            }
+            memmove(z->hold, z->hold + z->inPos, z->inLen - z->inPos);
+            z->holdLen = z->inLen - z->inPos;
+            break;
+        }
+
+        z->in = p;
+        z->inLen = len;
+        z->inPos = 0;
+        inflate_run(z);
+        size_t left = len - z->inPos;
+        if (z->state != ST_DONE && z->state != ST_ERROR && !z->stopped) {
+            if (left > INFLATE_HOLD) {
+                inflate_fail(z, "step larger than the input hold");
+                break;
+            }
+            memcpy(z->hold, p + z->inPos, left);
+            z->holdLen = left;
+        }
+        break;
+    }
+
+    inflate_flush(z);
+    z->in = NULL;
+    z->inLen = z->inPos = 0;
+
+    if (z->state == ST_ERROR) return INFLATE_ERROR;
+    if (z->stopped) return INFLATE_STOPPED;
+    if (z->state == ST_DONE) return INFLATE_DONE;
+    return INFLATE_MORE;
+}
+
+size_t inflate_total_out(const Inflater* z) {
+    return z->written;
+}
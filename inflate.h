@@ -0,0 +1,94 @@
+// inflate.h
+// Streaming gzip / zlib / raw deflate decoder for compressed responses.
+//
+// Input is fed in chunks of any size as it arrives; decoded bytes are passed
+// to a sink as soon as they are produced, so a parser downstream sees the
+// document while it is still downloading. Work that needs more input than
+// is available (a Huffman symbol, a block header) is rolled back and
+// resumed on the next feed, keeping at most a few hundred bytes of input.
+// Trailing checksums (gzip CRC-32, zlib Adler-32) are verified.
+// Not thread-safe: one Inflater per stream.
+#ifndef INFLATE_H
+#define INFLATE_H
+
+#include <stddef.h>
+#include <setjmp.h>
+
+#define INFLATE_WINDOW 32768      // Deflate's largest back-reference distance
+#define INFLATE_HOLD   1024       // Input kept between feeds, above the largest atomic step
+
+typedef enum {
+    INFLATE_GZIP,                 // Content-Encoding: gzip
+    INFLATE_DEFLATE               // Content-Encoding: deflate, zlib-wrapped or raw
+} InflateFormat;
+
+typedef enum {
+    INFLATE_MORE,                 // All input used, stream not finished
+    INFLATE_DONE,                 // Stream complete and verified; later input is ignored
+    INFLATE_STOPPED,              // The sink asked to stop
+    INFLATE_ERROR                 // Corrupt stream, see error
+} InflateStatus;
+
+// Receives decoded bytes; returns non-zero to stop decoding
+typedef int (*InflateSink)(void* ctx, const char* data, size_t len);
+
+typedef struct {
+    short count[16];              // Codes of each length
+    short symbol[288];            // Symbols ordered by code
+} InflateHuffman;
+
+typedef struct {
+    int state;
+    int final;                    // Current block is the last one
+    InflateFormat format;
+    int raw;                      // Deflate without zlib wrapper: no trailer
+    const char* error;
+
+    // Bit input; in points at hold or at the caller's chunk while feeding
+    const unsigned char* in;
+    size_t inLen;
+    size_t inPos;
+    unsigned long bitBuf;
+    int bitCount;
+    unsigned char hold[INFLATE_HOLD];
+    size_t holdLen;
+    jmp_buf outOfInput;
+
+    // Step in progress: restored when it runs out of input
+    size_t savedPos;
+    unsigned long savedBitBuf;
+    int savedBitCount;
+
+    // gzip header fields being skipped
+    int gzipFlags;
+    unsigned extraLeft;
+
+    unsigned storedLeft;          // Bytes left in a stored block
+
+    InflateHuffman lencode;       // Literal/length codes of the current block
+    InflateHuffman distcode;
+
+    // Output window, flushed to the sink whenever it wraps or a feed ends
+    unsigned char* window;
+    size_t written;               // Bytes ever produced
+    size_t flushed;               // Bytes ever passed to the sink
+    InflateSink sink;
+    void* sinkCtx;
+    int stopped;
+
+    unsigned long crc;            // gzip CRC-32 of the output
+    unsigned long adlerA;         // zlib Adler-32 of the output
+    unsigned long adlerB;
+} Inflater;
+
+// Returns 0 when out of memory
+int inflate_init(Inflater* z, InflateFormat format);
+void inflate_free(Inflater* z);
+
+// Decodes a chunk of input, calling sink with the output produced
+InflateStatus inflate_feed(Inflater* z, const void* data, size_t len, InflateSink sink, void* ctx);
+
+// Decoded bytes produced so far
+size_t inflate_total_out(const Inflater* z);
+
+#endif // INFLATE_H
@@ -0,0 +1,179 @@
+// intern.c
+#include "intern.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INTERN_INITIAL_BUCKETS 64
+#define INTERN_INITIAL_ARENA   4096
+#define INTERN_MIN_COMPACT     4096   // Garbage below this is never worth a compaction
+
+static unsigned intern_hash(const char* s, size_t len) {
+    unsigned h = 2166136261u;   // FNV-1a
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)s[i]) * 16777619u;
+    }
+    return h;
+}
+
+void intern_init(InternTable* t) {
+    memset(t, 0, sizeof(*t));
+}
+
+void intern_free(InternTable* t) {
+    free(t->arena);
+    free(t->slots);
+    free(t->buckets);
+    memset(t, 0, sizeof(*t));
+}
+
+// First use: slot 0 and the empty string
+static int intern_setup(InternTable* t) {
+    if (t->slots) return 1;
+
+    t->arena = (char*)malloc(INTERN_INITIAL_ARENA);
+    t->slots = (InternSlot*)calloc(INTERN_INITIAL_BUCKETS, sizeof(InternSlot));
+    t->buckets = (unsigned*)calloc(INTERN_INITIAL_BUCKETS, sizeof(unsigned));
+    if (!t->arena || !t->slots || !t->buckets) {
+        intern_free(t);
+        return 0;
+    }
+    t->arenaCap = INTERN_INITIAL_ARENA;
+    t->arena[0] = '\0';
+    t->arenaUsed = 1;
+    t->slotCap = INTERN_INITIAL_BUCKETS;
+    t->slotCount = 1;
+    t->bucketCount = INTERN_INITIAL_BUCKETS;
+    return 1;
+}
+
+static int intern_grow_buckets(InternTable* t) {
+    unsigned count = t->bucketCount * 2;
+    unsigned* buckets = (unsigned*)calloc(count, sizeof(unsigned));
+    if (!buckets) return 0;
+
+    for (unsigned id = 1; id < t->slotCount; id++) {
+        InternSlot* slot = &t->slots[id];
+        if (!slot->refs) continue;
+        unsigned b = slot->hash & (count - 1);
+        slot->next = buckets[b];
+        buckets[b] = id;
+    }
+    free(t->buckets);
+    t->buckets = buckets;
+    t->bucketCount = count;
+    return 1;
+}
+
+// Rewrites the arena with only the live strings
+static void intern_compact(InternTable* t) {
+    size_t size = t->arenaUsed - t->arenaGarbage;
+    size_t cap = INTERN_INITIAL_ARENA;
+    while (cap < size) cap *= 2;
+    char* arena = (char*)malloc(cap);
+    if (!arena) return;
+
+    arena[0] = '\0';
+    size_t used = 1;
+    for (unsigned id = 1; id < t->slotCount; id++) {
+        InternSlot* slot = &t->slots[id];
+        if (!slot->refs) continue;
+        memcpy(arena + used, t->arena + slot->offset, slot->len + 1);
+        slot->offset = (unsigned)used;
+        used += slot->len + 1;
+    }
+    free(t->arena);
+    t->arena = arena;
+    t->arenaUsed = used;
+    t->arenaCap = cap;
+    t->arenaGarbage = 0;
+}
+
+static unsigned intern_new_slot(InternTable* t) {
+    if (t->freeSlot) {
+        unsigned id = t->freeSlot;
+        t->freeSlot = t->slots[id].next;
+        return id;
+    }
+    if (t->slotCount == t->slotCap) {
+        InternSlot* slots = (InternSlot*)realloc(t->slots, (size_t)t->slotCap * 2 * sizeof(InternSlot));
+        if (!slots) return INTERN_EMPTY;
+        t->slots = slots;
+        t->slotCap *= 2;
+    }
+    return t->slotCount++;
+}
+
+unsigned intern_add(InternTable* t, const char* s, size_t len) {
+    if (!s || len == 0 || !intern_setup(t)) return INTERN_EMPTY;
+    if (len > INTERN_MAX_LEN) len = INTERN_MAX_LEN;
+
+    unsigned hash = intern_hash(s, len);
+    for (unsigned id = t->buckets[hash & (t->bucketCount - 1)]; id; id = t->slots[id].next) {
+        InternSlot* slot = &t->slots[id];
+        if (slot->hash == hash && slot->len == len && memcmp(t->arena + slot->offset, s, len) == 0) {
+            slot->refs++;
+            return id;
+        }
+    }
+
+    if (t->arenaUsed + len + 1 > t->arenaCap) {
+        size_t cap = t->arenaCap;
+        while (cap < t->arenaUsed + len + 1) cap *= 2;
+        char* arena = (char*)realloc(t->arena, cap);
+        if (!arena) return INTERN_EMPTY;
+        t->arena = arena;
+        t->arenaCap = cap;
+    }
+    if (t->live + 1 > t->bucketCount - t->bucketCount / 4) intern_grow_buckets(t);
+
+    unsigned id = intern_new_slot(t);
+    if (id == INTERN_EMPTY) return INTERN_EMPTY;
+
+    InternSlot* slot = &t->slots[id];
+    slot->offset = (unsigned)t->arenaUsed;
+    slot->len = (unsigned)len;
+    slot->hash = hash;
+    slot->refs = 1;
+    memcpy(t->arena + t->arenaUsed, s, len);
+    t->arena[t->arenaUsed + len] = '\0';
+    t->arenaUsed += len + 1;
+
+    unsigned b = hash & (t->bucketCount - 1);
+    slot->next = t->buckets[b];
+    t->buckets[b] = id;
+    t->live++;
+    return id;
+}
+
+void intern_retain(InternTable* t, unsigned id) {
+    if (id != INTERN_EMPTY && id < t->slotCount) t->slots[id].refs++;
+}
+
+void intern_release(InternTable* t, unsigned id) {
+    if (id == INTERN_EMPTY || id >= t->slotCount) return;
+    InternSlot* slot = &t->slots[id];
+    if (!slot->refs || --slot->refs) return;
+
+    // Unlink from its hash chain
+    unsigned* link = &t->buckets[slot->hash & (t->bucketCount - 1)];
+    while (*link && *link != id) link = &t->slots[*link].next;
+    if (*link) *link = slot->next;
+
+    slot->next = t->freeSlot;
+    t->freeSlot = id;
+    t->live--;
+    t->arenaGarbage += slot->len + 1;
+
+    if (t->arenaGarbage > INTERN_MIN_COMPACT && t->arenaGarbage > t->arenaUsed / 2) {
+        intern_compact(t);
+    }
+}
+
+const char* intern_get(const InternTable* t, unsigned id) {
+    if (id == INTERN_EMPTY || id >= t->slotCount || !t->slots[id].refs) return "";
+    return t->arena + t->slots[id].offset;
+}
+
+size_t intern_memory(const InternTable* t) {
+    return t->arenaCap + (size_t)t->slotCap * sizeof(InternSlot) + (size_t)t->bucketCount * sizeof(unsigned);
+}
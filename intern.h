@@ -0,0 +1,58 @@
+// intern.h
+// Interned, reference-counted strings.
+//
+// Each distinct string is stored once in a shared byte arena and named by a
+// small integer ID, so records that repeat the same few messages hold 4-byte
+// IDs instead of copies. IDs stay valid while referenced; once the last
+// reference is released the slot is reused and its bytes become garbage,
+// which is reclaimed by compacting the arena when it outweighs the live text.
+// Not thread-safe: callers serialize access.
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stddef.h>
+
+#define INTERN_EMPTY 0u           // ID of "", never counted or freed
+#define INTERN_MAX_LEN 65535      // Longer strings are cut to this
+
+typedef struct {
+    unsigned offset;              // Start of the text in the arena
+    unsigned len;
+    unsigned hash;
+    unsigned refs;                // 0 = free slot
+    unsigned next;                // Next slot in the hash chain, or in the free list
+} InternSlot;
+
+typedef struct {
+    char* arena;                  // NUL-terminated strings, back to back
+    size_t arenaUsed;
+    size_t arenaCap;
+    size_t arenaGarbage;          // Bytes belonging to released strings
+
+    InternSlot* slots;            // Slot 0 is INTERN_EMPTY
+    unsigned slotCount;
+    unsigned slotCap;
+    unsigned freeSlot;            // Head of the free-slot list, 0 when empty
+
+    unsigned* buckets;            // Hash chains of live slots; 0 ends a chain
+    unsigned bucketCount;         // Power of two
+    unsigned live;                // Strings with refs > 0
+} InternTable;
+
+void intern_init(InternTable* t);
+void intern_free(InternTable* t);
+
+// Returns the ID of the string, adding a reference (INTERN_EMPTY for "" or
+// when memory runs out)
+unsigned intern_add(InternTable* t, const char* s, size_t len);
+
+void intern_retain(InternTable* t, unsigned id);
+void intern_release(InternTable* t, unsigned id);
+
+// Text of a live ID; the pointer is valid until the next add or release
+const char* intern_get(const InternTable* t, unsigned id);
+
+// Bytes allocated for the arena, slots and hash buckets
+size_t intern_memory(const InternTable* t);
+
+#endif // INTERN_H
@@ -0,0 +1,178 @@
+// journal.c
+#include "journal.h"
+#include <windows.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define JOURNAL_MAGIC    0x4A4D5041   // "APMJ"
+#define JOURNAL_VERSION  1
+
+typedef struct {
+    DWORD magic;
+    DWORD version;
+} JournalFileHeader;
+
+typedef struct {
+    DWORD len;
+    DWORD crc;
+} JournalRecordHeader;
+
+// CRC-32 (IEEE, reflected); records are small and rarely read, so no table
+static DWORD journal_crc32(const unsigned char* p, size_t n) {
+    DWORD crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < n; i++) {
+        crc ^= p[i];
+        for (int k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+// Reads the whole file; returns NULL (and *size 0) when it is empty or unreadable
+static unsigned char* journal_read_all(HANDLE file, size_t* size) {
+    LARGE_INTEGER fileSize;
+    *size = 0;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0 || fileSize.QuadPart > 0x7FFFFFFF) return NULL;
+
+    unsigned char* data = (unsigned char*)malloc((size_t)fileSize.QuadPart);
+    if (!data) return NULL;
+
+    LARGE_INTEGER zero = {0};
+    DWORD read = 0;
+    SetFilePointerEx(file, zero, NULL, FILE_BEGIN);
+    if (!ReadFile(file, data, (DWORD)fileSize.QuadPart, &read, NULL)) {
+        free(data);
+        return NULL;
+    }
+    *size = read;
+    return data;
+}
+
+// Walks the records after the file header. Returns the offset just past the
+// last intact record, or 0 if the header itself is missing or wrong.
+static size_t journal_scan(const unsigned char* data, size_t size, JournalRecordFn fn, void* ctx,
+                           size_t* records) {
+    JournalFileHeader header;
+    *records = 0;
+    if (size < sizeof(header)) return 0;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != JOURNAL_MAGIC || header.version != JOURNAL_VERSION) return 0;
+
+    size_t pos = sizeof(header);
+    while (size - pos >= sizeof(JournalRecordHeader)) {
+        JournalRecordHeader rec;
+        memcpy(&rec, data + pos, sizeof(rec));
+        if (rec.len > JOURNAL_MAX_RECORD || rec.len > size - pos - sizeof(rec)) break;
+
+        const unsigned char* payload = data + pos + sizeof(rec);
+        if (journal_crc32(payload, rec.len) != rec.crc) break;
+
+        if (fn) fn(ctx, payload, rec.len);
+        (*records)++;
+        pos += sizeof(rec) + rec.len;
+    }
+    return pos;
+}
+
+static int journal_write(HANDLE file, const void* data, size_t len) {
+    DWORD written = 0;
+    return WriteFile(file, data, (DWORD)len, &written, NULL) && written == len;
+}
+
+// Cuts the file at end, writing a fresh header when end is 0
+static int journal_truncate(Journal* j, size_t end) {
+    HANDLE file = (HANDLE)j->file;
+    LARGE_INTEGER pos;
+    pos.QuadPart = (LONGLONG)end;
+    if (!SetFilePointerEx(file, pos, NULL, FILE_BEGIN) || !SetEndOfFile(file)) return 0;
+
+    if (end == 0) {
+        JournalFileHeader header = { JOURNAL_MAGIC, JOURNAL_VERSION };
+        if (!journal_write(file, &header, sizeof(header))) return 0;
+        end = sizeof(header);
+    }
+    j->size = end;
+    return 1;
+}
+
+int journal_open(Journal* j, const char* path, JournalRecordFn fn, void* ctx) {
+    memset(j, 0, sizeof(*j));
+    HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL,
+                              OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return 0;
+    j->file = file;
+
+    size_t size = 0;
+    unsigned char* data = journal_read_all(file, &size);
+    size_t end = journal_scan(data, size, fn, ctx, &j->records);
+    free(data);
+
+    j->discarded = size - end;
+    if (end < size || end == 0) {
+        if (!journal_truncate(j, end)) {
+            journal_close(j);
+            return 0;
+        }
+    } else {
+        j->size = end;
+    }
+
+    LARGE_INTEGER zero = {0};
+    SetFilePointerEx(file, zero, NULL, FILE_END);
+    return 1;
+}
+
+long journal_replay(const char* path, JournalRecordFn fn, void* ctx) {
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return -1;
+
+    size_t size = 0;
+    size_t records = 0;
+    unsigned char* data = journal_read_all(file, &size);
+    size_t end = journal_scan(data, size, fn, ctx, &records);
+    free(data);
+    CloseHandle(file);
+    return end == 0 ? -1 : (long)records;
+}
+
+int journal_append(Journal* j, const void* data, size_t len) {
+    if (!j->file || len > JOURNAL_MAX_RECORD) return 0;
+
+    // Header and payload go out in one write so a record is never split by another
+    unsigned char stackBuf[1024];
+    size_t total = sizeof(JournalRecordHeader) + len;
+    unsigned char* buf = total <= sizeof(stackBuf) ? stackBuf : (unsigned char*)malloc(total);
+    if (!buf) return 0;
+
+    JournalRecordHeader rec = { (DWORD)len, journal_crc32((const unsigned char*)data, len) };
+    memcpy(buf, &rec, sizeof(rec));
+    memcpy(buf + sizeof(rec), data, len);
+    int ok = journal_write((HANDLE)j->file, buf, total);
+    if (buf != stackBuf) free(buf);
+
+    if (ok) {
+        j->records++;
+        j->size += total;
+    } else {
+        // Cut off whatever part of the record reached the file, or the next
+        // open would stop at the tear and drop every record appended after it
+        journal_truncate(j, j->size);
+    }
+    return ok;
+}
+
+int journal_sync(Journal* j) {
+    return j->file && FlushFileBuffers((HANDLE)j->file);
+}
+
+int journal_reset(Journal* j) {
+    if (!j->file || !journal_truncate(j, 0)) return 0;
+    j->records = 0;
+    return journal_sync(j);
+}
+
+void journal_close(Journal* j) {
+    if (j->file) CloseHandle((HANDLE)j->file);
+    j->file = NULL;
+}
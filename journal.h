@@ -0,0 +1,46 @@
+// journal.h
+// Append-only file of checksummed records.
+//
+// Each record is written with a single WriteFile as a length, a CRC-32 and the
+// payload, so a crash can at worst leave one torn record at the end of the
+// file. Opening a journal replays every intact record and cuts off anything
+// after the first bad one, so later appends continue from a clean end.
+// Snapshots use the same format: write a fresh journal to a temporary file,
+// sync it, then move it over the previous snapshot.
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stddef.h>
+
+#define JOURNAL_MAX_RECORD 65536   // Larger length fields are treated as corruption
+
+typedef struct {
+    void* file;              // HANDLE, NULL when closed
+    size_t records;          // Intact records in the file
+    size_t size;             // File size in bytes
+    size_t discarded;        // Bytes of torn or corrupt tail dropped when opened
+} Journal;
+
+// Called once per intact record, oldest first
+typedef void (*JournalRecordFn)(void* ctx, const void* data, size_t len);
+
+// Opens (creating if needed) a journal for appending, replaying its records
+// through fn first (fn may be NULL). Returns 0 if the file cannot be opened.
+int journal_open(Journal* j, const char* path, JournalRecordFn fn, void* ctx);
+
+// Replays a journal without opening it for writing; returns the number of
+// intact records, or -1 if the file does not exist or is not a journal
+long journal_replay(const char* path, JournalRecordFn fn, void* ctx);
+
+// Appends one record. It reaches the disk with the next journal_sync(). A
+// failed or short write is cut off again, so later records stay readable.
+int journal_append(Journal* j, const void* data, size_t len);
+
+int journal_sync(Journal* j);
+
+// Drops every record (after they have been folded into a snapshot)
+int journal_reset(Journal* j);
+
+void journal_close(Journal* j);
+
+#endif // JOURNAL_H
@@ -0,0 +1,343 @@
+// logger.c
+#include "logger.h"
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOGGER_RING_MASK   (LOGGER_RING_SLOTS - 1)
+#define LOGGER_BATCH_SIZE  (64 * 1024)
+
+// Distance from b to a on the wrapping position counters
+#define LOGGER_DIFF(a, b)  ((LONG)((ULONG)(a) - (ULONG)(b)))
+
+// Ring slot. sequence == position: free for the producer claiming that
+// position; sequence == position + 1: line published for the writer.
+typedef struct {
+    volatile LONG sequence;
+    LONG len;
+    LONG prefixLen;              // Timestamp and thread ID; the message follows
+    char text[LOGGER_LINE_MAX];
+} LoggerSlot;
+
+static struct {
+    LoggerSlot ring[LOGGER_RING_SLOTS];
+    volatile LONG enqueuePos;    // Next position a producer claims
+    volatile LONG dequeuePos;    // Next position the writer reads (writer thread only writes it)
+    volatile LONG dropped;       // Lines lost to a full ring since the last batch
+    volatile LONG stopping;
+    HANDLE wake;
+    HANDLE thread;
+    char path[MAX_PATH];
+
+    // Writer thread only
+    HANDLE file;
+    LONGLONG fileSize;
+    char batch[LOGGER_BATCH_SIZE];
+    size_t batchUsed;
+    char last[LOGGER_LINE_MAX];  // Message of the last line written, without its prefix
+    LONG lastLen;
+    char repeatPrefix[64];       // Prefix of the latest repeat of it
+    LONG repeatPrefixLen;
+    LONG repeats;                // Identical lines held back since it was written
+} g_logger;
+
+static int g_loggerReady = 0;
+
+// Rotation policy (see logger_configure)
+static volatile LONG g_loggerMaxKB = LOGGER_DEFAULT_MAX_KB;
+static volatile LONG g_loggerArchives = LOGGER_DEFAULT_ARCHIVES;
+static volatile LONG g_loggerCompress = 0;
+
+static void logger_init_ring(void) {
+    if (g_loggerReady) return;
+    for (LONG i = 0; i < LOGGER_RING_SLOTS; i++) {
+        g_logger.ring[i].sequence = i;
+    }
+    g_loggerReady = 1;
+}
+
+// "[YYYY-MM-DD HH:MM:SS] [TID:n] "; returns its length
+static int logger_prefix(char* out, size_t outLen) {
+    SYSTEMTIME st;
+    GetLocalTime(&st);
+    int n = snprintf(out, outLen, "[%04d-%02d-%02d %02d:%02d:%02d] [TID:%lu] ",
+                     st.wYear, st.wMonth, st.wDay, st.wHour, st.wMinute, st.wSecond,
+                     GetCurrentThreadId());
+    return (n < 0 || (size_t)n >= outLen) ? 0 : n;
+}
+
+// Formats prefix + message + newline into the slot (not NUL-terminated)
+static void logger_format(LoggerSlot* slot, const char* format, va_list args) {
+    int n = logger_prefix(slot->text, LOGGER_LINE_MAX);
+    size_t space = (size_t)(LOGGER_LINE_MAX - n);
+    int m = vsnprintf(slot->text + n, space, format, args);
+    if (m < 0 || (size_t)m >= space) m = (int)space - 1;   // Truncated
+    slot->text[n + m] = '\n';
+    slot->prefixLen = n;
+    slot->len = n + m + 1;
+}
+
+void logger_write(const char* format, va_list args) {
+    logger_init_ring();
+
+    // Claim a slot
+    LONG pos = g_logger.enqueuePos;
+    LoggerSlot* slot;
+    for (;;) {
+        slot = &g_logger.ring[pos & LOGGER_RING_MASK];
+        LONG diff = LOGGER_DIFF(slot->sequence, pos);
+        if (diff == 0) {
+            LONG seen = InterlockedCompareExchange(&g_logger.enqueuePos, pos + 1, pos);
+            if (seen == pos) break;
+            pos = seen;
+        } else if (diff < 0) {
+            // Writer has not freed this slot yet: the ring is full
+            InterlockedIncrement(&g_logger.dropped);
+            return;
+        } else {
+            pos = g_logger.enqueuePos;
+        }
+    }
+
+    logger_format(slot, format, args);
+    InterlockedExchange(&slot->sequence, pos + 1);
+
+    // Don't wait for the timer once the ring is getting full
+    if (g_logger.wake && LOGGER_DIFF(pos, g_logger.dequeuePos) >= LOGGER_RING_SLOTS / 2) {
+        SetEvent(g_logger.wake);
+    }
+}
+
+// "<dir>\APIMonitor.log" -> "<dir>\APIMonitor.<index>.log"
+static void logger_archive_path(int index, char* out, size_t outLen) {
+    const char* dot = strrchr(g_logger.path, '.');
+    const char* slash = strrchr(g_logger.path, '\\');
+    size_t stem = (dot && (!slash || dot > slash)) ? (size_t)(dot - g_logger.path) : strlen(g_logger.path);
+    snprintf(out, outLen, "%.*s.%d%s", (int)stem, g_logger.path, index, g_logger.path + stem);
+}
+
+// Turns on NTFS compression for an archive. Runs on a thread-pool thread
+// because the file system compresses the existing data before returning.
+static DWORD WINAPI logger_compress(LPVOID param) {
+    char* path = (char*)param;
+    HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file != INVALID_HANDLE_VALUE) {
+        USHORT format = COMPRESSION_FORMAT_DEFAULT;
+        DWORD returned = 0;
+        DeviceIoControl(file, FSCTL_SET_COMPRESSION, &format, sizeof(format), NULL, 0, &returned, NULL);
+        CloseHandle(file);
+    }
+    free(path);
+    return 0;
+}
+
+static int logger_open(void) {
+    g_logger.file = CreateFileA(g_logger.path, GENERIC_WRITE,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (g_logger.file == INVALID_HANDLE_VALUE) return 0;
+
+    LARGE_INTEGER size, zero = {0};
+    if (!SetFilePointerEx(g_logger.file, zero, &size, FILE_END)) {
+        CloseHandle(g_logger.file);
+        g_logger.file = INVALID_HANDLE_VALUE;
+        return 0;
+    }
+    g_logger.fileSize = size.QuadPart;
+    return 1;
+}
+
+static void logger_write_line(const char* format, ...) {
+    char line[MAX_PATH + 128];
+    int n = logger_prefix(line, sizeof(line));
+    va_list args;
+    va_start(args, format);
+    int m = vsnprintf(line + n, sizeof(line) - n - 1, format, args);
+    va_end(args);
+    if (m < 0 || (size_t)m >= sizeof(line) - n - 1) m = (int)(sizeof(line) - n - 2);
+    line[n + m] = '\n';
+
+    DWORD written = 0;
+    WriteFile(g_logger.file, line, (DWORD)(n + m + 1), &written, NULL);
+    g_logger.fileSize += written;
+}
+
+// Shifts the archives up by one and starts a new file
+static void logger_rotate(void) {
+    char from[MAX_PATH + 16];
+    char to[MAX_PATH + 16];
+    int archives = (int)g_loggerArchives;
+
+    CloseHandle(g_logger.file);
+    g_logger.file = INVALID_HANDLE_VALUE;
+
+    logger_archive_path(archives, to, sizeof(to));
+    DeleteFileA(to);
+    for (int i = archives - 1; i >= 1; i--) {
+        logger_archive_path(i, from, sizeof(from));
+        logger_archive_path(i + 1, to, sizeof(to));
+        MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING);
+    }
+    logger_archive_path(1, to, sizeof(to));
+    BOOL moved = MoveFileExA(g_logger.path, to, MOVEFILE_REPLACE_EXISTING);
+    DWORD error = moved ? 0 : GetLastError();
+
+    if (!logger_open()) return;
+    if (!moved) {
+        // Someone holds the file without sharing delete access: keep appending
+        // rather than lose anything, and try again after another full file
+        logger_write_line("WARNING: Log rotation failed (error %lu), continuing in the current file.", error);
+        g_logger.fileSize = 0;
+        return;
+    }
+
+    logger_write_line("Log rotated, previous entries are in %s.", to);
+    if (g_loggerCompress) {
+        char* path = _strdup(to);
+        if (path && !QueueUserWorkItem(logger_compress, path, WT_EXECUTELONGFUNCTION)) free(path);
+    }
+}
+
+// Appends a batch to the file, opening or rotating it as needed
+static void logger_flush(const char* data, size_t len) {
+    if (g_logger.file == INVALID_HANDLE_VALUE && !logger_open()) return;   // Retried with the next batch
+
+    LONGLONG maxSize = (LONGLONG)g_loggerMaxKB * 1024;
+    if (g_logger.fileSize > 0 && g_logger.fileSize + (LONGLONG)len > maxSize) {
+        logger_rotate();
+        if (g_logger.file == INVALID_HANDLE_VALUE) return;
+    }
+
+    DWORD written = 0;
+    WriteFile(g_logger.file, data, (DWORD)len, &written, NULL);
+    g_logger.fileSize += written;
+}
+
+// Adds to the pending batch, writing the batch out first if it is full
+static void logger_batch_add(const char* data, size_t len) {
+    if (g_logger.batchUsed + len > sizeof(g_logger.batch)) {
+        logger_flush(g_logger.batch, g_logger.batchUsed);
+        g_logger.batchUsed = 0;
+    }
+    memcpy(g_logger.batch + g_logger.batchUsed, data, len);
+    g_logger.batchUsed += len;
+}
+
+// Closes a run of identical lines with a single count
+static void logger_end_repeats(void) {
+    if (!g_logger.repeats) return;
+
+    char line[160];
+    int n = (int)g_logger.repeatPrefixLen;
+    memcpy(line, g_logger.repeatPrefix, (size_t)n);
+    n += snprintf(line + n, sizeof(line) - n, "Previous message repeated %ld more time(s).\n",
+                  (long)g_logger.repeats);
+    logger_batch_add(line, (size_t)n);
+    g_logger.repeats = 0;
+}
+
+// Moves every published line into batches and writes them out. Consecutive
+// lines with the same message are collapsed into one line and a count.
+static void logger_drain(int final) {
+    LONG dropped = InterlockedExchange(&g_logger.dropped, 0);
+    if (dropped) {
+        char line[160];
+        int n = logger_prefix(line, sizeof(line));
+        n += snprintf(line + n, sizeof(line) - n, "WARNING: %ld log line(s) dropped, log queue full.\n", (long)dropped);
+        logger_end_repeats();
+        logger_batch_add(line, (size_t)n);
+        g_logger.lastLen = 0;
+    }
+
+    LONG pos = g_logger.dequeuePos;
+    for (;;) {
+        LoggerSlot* slot = &g_logger.ring[pos & LOGGER_RING_MASK];
+        if (LOGGER_DIFF(slot->sequence, pos + 1) != 0) break;   // Not published yet
+
+        const char* message = slot->text + slot->prefixLen;
+        LONG messageLen = slot->len - slot->prefixLen;
+        if (messageLen == g_logger.lastLen && memcmp(message, g_logger.last, (size_t)messageLen) == 0) {
+            g_logger.repeats++;
+            g_logger.repeatPrefixLen = slot->prefixLen < (LONG)sizeof(g_logger.repeatPrefix) ? slot->prefixLen : 0;
+            memcpy(g_logger.repeatPrefix, slot->text, (size_t)g_logger.repeatPrefixLen);
+        } else {
+            logger_end_repeats();
+            logger_batch_add(slot->text, (size_t)slot->len);
+            memcpy(g_logger.last, message, (size_t)messageLen);
+            g_logger.lastLen = messageLen;
+        }
+
+        // Hand the slot back for the producer that will claim it one lap later
+        InterlockedExchange(&slot->sequence, pos + LOGGER_RING_SLOTS);
+        pos++;
+        g_logger.dequeuePos = pos;
+    }
+
+    if (final) logger_end_repeats();
+    if (g_logger.batchUsed) {
+        logger_flush(g_logger.batch, g_logger.batchUsed);
+        g_logger.batchUsed = 0;
+    }
+}
+
+static DWORD WINAPI logger_thread(LPVOID param) {
+    (void)param;
+    for (;;) {
+        WaitForSingleObject(g_logger.wake, LOGGER_FLUSH_INTERVAL_MS);
+        LONG stopping = g_logger.stopping;
+        logger_drain(stopping);
+        if (stopping) break;
+    }
+
+    if (g_logger.file != INVALID_HANDLE_VALUE) {
+        CloseHandle(g_logger.file);
+        g_logger.file = INVALID_HANDLE_VALUE;
+    }
+    return 0;
+}
+
+void logger_configure(int maxSizeKB, int archives, int compress) {
+    if (maxSizeKB < 64) maxSizeKB = 64;
+    if (archives < 1) archives = 1;
+    if (archives > LOGGER_MAX_ARCHIVES) archives = LOGGER_MAX_ARCHIVES;
+    InterlockedExchange(&g_loggerMaxKB, maxSizeKB);
+    InterlockedExchange(&g_loggerArchives, archives);
+    InterlockedExchange(&g_loggerCompress, compress ? 1 : 0);
+}
+
+int logger_start(const char* path) {
+    logger_init_ring();
+    if (g_logger.thread) return 1;
+
+    strncpy(g_logger.path, path, sizeof(g_logger.path) - 1);
+    g_logger.path[sizeof(g_logger.path) - 1] = '\0';
+    g_logger.file = INVALID_HANDLE_VALUE;
+    g_logger.stopping = 0;
+
+    g_logger.wake = CreateEventA(NULL, FALSE, FALSE, NULL);
+    if (!g_logger.wake) return 0;
+    g_logger.thread = CreateThread(NULL, 0, logger_thread, NULL, 0, NULL);
+    if (!g_logger.thread) {
+        CloseHandle(g_logger.wake);
+        g_logger.wake = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+void logger_stop(void) {
+    if (!g_logger.thread) return;
+
+    InterlockedExchange(&g_logger.stopping, 1);
+    SetEvent(g_logger.wake);
+    WaitForSingleObject(g_logger.thread, INFINITE);
+    CloseHandle(g_logger.thread);
+    g_logger.thread = NULL;
+
+    HANDLE wake = g_logger.wake;
+    g_logger.wake = NULL;
+    CloseHandle(wake);
+}
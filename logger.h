@@ -0,0 +1,48 @@
+// logger.h
+// Asynchronous log writer.
+//
+// Callers format each line straight into a slot of a fixed-size ring shared
+// by all threads; reserving a slot is a single compare-and-swap, so logging
+// never waits on a lock or on the disk. One writer thread keeps the log file
+// open, drains the ring in batches and writes them out every
+// LOGGER_FLUSH_INTERVAL_MS, sooner when the ring is half full, and at
+// shutdown. If the ring fills up, new lines are dropped and counted rather
+// than blocking the caller; the writer then logs how many were lost. The
+// ring holds LOGGER_RING_SLOTS lines, so threads that together log more than
+// that faster than the disk takes them (a sustained burst of thousands of
+// lines per second) lose lines. The first ringful always gets through, and
+// bursts smaller than the ring with time for the writer to drain them in
+// between lose nothing. A run of lines with the same message (whatever
+// their timestamps) is written once, followed by "repeated N more time(s)".
+//
+// The writer tracks the file size itself. When the next batch would take the
+// file past the size limit, the file is rotated: APIMonitor.log becomes
+// APIMonitor.1.log, .1 becomes .2 and so on, and the oldest archive is
+// deleted. A log is never truncated in place. Archives can optionally be
+// NTFS-compressed on a thread-pool thread.
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdarg.h>
+
+#define LOGGER_RING_SLOTS        1024          // Power of two
+#define LOGGER_LINE_MAX          1024          // Longest line kept, including the newline
+#define LOGGER_FLUSH_INTERVAL_MS 200
+#define LOGGER_DEFAULT_MAX_KB    (10 * 1024)   // Rotate once the file would exceed this
+#define LOGGER_DEFAULT_ARCHIVES  5             // APIMonitor.1.log ... APIMonitor.5.log
+#define LOGGER_MAX_ARCHIVES      99
+
+// Starts the writer thread; lines logged before this are kept in the ring.
+// The file is opened when the first batch is written.
+int logger_start(const char* path);
+
+// Sets the rotation policy; takes effect with the next batch
+void logger_configure(int maxSizeKB, int archives, int compress);
+
+// Queues one line, prefixed with the local time and calling thread ID
+void logger_write(const char* format, va_list args);
+
+// Writes out everything queued so far and stops the writer thread
+void logger_stop(void);
+
+#endif // LOGGER_H
@@ -0,0 +1,35 @@
+// mailbox.c
+#include "mailbox.h"
+#include <windows.h>
+
+void mailbox_init(Mailbox* m) {
+    m->head = NULL;
+}
+
+int mailbox_post(Mailbox* m, MailboxNode* node) {
+    // ABA is harmless: the CAS only succeeds while head is the node just
+    // linked to, whatever happened to it in between. A failed CAS hands back
+    // the current head, so only the first guess is a plain (aligned) read.
+    MailboxNode* head = m->head;
+    for (;;) {
+        node->next = head;
+        MailboxNode* seen = (MailboxNode*)InterlockedCompareExchangePointer((PVOID volatile*)&m->head, node, head);
+        if (seen == head) break;
+        head = seen;
+    }
+    return head == NULL;
+}
+
+MailboxNode* mailbox_take(Mailbox* m) {
+    MailboxNode* node = (MailboxNode*)InterlockedExchangePointer((PVOID volatile*)&m->head, NULL);
+
+    // Posted newest first; reverse into posting order
+    MailboxNode* oldest = NULL;
+    while (node) {
+        MailboxNode* next = node->next;
+        node->next = oldest;
+        oldest = node;
+        node = next;
+    }
+    return oldest;
+}
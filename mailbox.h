@@ -0,0 +1,30 @@
+// mailbox.h
+// Multi-producer, single-consumer hand-off of heap records.
+//
+// Producers push with a compare-and-swap loop and never wait for the
+// consumer or for each other beyond a retried CAS. The consumer takes
+// everything posted so far with one exchange and gets it back oldest first.
+// mailbox_post() reports whether the mailbox was empty, so producers can
+// wake the consumer once per batch instead of once per record.
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+// First member of every record posted
+typedef struct MailboxNode {
+    struct MailboxNode* next;
+} MailboxNode;
+
+typedef struct {
+    MailboxNode* volatile head;   // Newest record first
+} Mailbox;
+
+void mailbox_init(Mailbox* m);
+
+// Posts a record; returns non-zero if the mailbox was empty before
+int mailbox_post(Mailbox* m, MailboxNode* node);
+
+// Takes every posted record, oldest first, chained through next (NULL when empty).
+// Consumer only.
+MailboxNode* mailbox_take(Mailbox* m);
+
+#endif // MAILBOX_H
@@ -7,9 +7,22 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stddef.h>
 #include <commctrl.h>
 #include <objbase.h>
 #include "resource.h"
+#include "check.h"
+#include "decoder.h"
+#include "logger.h"
+#include "journal.h"
+#include "intern.h"
+#include "tseries.h"
+#include "mailbox.h"
+#include "deadline.h"
+#include "backoff.h"
+#include "inflate.h"
+#include "url.h"
+#include "slo.h"
 
 #pragma comment(lib, "winhttp.lib")
 #pragma comment(lib, "shell32.lib")
@@ -32,18 +45,90 @@
 #define REG_VALUE_HISTORY_LIMIT "HistoryLimit"
 #define REG_VALUE_HISTORY_COUNT "HistoryCount"
 #define REG_VALUE_HISTORY_DATA  "HistoryData"
+#define REG_VALUE_EXTRA_ENDPOINTS "AdditionalEndpoints"
+#define REG_VALUE_MAX_RESPONSE  "MaxResponseKB"
+#define REG_VALUE_RESPONSE_FORMAT "ResponseFormat"
+#define REG_VALUE_LOG_MAX_SIZE  "LogMaxSizeKB"
+#define REG_VALUE_LOG_FILES     "LogFiles"
+#define REG_VALUE_LOG_COMPRESS  "LogCompress"
+#define REG_VALUE_LOG_LEVEL     "LogLevel"
+#define REG_VALUE_METRICS_DAYS  "MetricsDays"
+#define REG_VALUE_SCHEDULE_MODE "ScheduleMode"
+#define REG_VALUE_RETRY_MAX_DELAY "RetryMaxDelayMs"
+#define REG_VALUE_BACKOFF_MAX   "BackoffMaxSeconds"
+#define REG_VALUE_BREAKER_THRESHOLD "BreakerThreshold"
+#define REG_VALUE_ACCEPT_COMPRESSION "AcceptCompression"
+#define REG_VALUE_DEGRADED_LATENCY "DegradedLatencyMs"
+#define REG_VALUE_DEGRADED_POLLS   "DegradedPolls"
+#define REG_VALUE_DEGRADED_WINDOW  "DegradedWindow"
+
+// History persistence (per-user, under %LOCALAPPDATA%\APIMonitor)
+#define HISTORY_JOURNAL_FILE  "history.journal"    // One record per transition since the last snapshot
+#define HISTORY_SNAPSHOT_FILE "history.snapshot"   // Whole ring as of the last compaction
+#define METRICS_FILE          "metrics.journal"    // Closed per-minute and per-hour poll rollups
+#define HISTORY_LIMIT_MIN     10
+#define HISTORY_LIMIT_MAX     100000
+#define HISTORY_PAGE_SIZE     100     // Entries sent with the history dialog's first render
+#define HISTORY_PAGE_MAX      1000    // Largest page the dialog may request
+
+// Monitoring engine limits
+#define MAX_ENDPOINTS       256   // Primary API URL plus additional endpoints
+#define WORKER_POOL_SIZE    4     // Threads executing checks, regardless of endpoint count
+#define ACCELERATED_INTERVAL 10   // Seconds between checks while an endpoint is unhealthy
+#define DEGRADED_INTERVAL 30      // Longest interval between checks while an endpoint is degraded
+#define ENDPOINT_SPEC_LEN   800   // "<url> [interval] [format]" line, including separator
+#define CHECK_MAX_ATTEMPTS  3     // Attempts per check before reporting a network error
+#define CHECK_RETRY_DELAY_MS 2000 // Ceiling of the first retry's jittered delay, armed as a timer-queue timer
+#define CHECK_RETRY_MIN_DELAY_MS 50 // Floor of a jittered retry delay
+#define RETRY_TIMER_FIRED ((HANDLE)(LONG_PTR)-1) // retryTimer: fired before HttpCheckWaitRetry published it
+#define RETRY_AFTER_MAX_SECONDS 86400  // Longest Retry-After honoured
+
+// WinHTTP decompression (Windows 8.1 and later), missing from older MinGW headers
+#ifndef WINHTTP_OPTION_DECOMPRESSION
+#define WINHTTP_OPTION_DECOMPRESSION 118
+#define WINHTTP_DECOMPRESSION_FLAG_GZIP    0x00000001
+#define WINHTTP_DECOMPRESSION_FLAG_DEFLATE 0x00000002
+#define WINHTTP_DECOMPRESSION_FLAG_ALL (WINHTTP_DECOMPRESSION_FLAG_GZIP | WINHTTP_DECOMPRESSION_FLAG_DEFLATE)
+#endif
 
 #define WM_VALIDATE_RESULT      (WM_APP + 1)
+#define WM_POLL_RESULTS         (WM_APP + 3)   // Finished polls waiting in resultMailbox
+#define WM_CHECK_PROGRESS       (WM_APP + 4)   // Attempt started: wParam = endpoint, lParam = MAKELPARAM(attempt, max)
 #define WM_SHOW_FIRST_CONFIG    (WM_USER + 2)
 #define ID_TIMER_WEBVIEW_SHOW_FALLBACK 1006
 #define WEBVIEW_SHOW_FALLBACK_DELAY_MS 350
 
+// Log levels. A call above the active level costs one integer compare, and
+// calls above LOG_COMPILED_LEVEL are compiled out (make LOG_LEVEL=LOG_INFO).
+typedef enum {
+    LOG_OFF,
+    LOG_ERROR,
+    LOG_WARN,
+    LOG_INFO,
+    LOG_DEBUG,
+    LOG_TRACE
+} LogLevel;
+
+#ifndef LOG_COMPILED_LEVEL
+#define LOG_COMPILED_LEVEL LOG_TRACE
+#endif
+
+#define LogAt(level, ...) do { \
+        if ((level) <= LOG_COMPILED_LEVEL && (level) <= g_logLevel) LogMessage(__VA_ARGS__); \
+    } while (0)
+#define LogError(...) LogAt(LOG_ERROR, __VA_ARGS__)
+#define LogWarn(...)  LogAt(LOG_WARN, __VA_ARGS__)
+#define LogInfo(...)  LogAt(LOG_INFO, __VA_ARGS__)
+#define LogDebug(...) LogAt(LOG_DEBUG, __VA_ARGS__)
+#define LogTrace(...) LogAt(LOG_TRACE, __VA_ARGS__)
+
 typedef enum {
     RESULT_NONE,         // Initial state - no result yet
     RESULT_ERROR,        // Connection/network error
     RESULT_INVALID,      // Connected but invalid response
     RESULT_SUCCESS,
-    RESULT_FAIL
+    RESULT_FAIL,
+    RESULT_DEGRADED      // Success, but too slow in too many recent polls
 } ApiResult;
 
 typedef struct {
@@ -51,18 +136,43 @@ typedef struct {
     char message[256];
 } ApiResponse;
 
+// Where a check's last attempt spent its time (ms); phases it never reached are 0
 typedef struct {
-    int attempt;
-    int maxAttempts;
-} ThreadParams;
+    WORD dnsMs;              // Name resolution
+    WORD connectMs;          // TCP connect
+    WORD tlsMs;              // TLS handshake
+    WORD sendMs;             // Writing the request
+    WORD waitMs;             // Time to first byte
+    WORD receiveMs;          // Headers and body transfer
+} PhaseTimings;
+
+// Transition in the history ring; 40 bytes, with the messages and URL interned in historyMessages
+typedef struct {
+    LONGLONG time;           // Local time as FILETIME ticks
+    unsigned oldMessage;     // Intern IDs
+    unsigned newMessage;
+    unsigned url;            // Of the endpoint; its slot in the monitor table may since have changed
+    BYTE oldResult;          // ApiResult
+    BYTE newResult;
+    PhaseTimings timings;    // Of the poll that made the transition
+} HistoryEntry;
 
+// History entry as saved in the registry by versions before the journal
 typedef struct {
     SYSTEMTIME timestamp;
     ApiResult oldResult;
     ApiResult newResult;
     char oldMessage[256];
     char newMessage[256];
-} HistoryEntry;
+    int endpoint;            // Appended field, see LoadHistoryFromRegistry
+} LegacyHistoryEntry;
+
+// Additional endpoint as configured ("<url> [interval] [format]" per line)
+typedef struct {
+    char url[512];
+    int interval;            // Seconds; 0 = use the primary check interval
+    char format[DECODER_SPEC_SIZE]; // Response decoder spec; empty = xml
+} EndpointConfig;
 
 // Global variables
 static NOTIFYICONDATA nid = {0};
@@ -73,6 +183,7 @@ static char logFilePath[MAX_PATH];
 static HICON hIconEmpty = NULL;
 static HICON hIconSuccess = NULL;
 static HICON hIconFail = NULL;
+static HICON hIconDegraded = NULL;
 static HICON hIconBlank = NULL;
 static UINT_PTR timerRefresh = 0;
 static UINT_PTR timerTooltip = 0;
@@ -80,26 +191,214 @@ static BOOL iconVisible = TRUE;
 static HICON currentIcon = NULL;
 static char currentMessage[256] = "";
 static ApiResult currentResult = RESULT_NONE;
+static int currentEndpoint = 0;         // Endpoint whose status the tray shows
 static SYSTEMTIME lastUpdateTime = {0};
 static HWND g_hwnd = NULL;
 static HINSTANCE g_hInstance = NULL;
 static HANDLE g_hMutex = NULL;  // Mutex for single instance check
-static CRITICAL_SECTION logCriticalSection;  // For thread-safe logging
 static BOOL configLoggingEnabled = TRUE; // Global variable for logging toggle (default true)
+static LogLevel configLogLevel = LOG_INFO;
+static volatile LONG g_logLevel = LOG_INFO;  // Active threshold: configLogLevel, or LOG_OFF when logging is disabled
 static int configHistoryLimit = 100;
+static int configMaxResponseKB = 256;   // Largest response body kept per check
+static int configRetryMaxDelayMs = 16000;   // Ceiling of a retry's jittered delay within a check
+static int configBackoffMaxSeconds = 300;   // Ceiling of an unhealthy endpoint's polling delay
+static int configBreakerThreshold = 5;      // Consecutive errors that open the circuit breaker, 0 = never
+static BOOL configAcceptCompression = FALSE;    // Ask servers for gzip/deflate response bodies
+static int configDegradedLatencyMs = 5000;  // A poll slower than this counts as slow, 0 = never degraded
+static int configDegradedPolls = 3;         // Slow polls among the last DegradedWindow that make an endpoint degraded
+static int configDegradedWindow = 5;        // Recent polls considered, up to SLO_WINDOW_MAX
+static char configResponseFormat[DECODER_SPEC_SIZE] = "";   // Decoder spec for the primary URL
+static int configLogMaxSizeKB = LOGGER_DEFAULT_MAX_KB;      // Log is rotated beyond this
+static int configLogFiles = LOGGER_DEFAULT_ARCHIVES;        // Rotated logs kept
+static BOOL configLogCompress = FALSE;                      // NTFS-compress rotated logs
 static HistoryEntry* historyBuffer = NULL;
 static int historyCapacity = 0;
 static int historyCount = 0;
 static int historyHead = 0;
+static ULONGLONG historyPushed = 0;     // Entries ever placed in the ring; the newest has ID historyPushed - 1
+static InternTable historyMessages;     // Message and URL text shared by all history entries
+static char historyDir[MAX_PATH];
+static Journal historyJournal;
+static BOOL historyJournalDirty = FALSE;          // Appended to since the last flush was queued
+static volatile LONG historySyncPending = 0;     // A flush of the journal is queued or running
+static ULONGLONG historySeq = 0;        // Sequence number of the newest entry ever recorded
+static TSeriesStore pollSeries;         // Every poll's latency and verdict, with rollups
+static int configMetricsDays = TSERIES_DEFAULT_DAYS;        // Hour rollups kept
+static EndpointConfig configExtraEndpoints[MAX_ENDPOINTS - 1];
+static int configExtraEndpointCount = 0;
 
-// URL validation thread params
+static volatile LONG g_validateGeneration = 0;
+
+// An endpoint URL cracked for WinHTTP once, when configuration is applied.
+// Immutable after creation and shared by reference: the endpoint holds one,
+// and so does every poll, validation and connection built from it.
 typedef struct {
     char url[512];
-    HWND hDlg;
-    LONG generation;
-} ValidateParams;
+    const char* error;               // Why the URL was rejected; nothing below is set
+    wchar_t host[URL_HOST_MAX];
+    wchar_t target[URL_TARGET_MAX];  // Path and query, already percent-encoded
+    INTERNET_PORT port;
+    DWORD requestFlags;              // WinHttpOpenRequest flags
+    wchar_t headers[512];            // Fixed request headers, CRLF-terminated (credentials from the URL)
+    BOOL credentials;                // headers carry an Authorization header
+    volatile LONG refCount;
+} EndpointDescriptor;
+
+// Persistent WinHTTP connection to an endpoint (shared by its polls and retries)
+typedef struct {
+    HINTERNET hConnect;
+    EndpointDescriptor* desc;  // URL the connection was built for (referenced)
+    volatile LONG refCount;    // One reference held by the endpoint, one per in-flight request
+} HttpConnection;
+
+static CRITICAL_SECTION httpCriticalSection;
+static HINTERNET g_httpSession = NULL;
+static volatile LONG g_pollCount = 0;
+static volatile LONG g_pollReusedCount = 0;
+static volatile LONG g_notModifiedCount = 0;      // 304 answers whose cached verdict was reused
+static volatile LONG64 g_notModifiedBytes = 0;    // Body bytes those answers did not send
+static volatile LONG g_winhttpDecompression = -1; // WinHTTP accepted WINHTTP_OPTION_DECOMPRESSION: 1, refused: 0, untried: -1
+
+// Validators of a response, sent back as If-None-Match / If-Modified-Since
+typedef struct {
+    wchar_t etag[256];
+    wchar_t lastModified[64];
+} HttpValidators;
 
-static volatile LONG g_validateGeneration = 0;
+// Verdict of the latest full response, reused when the server answers 304
+typedef struct {
+    HttpValidators validators;   // Empty when the response had none
+    ApiResult result;
+    char message[256];
+    unsigned bytes;              // Body bytes the response took
+} CachedVerdict;
+
+// Moments of an attempt reported by WinHTTP notifications, as QueryPerformanceCounter() ticks
+typedef enum {
+    PHASE_MARK_RESOLVING,        // Name lookup started
+    PHASE_MARK_RESOLVED,
+    PHASE_MARK_CONNECTING,       // TCP connect started
+    PHASE_MARK_CONNECTED,
+    PHASE_MARK_SENDING,          // Request being written (after the TLS handshake on https)
+    PHASE_MARK_SENT,
+    PHASE_MARK_FIRST_BYTE,       // First response bytes arrived
+    PHASE_MARK_DONE,             // Attempt finished, successfully or not
+    PHASE_MARK_COUNT
+} PhaseMark;
+
+// One in-flight check (endpoint poll or URL validation) driven by WinHTTP completions
+typedef struct PendingCheck {
+    CheckRequest check;
+    int endpoint;                // Monitor table index, -1 for URL validation
+    LONG generation;             // Endpoint (or validation) generation when the check started
+    EndpointDescriptor* desc;    // URL being checked (referenced)
+    HttpConnection* conn;
+    HINTERNET hRequest;
+    HANDLE volatile retryTimer;  // Pending retry's timer-queue timer, handed off atomically
+    CheckBuffer* body;
+    DecoderConfig decoderConfig; // Snapshot of the endpoint's decoder
+    DecoderState decoder;        // Fed each chunk as it arrives, reset per attempt
+    int timeoutMs;
+    HWND hDlg;                   // Validation only: window receiving WM_VALIDATE_RESULT
+    volatile BOOL newConnection; // Set by HttpStatusCallback on a fresh TCP connect
+    BOOL connectionReused;       // Last attempt rode an existing keep-alive connection
+    LONGLONG marks[PHASE_MARK_COUNT]; // This attempt's phase marks, 0 = not reached
+    LARGE_INTEGER started;       // QueryPerformanceCounter() when the check started
+    ULONGLONG seq;               // Endpoint's poll sequence number
+    unsigned rng;                // Retry jitter
+    unsigned retryAfterMs;       // Retry-After of a 429 or 503 response, 0 if none
+    CachedVerdict cached;        // Polls only: validators sent with the request and their verdict
+    HttpValidators received;     // Validators of a 2xx response
+    BOOL winhttpInflates;        // WinHTTP decompresses this attempt's response itself
+    BOOL inflating;              // Body is compressed and inflated here as it arrives
+    Inflater inflater;
+    CheckBuffer* inflated;       // Inflated body, allocated on the first compressed response
+    const char* inflateError;    // Compressed body could not be decoded
+    BOOL inflateDone;            // Compressed stream reached its verified end
+    unsigned wireBytes;          // Body bytes received, compressed or not
+    unsigned wireLength;         // Compressed Content-Length of a body WinHTTP decompressed, 0 if unknown
+    struct PendingCheck* next;   // Link in the completion queue
+} PendingCheck;
+
+// Monitor table: one slot per endpoint, index 0 is the primary API URL.
+// Workers read url, descriptor, decoder, generation, singleAttempt and cached
+// (and write cached) under monitorCriticalSection; everything else belongs to
+// the UI thread.
+typedef struct {
+    char url[512];
+    EndpointDescriptor* descriptor; // url cracked when assigned; replaced, never modified
+    int refreshInterval;       // Configured interval (seconds)
+    int activeInterval;        // Current interval, accelerated while unhealthy
+    ULONGLONG lastDue;         // GetTickCount64() deadline of the latest scheduled check
+    volatile LONG inFlight;    // Non-zero from being queued until the poll's result is posted
+    int skippedTicks;          // Scheduled checks skipped because a poll was still running (UI thread)
+    LONG generation;           // Bumped whenever the slot is reassigned to another URL
+    ApiResult result;
+    char message[256];
+    SYSTEMTIME lastUpdateTime;
+    BOOL lastConnectionReused;   // Latest poll's connection was kept alive from an earlier one (UI thread)
+    HttpConnection* connection;
+    CheckBuffer* responseBuffer; // Parked between polls so the next check reuses its allocation
+    char format[DECODER_SPEC_SIZE];
+    DecoderConfig decoder;       // Parsed from format
+    int series;                  // Time series of the URL, -1 until the first poll is recorded
+    ULONGLONG pollsStarted;      // Sequence number of the newest check started
+    ULONGLONG appliedSeq;        // Sequence number of the newest result applied (UI thread)
+    int failures;                // Consecutive unhealthy results (UI thread)
+    Breaker breaker;             // Consecutive errors (UI thread)
+    BOOL singleAttempt;          // Breaker not closed: checks make one attempt, no retries
+    CachedVerdict cached;        // Latest full response's verdict, for conditional requests
+    ULONGLONG wireBytes;         // Body bytes received across polls, as sent (UI thread)
+    ULONGLONG bodyBytes;         // The same bodies decompressed (UI thread)
+    PhaseTimings timings;        // Latest poll's phases (UI thread)
+    LatencyWindow latency;       // Which recent answers were slow (UI thread)
+} MonitorEndpoint;
+
+// Finished poll on its way from a worker to the UI thread; not modified once posted
+typedef struct {
+    MailboxNode node;
+    int endpoint;
+    LONG generation;
+    ULONGLONG seq;
+    ApiResult result;
+    char message[256];
+    TSeriesSample sample;        // time is 0 when nothing was polled
+    unsigned retryAfterMs;
+    unsigned wireBytes;          // Body bytes received, compressed or not
+    unsigned bodyBytes;          // Body bytes after decompression
+    PhaseTimings timings;
+    BOOL connectionReused;
+} PollResult;
+
+static MonitorEndpoint g_endpoints[MAX_ENDPOINTS];
+static int g_endpointCount = 0;
+static CRITICAL_SECTION monitorCriticalSection;   // Guards the URL, decoder and generation workers read
+static Mailbox resultMailbox;                     // Finished polls, applied in order by the UI thread
+static LONG g_staleResultCount = 0;               // Results dropped because a newer one was applied
+static LONG g_skippedTickCount = 0;               // Scheduled checks skipped, all endpoints
+static LONG g_joinedRefreshCount = 0;             // Manual refreshes served by a poll already running
+
+// Deadline scheduler (UI thread): one heap entry per endpoint, one timer for the earliest
+static Scheduler g_scheduler;
+static SchedMode configScheduleMode = SCHED_FIXED_RATE;
+static ULONGLONG g_timerDue = 0;                  // Deadline the refresh timer is armed for
+static ULONGLONG g_scheduledRuns = 0;             // Deadlines reached, with or without a check
+static ULONGLONG g_scheduleLateTotalMs = 0;       // Sum of how late the timer ran past each deadline
+static ULONGLONG g_scheduleLateMaxMs = 0;
+static ULONGLONG g_scheduleMissed = 0;            // Fixed-rate periods skipped as already past
+static unsigned g_backoffRng = 0;                 // Jitter of unhealthy endpoints' polling delays
+
+// Bounded worker pool fed by a queue of endpoint indices and a queue of finished checks
+static HANDLE g_workerThreads[WORKER_POOL_SIZE];
+static int g_workQueue[MAX_ENDPOINTS];
+static int g_workQueueHead = 0;
+static int g_workQueueCount = 0;
+static PendingCheck* g_completedHead = NULL;
+static PendingCheck* g_completedTail = NULL;
+static BOOL g_workersStopping = FALSE;
+static CRITICAL_SECTION workQueueCriticalSection;
+static CONDITION_VARIABLE workQueueCondition;
 
 // Display settings tracking (for RDP reconnect icon refresh)
 static int lastScreenWidth = 0;
@@ -326,6 +625,8 @@ struct ICoreWebView2WebMessageReceivedEventHandler {
 // ============================================================================
 
 static HWND g_webviewHwnd = NULL;
+static HWND g_historyViewHwnd = NULL;              // WebView window while it shows the history
+static LONGLONG g_historySentNewest = -1;          // Newest history ID the dialog has been sent
 static ICoreWebView2Environment *g_webviewEnv = NULL;
 static ICoreWebView2Controller *g_webviewController = NULL;
 static ICoreWebView2 *g_webviewView = NULL;
@@ -351,80 +652,82 @@ void LoadConfigFromIni(const char* iniPath);
 void ApplyConfiguration();
 void ShowConfigDialog(HWND hwndParent);
 void ShowHistoryDialog(HWND hwndParent);
-void UpdateStatus(ApiResult result, const char* message);
+void PostPollResult(int index, LONG generation, ULONGLONG seq, ApiResult result, const char* message,
+                    const TSeriesSample* sample, const PhaseTimings* timings, unsigned retryAfterMs,
+                    unsigned wireBytes, unsigned bodyBytes, BOOL connectionReused);
+void DrainPollResults(void);
+void UpdateStatus(int index, ApiResult result, const char* message);
+void UpdateTrayStatus(void);
 void RefreshStatus();
-DWORD WINAPI RefreshThread(LPVOID param);
+void CheckEndpoint(int index);
+DWORD WINAPI WorkerThread(LPVOID param);
+void StartWorkerPool(void);
+void StopWorkerPool(void);
+BOOL QueueEndpointCheck(int index);
+void QueueCompletedCheck(PendingCheck* pc);
+void RebuildMonitorTable(void);
 void SetIcon(HICON icon);
 void CALLBACK TooltipTimer(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime);
 void CALLBACK RefreshTimer(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime);
-void ParseXmlResponse(const char* xml, ApiResponse* response);
+void DecodeResponse(DecoderState* decoder, unsigned long statusCode, const CheckBuffer* body, ApiResponse* response);
 void ExitApplication(HWND hwnd);
 void UpdateTooltip();
-void SetRefreshInterval(int seconds, BOOL isUserSetting);
+void ScheduleEndpoint(int index, ULONGLONG due);
+void SetRefreshInterval(int index, int seconds);
+void ScheduleNextCheck(int index, ApiResult result, unsigned retryAfterMs);
+void StopScheduler(HWND hwnd);
 void CaptureCurrentDisplaySettings();
 BOOL HasDisplaySettingsChanged();
 void RefreshTrayIconForNewResolution();
 void LogMessage(const char* format, ...);
-void CheckLogFileSize();
-DWORD WINAPI ValidateUrlThread(LPVOID param);
+static void ApplyLogLevel(void);
+static const char* LogLevelName(LogLevel level);
+void CloseHttpSession(void);
 const char* ApiResultToString(ApiResult r);
 void InitHistoryBuffer(int capacity);
-void AddHistoryEntry(ApiResult oldResult, const char* oldMsg, ApiResult newResult, const char* newMsg);
+void AddHistoryEntry(const char* url, ApiResult oldResult, const char* oldMsg, ApiResult newResult, const char* newMsg,
+                     const PhaseTimings* timings);
 HistoryEntry* GetHistoryEntry(int displayIndex);
 void FreeHistoryBuffer(void);
-void SaveHistoryToRegistry(void);
+void OpenHistoryStore(void);
+void CompactHistory(void);
+void CloseHistoryStore(void);
 void LoadHistoryFromRegistry(void);
+void OpenPollSeries(void);
+void ClosePollSeries(void);
 static void ShowWebViewDialog(const char* view, int width, int height);
 
-// Logging function: writes to ProgramData\APIMonitor.log with timestamp and thread ID
+// Logging function: queues a timestamped line for ProgramData\APIMonitor.log (see logger.c).
+// Called through the Log* macros, which have already checked the level.
 void LogMessage(const char* format, ...) {
-	// Skip logging if disabled
-    if (!configLoggingEnabled) {
-        return;
-    }
-
-	EnterCriticalSection(&logCriticalSection);
-
-    // Check log file size before writing (limit to ~10MB)
-    CheckLogFileSize();
-
-    FILE* logFile = fopen(logFilePath, "a");
-    if (!logFile) {
-        LeaveCriticalSection(&logCriticalSection);
-        return;
-    }
-
-    // Timestamp
-    SYSTEMTIME st;
-    GetLocalTime(&st);
-    fprintf(logFile, "[%04d-%02d-%02d %02d:%02d:%02d] [TID:%lu] ",
-            st.wYear, st.wMonth, st.wDay, st.wHour, st.wMinute, st.wSecond,
-            GetCurrentThreadId());
-
-    // Message
     va_list args;
     va_start(args, format);
-    vfprintf(logFile, format, args);
+    logger_write(format, args);
     va_end(args);
-
-    fprintf(logFile, "\n");
-    fclose(logFile);
-    LeaveCriticalSection(&logCriticalSection);
 }
 
-void CheckLogFileSize() {
-    FILE* f = fopen(logFilePath, "r");
-    if (!f) return;
+static const char* const g_logLevelNames[] = { "off", "error", "warn", "info", "debug", "trace" };
 
-    fseek(f, 0, SEEK_END);
-    long size = ftell(f);
-    fclose(f);
+static const char* LogLevelName(LogLevel level) {
+    return (level >= LOG_OFF && level <= LOG_TRACE) ? g_logLevelNames[level] : "info";
+}
 
-    // If larger than 10MB, truncate
-    if (size > 10 * 1024 * 1024) {
-        fclose(fopen(logFilePath, "w"));
-        LogMessage("Log file exceeded 10MB, restarted.");
+// Accepts a level name or its number; anything else keeps the default
+static LogLevel ParseLogLevel(const char* name) {
+    if (isdigit((unsigned char)name[0])) {
+        int level = atoi(name);
+        return (level >= LOG_ERROR && level <= LOG_TRACE) ? (LogLevel)level : LOG_INFO;
     }
+    for (int i = LOG_ERROR; i <= LOG_TRACE; i++) {
+        if (lstrcmpiA(name, g_logLevelNames[i]) == 0) return (LogLevel)i;
+    }
+    if (lstrcmpiA(name, "warning") == 0) return LOG_WARN;
+    return LOG_INFO;
+}
+
+// Logging switch and level combine into the one threshold the Log* macros compare
+static void ApplyLogLevel(void) {
+    InterlockedExchange(&g_logLevel, configLoggingEnabled ? (LONG)configLogLevel : (LONG)LOG_OFF);
 }
 
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
@@ -432,8 +735,11 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     UNREFERENCED_PARAMETER(lpCmdLine);
     UNREFERENCED_PARAMETER(nCmdShow);
 
-    // Initialize logging system
-    InitializeCriticalSection(&logCriticalSection);
+    InitializeCriticalSection(&httpCriticalSection);
+    InitializeCriticalSection(&monitorCriticalSection);
+    mailbox_init(&resultMailbox);
+    InitializeCriticalSection(&workQueueCriticalSection);
+    InitializeConditionVariable(&workQueueCondition);
 
     // Get ProgramData folder for logging
     char programDataPath[MAX_PATH];
@@ -452,21 +758,23 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         strcat(logFilePath, "\\APIMonitor.log");
     }
 
-    LogMessage("=== Application starting (Version: APIMonitor/1.0) ===");
+    // Initialize logging system
+    logger_start(logFilePath);
+    LogInfo("=== Application starting (Version: APIMonitor/1.0) ===");
 
     // Single instance check
     g_hMutex = CreateMutexA(NULL, TRUE, "Global\\APIMonitor_SingleInstance_Mutex");
     if (GetLastError() == ERROR_ALREADY_EXISTS) {
-        LogMessage("ERROR: Another instance is already running. Exiting.");
+        LogError("ERROR: Another instance is already running. Exiting.");
         MessageBoxA(NULL,
                    "Only one copy of the API monitor can be running at any given time.",
                    "API Monitor Already Running",
                    MB_OK | MB_ICONINFORMATION);
         if (g_hMutex) CloseHandle(g_hMutex);
-        DeleteCriticalSection(&logCriticalSection);
+        logger_stop();
         return 0;
     }
-    LogMessage("Single instance check passed.");
+    LogDebug("Single instance check passed.");
 
     g_hInstance = hInstance;
 
@@ -485,15 +793,26 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         strcat(iniPath, "\\config.ini");
         LoadConfigFromIni(iniPath);
         SaveConfigToRegistry();
-        LogMessage("Migrated configuration from INI to registry.");
+        LogInfo("Migrated configuration from INI to registry.");
     }
 
-    LogMessage("Configuration loaded: URL=%s, Interval=%d, Logging=%s, HistoryLimit=%d",
-               configApiUrl, configRefreshInterval, configLoggingEnabled ? "enabled" : "disabled", configHistoryLimit);
+    ApplyLogLevel();
+    LogInfo("Configuration loaded: URL=%s, Interval=%d, Logging=%s, HistoryLimit=%d, AdditionalEndpoints=%d",
+            configApiUrl, configRefreshInterval, configLoggingEnabled ? LogLevelName(configLogLevel) : "disabled",
+            configHistoryLimit, configExtraEndpointCount);
+    logger_configure(configLogMaxSizeKB, configLogFiles, configLogCompress);
+    g_backoffRng = GetTickCount() | 1;
+    if (!sched_init(&g_scheduler, MAX_ENDPOINTS)) {
+        LogError("ERROR: Out of memory creating the refresh scheduler.");
+        logger_stop();
+        return 1;
+    }
+    RebuildMonitorTable();
 
     // Initialize history buffer
     InitHistoryBuffer(configHistoryLimit);
-    LoadHistoryFromRegistry();
+    OpenHistoryStore();
+    OpenPollSeries();
 
     // Load icons
     hIconEmpty = (HICON)LoadImage(hInstance, MAKEINTRESOURCE(IDI_EMPTY),
@@ -502,18 +821,20 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
                                      IMAGE_ICON, 16, 16, LR_DEFAULTCOLOR);
     hIconFail = (HICON)LoadImage(hInstance, MAKEINTRESOURCE(IDI_FAIL),
                                   IMAGE_ICON, 16, 16, LR_DEFAULTCOLOR);
+    hIconDegraded = (HICON)LoadImage(hInstance, MAKEINTRESOURCE(IDI_DEGRADED),
+                                      IMAGE_ICON, 16, 16, LR_DEFAULTCOLOR);
     hIconBlank = (HICON)LoadImage(hInstance, MAKEINTRESOURCE(IDI_BLANK),
                                    IMAGE_ICON, 16, 16, LR_DEFAULTCOLOR);
 
-    if (!hIconEmpty || !hIconSuccess || !hIconFail || !hIconBlank) {
+    if (!hIconEmpty || !hIconSuccess || !hIconFail || !hIconDegraded || !hIconBlank) {
         char errMsg[256];
         sprintf(errMsg, "Failed to load embedded icons. Error: %lu", GetLastError());
-        LogMessage("ERROR: %s", errMsg);
+        LogError("ERROR: %s", errMsg);
         MessageBoxA(NULL, errMsg, "Icon Loading Error", MB_OK | MB_ICONERROR);
-        DeleteCriticalSection(&logCriticalSection);
+        logger_stop();
         return 1;
     }
-    LogMessage("Icons loaded successfully.");
+    LogDebug("Icons loaded successfully.");
 
     // Capture initial display settings
     CaptureCurrentDisplaySettings();
@@ -526,9 +847,9 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     wc.lpszClassName = "APIMonitorClass";
 
     if (!RegisterClassExA(&wc)) {
-        LogMessage("ERROR: Failed to register window class. Error: %lu", GetLastError());
+        LogError("ERROR: Failed to register window class. Error: %lu", GetLastError());
         MessageBoxA(NULL, "Failed to register window class", "Error", MB_OK | MB_ICONERROR);
-        DeleteCriticalSection(&logCriticalSection);
+        logger_stop();
         return 1;
     }
 
@@ -536,18 +857,18 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     HWND hwnd = CreateWindowExA(0, "APIMonitorClass", "APIMonitor", 0,
                               0, 0, 0, 0, HWND_MESSAGE, NULL, hInstance, NULL);
     if (!hwnd) {
-        LogMessage("ERROR: Failed to create window. Error: %lu", GetLastError());
+        LogError("ERROR: Failed to create window. Error: %lu", GetLastError());
         MessageBoxA(NULL, "Failed to create window", "Error", MB_OK | MB_ICONERROR);
-        DeleteCriticalSection(&logCriticalSection);
+        logger_stop();
         return 1;
     }
 
     g_hwnd = hwnd;
-    LogMessage("Message window created.");
+    LogDebug("Message window created.");
 
     // Initialize tray icon
     InitTrayIcon(hwnd);
-    LogMessage("Tray icon initialized.");
+    LogDebug("Tray icon initialized.");
 
     // Create context menu
     CreateContextMenu();
@@ -555,17 +876,18 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     // Set up timers
     timerTooltip = SetTimer(hwnd, 2, 1000, TooltipTimer);
 
-    // Initial check
-    LogMessage("Performing initial API check.");
-    RefreshStatus();
-
-    // Start refresh timer
-    timerRefresh = SetTimer(hwnd, 1, configRefreshInterval * 1000, RefreshTimer);
-    LogMessage("Refresh timer started with %d second interval.", configRefreshInterval);
+    // Initial check: every endpoint is due now, and from then on the refresh
+    // timer is armed for whichever deadline comes first
+    StartWorkerPool();
+    LogDebug("Performing initial API check.");
+    RefreshTimer(hwnd, WM_TIMER, 1, 0);
+    LogInfo("Refresh scheduler started (%s, primary interval %d seconds, %d endpoint(s)).",
+            configScheduleMode == SCHED_FIXED_DELAY ? "fixed delay" : "fixed rate",
+            configRefreshInterval, g_endpointCount);
 
     // On first launch, post message to show config dialog after message loop starts
     if (firstLaunch) {
-        LogMessage("First launch detected, will show configuration dialog.");
+        LogInfo("First launch detected, will show configuration dialog.");
         MarkAsConfigured();
         PostMessage(hwnd, WM_SHOW_FIRST_CONFIG, 0, 0);
     }
@@ -578,7 +900,7 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     }
 
     ExitApplication(hwnd);
-    DeleteCriticalSection(&logCriticalSection);
+    logger_stop();
     return 0;
 }
 
@@ -596,9 +918,9 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
                 EnableMenuItem(hMenu, ID_TRAY_CONFIGURE, g_webviewHwnd ? MF_GRAYED : MF_ENABLED);
                 EnableMenuItem(hMenu, ID_TRAY_HISTORY, g_webviewHwnd ? MF_GRAYED : MF_ENABLED);
                 TrackPopupMenu(hMenu, TPM_RIGHTBUTTON, pt.x, pt.y, 0, hwnd, NULL);
-                LogMessage("Context menu opened at position (%ld, %ld).", pt.x, pt.y);
+                LogDebug("Context menu opened at position (%ld, %ld).", pt.x, pt.y);
             } else if (lParam == WM_LBUTTONDBLCLK) {
-                LogMessage("Tray icon double-clicked. Triggering manual refresh.");
+                LogInfo("Tray icon double-clicked. Triggering manual refresh.");
                 RefreshStatus();
             }
             break;
@@ -606,7 +928,7 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
         case WM_DISPLAYCHANGE:
             Sleep(1000);
             if (HasDisplaySettingsChanged()) {
-                LogMessage("Display settings changed. Screen: %dx%d, DPI: %dx%d -> %dx%d, DPI: %dx%d",
+                LogInfo("Display settings changed. Screen: %dx%d, DPI: %dx%d -> %dx%d, DPI: %dx%d",
                           lastScreenWidth, lastScreenHeight, lastDpiX, lastDpiY,
                           GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN),
                           GetDeviceCaps(GetDC(NULL), LOGPIXELSX), GetDeviceCaps(GetDC(NULL), LOGPIXELSY));
@@ -618,31 +940,45 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
         case WM_COMMAND:
             switch (LOWORD(wParam)) {
                 case ID_TRAY_EXIT:
-                    LogMessage("User selected Exit from context menu.");
+                    LogInfo("User selected Exit from context menu.");
                     ExitApplication(hwnd);
                     break;
                 case ID_TRAY_REFRESH:
-                    LogMessage("User selected Refresh from context menu.");
+                    LogInfo("User selected Refresh from context menu.");
                     RefreshStatus();
                     break;
                 case ID_TRAY_CONFIGURE:
-                    LogMessage("User selected Configure from context menu.");
+                    LogInfo("User selected Configure from context menu.");
                     ShowConfigDialog(g_hwnd);
                     break;
                 case ID_TRAY_HISTORY:
-                    LogMessage("User selected History from context menu.");
+                    LogInfo("User selected History from context menu.");
                     ShowHistoryDialog(g_hwnd);
                     break;
             }
             break;
 
+        case WM_POLL_RESULTS:
+            DrainPollResults();
+            break;
+
+        case WM_CHECK_PROGRESS:
+            // Attempt counter in the tooltip, only meaningful with a single endpoint
+            if (g_endpointCount == 1 && (int)wParam == 0) {
+                snprintf(nid.szTip, sizeof(nid.szTip), "Updating API contents [%d/%d]...",
+                         LOWORD(lParam), HIWORD(lParam));
+                nid.uFlags = NIF_TIP;
+                Shell_NotifyIconA(NIM_MODIFY, &nid);
+            }
+            break;
+
         case WM_TIMER:
             if (wParam == 1) RefreshTimer(hwnd, uMsg, wParam, 0);
             else if (wParam == 2) TooltipTimer(hwnd, uMsg, wParam, 0);
             break;
 
         case WM_DESTROY:
-            LogMessage("Window destroyed.");
+            LogDebug("Window destroyed.");
             PostQuitMessage(0);
             break;
 
@@ -661,7 +997,7 @@ void InitTrayIcon(HWND hwnd) {
     nid.hIcon = hIconEmpty;
     strcpy(nid.szTip, "API Monitor - Initializing...");
     Shell_NotifyIconA(NIM_ADD, &nid);
-    LogMessage("Tray icon added to system tray.");
+    LogDebug("Tray icon added to system tray.");
 }
 
 void CreateContextMenu() {
@@ -672,11 +1008,94 @@ void CreateContextMenu() {
     AppendMenuA(hMenu, MF_STRING, ID_TRAY_CONFIGURE, "Configure");
     AppendMenuA(hMenu, MF_SEPARATOR, 0, NULL);
     AppendMenuA(hMenu, MF_STRING, ID_TRAY_EXIT, "Exit");
-    LogMessage("Context menu created.");
+    LogDebug("Context menu created.");
+}
+
+// --- Additional endpoint specs ---
+
+// Parses "<url> [interval] [format]" and appends it to configExtraEndpoints; blank lines are ignored.
+// The format is the rest of the line, so a spec such as "text:all good" may contain spaces.
+static BOOL AddExtraEndpointSpec(const char* spec) {
+    while (*spec && isspace((unsigned char)*spec)) spec++;
+    if (!*spec || configExtraEndpointCount >= MAX_ENDPOINTS - 1) return FALSE;
+
+    EndpointConfig* ec = &configExtraEndpoints[configExtraEndpointCount];
+    size_t len = 0;
+    while (spec[len] && !isspace((unsigned char)spec[len]) && len < sizeof(ec->url) - 1) {
+        ec->url[len] = spec[len];
+        len++;
+    }
+    ec->url[len] = '\0';
+    ec->interval = 0;
+    ec->format[0] = '\0';
+
+    // Optional interval: a number right after the URL
+    const char* p = spec + len;
+    while (*p && isspace((unsigned char)*p)) p++;
+    if (isdigit((unsigned char)*p)) {
+        ec->interval = atoi(p);
+        while (*p && !isspace((unsigned char)*p)) p++;
+        while (*p && isspace((unsigned char)*p)) p++;
+    }
+
+    // Decoder spec: everything that is left, without trailing whitespace
+    size_t formatLen = strlen(p);
+    while (formatLen > 0 && isspace((unsigned char)p[formatLen - 1])) formatLen--;
+    if (formatLen > 0) {
+        char token[DECODER_SPEC_SIZE];
+        DecoderConfig dc;
+        if (formatLen < sizeof(token)) {
+            memcpy(token, p, formatLen);
+            token[formatLen] = '\0';
+        }
+        if (formatLen < sizeof(token) && decoder_parse(token, &dc)) {
+            memcpy(ec->format, token, formatLen + 1);
+        } else {
+            LogWarn("WARNING: Unknown response format '%.*s' for %s, using xml.", (int)formatLen, p, ec->url);
+        }
+    }
+
+    if (ec->interval != 0 && ec->interval < ACCELERATED_INTERVAL) ec->interval = ACCELERATED_INTERVAL;
+    if (ec->interval > 86400) ec->interval = 86400;
+
+    configExtraEndpointCount++;
+    return TRUE;
+}
+
+// Replaces the additional endpoints with newline-separated specs
+static void SetExtraEndpointsFromText(const char* text) {
+    configExtraEndpointCount = 0;
+    char line[ENDPOINT_SPEC_LEN];
+    while (*text) {
+        size_t len = strcspn(text, "\r\n");
+        if (len >= sizeof(line)) len = sizeof(line) - 1;
+        memcpy(line, text, len);
+        line[len] = '\0';
+        AddExtraEndpointSpec(line);
+        text += strcspn(text, "\r\n");
+        while (*text == '\r' || *text == '\n') text++;
+    }
+}
+
+static size_t FormatEndpointSpec(const EndpointConfig* ec, char* out, size_t outLen) {
+    char interval[16] = "";
+    if (ec->interval > 0) snprintf(interval, sizeof(interval), " %d", ec->interval);
+    int n = snprintf(out, outLen, "%s%s%s%s", ec->url, interval, ec->format[0] ? " " : "", ec->format);
+    if (n < 0) n = 0;
+    if ((size_t)n >= outLen) n = (int)outLen - 1;
+    return (size_t)n;
 }
 
 // --- Registry-based configuration ---
 
+// Keeps a configured check interval within what the scheduler can honour;
+// the same floor as an additional endpoint's interval
+static int ClampRefreshInterval(int seconds) {
+    if (seconds < ACCELERATED_INTERVAL) return ACCELERATED_INTERVAL;
+    if (seconds > 86400) return 86400;
+    return seconds;
+}
+
 BOOL LoadConfigFromRegistry() {
     HKEY hKey;
     LONG result = RegOpenKeyExA(HKEY_CURRENT_USER, REG_KEY_PATH, 0, KEY_READ, &hKey);
@@ -698,7 +1117,7 @@ BOOL LoadConfigFromRegistry() {
     size = sizeof(dwInterval);
     if (RegQueryValueExA(hKey, REG_VALUE_INTERVAL, NULL, &type, (LPBYTE)&dwInterval, &size) == ERROR_SUCCESS
         && type == REG_DWORD) {
-        configRefreshInterval = (int)dwInterval;
+        configRefreshInterval = ClampRefreshInterval((int)(dwInterval > 86400 ? 86400 : dwInterval));
     }
 
     // Read LoggingEnabled (REG_DWORD)
@@ -715,8 +1134,147 @@ BOOL LoadConfigFromRegistry() {
     if (RegQueryValueExA(hKey, REG_VALUE_HISTORY_LIMIT, NULL, &type, (LPBYTE)&dwHistoryLimit, &size) == ERROR_SUCCESS
         && type == REG_DWORD) {
         configHistoryLimit = (int)dwHistoryLimit;
-        if (configHistoryLimit < 10) configHistoryLimit = 10;
-        if (configHistoryLimit > 10000) configHistoryLimit = 10000;
+        if (configHistoryLimit < HISTORY_LIMIT_MIN) configHistoryLimit = HISTORY_LIMIT_MIN;
+        if (configHistoryLimit > HISTORY_LIMIT_MAX) configHistoryLimit = HISTORY_LIMIT_MAX;
+    }
+
+    // Read MaxResponseKB (REG_DWORD)
+    DWORD dwMaxResponse = 256;
+    size = sizeof(dwMaxResponse);
+    if (RegQueryValueExA(hKey, REG_VALUE_MAX_RESPONSE, NULL, &type, (LPBYTE)&dwMaxResponse, &size) == ERROR_SUCCESS
+        && type == REG_DWORD) {
+        configMaxResponseKB = (int)dwMaxResponse;
+        if (configMaxResponseKB < 4) configMaxResponseKB = 4;
+        if (configMaxResponseKB > 65536) configMaxResponseKB = 65536;
+    }
+
+    // Read RetryMaxDelayMs, BackoffMaxSeconds and BreakerThreshold (REG_DWORD)
+    DWORD dwBackoff = 0;
+    size = sizeof(dwBackoff);
+    if (RegQueryValueExA(hKey, REG_VALUE_RETRY_MAX_DELAY, NULL, &type, (LPBYTE)&dwBackoff, &size) == ERROR_SUCCESS
+        && type == REG_DWORD) {
+        configRetryMaxDelayMs = (int)dwBackoff;
+        if (configRetryMaxDelayMs < CHECK_RETRY_DELAY_MS) configRetryMaxDelayMs = CHECK_RETRY_DELAY_MS;
+        if (configRetryMaxDelayMs > 300000) configRetryMaxDelayMs = 300000;
+    }
+    size = sizeof(dwBackoff);
+    if (RegQueryValueExA(hKey, REG_VALUE_BACKOFF_MAX, NULL, &type, (LPBYTE)&dwBackoff, &size) == ERROR_SUCCESS
+        && type == REG_DWORD) {
+        configBackoffMaxSeconds = (int)dwBackoff;
+        if (configBackoffMaxSeconds < ACCELERATED_INTERVAL) configBackoffMaxSeconds = ACCELERATED_INTERVAL;
+        if (configBackoffMaxSeconds > 86400) configBackoffMaxSeconds = 86400;
+    }
+    size = sizeof(dwBackoff);
+    if (RegQueryValueExA(hKey, REG_VALUE_BREAKER_THRESHOLD, NULL, &type, (LPBYTE)&dwBackoff, &size) == ERROR_SUCCESS
+        && type == REG_DWORD) {
+        configBreakerThreshold = (int)dwBackoff;
+        if (configBreakerThreshold > 1000) configBreakerThreshold = 1000;
+    }
+
+    // Read DegradedLatencyMs, DegradedPolls and DegradedWindow (REG_DWORD)
+    DWORD dwDegraded = 0;
+    size = sizeof(dwDegraded);
+    if (RegQueryValueExA(hKey, REG_VALUE_DEGRADED_LATENCY, NULL, &type, (LPBYTE)&dwDegraded, &size) == ERROR_SUCCESS
+        && type == REG_DWORD) {
+        configDegradedLatencyMs = (int)dwDegraded;
+        if (configDegradedLatencyMs > 600000) configDegradedLatencyMs = 600000;
+    }
+    size = sizeof(dwDegraded);
+    if (RegQueryValueExA(hKey, REG_VALUE_DEGRADED_WINDOW, NULL, &type, (LPBYTE)&dwDegraded, &size) == ERROR_SUCCESS
+        && type == REG_DWORD) {
+        configDegradedWindow = (int)dwDegraded;
+        if (configDegradedWindow < 1) configDegradedWindow = 1;
+        if (configDegradedWindow > SLO_WINDOW_MAX) configDegradedWindow = SLO_WINDOW_MAX;
+    }
+    size = sizeof(dwDegraded);
+    if (RegQueryValueExA(hKey, REG_VALUE_DEGRADED_POLLS, NULL, &type, (LPBYTE)&dwDegraded, &size) == ERROR_SUCCESS
+        && type == REG_DWORD) {
+        configDegradedPolls = (int)dwDegraded;
+        if (configDegradedPolls < 1) configDegradedPolls = 1;
+    }
+    if (configDegradedPolls > configDegradedWindow) configDegradedPolls = configDegradedWindow;
+
+    // Read LogMaxSizeKB, LogFiles and LogCompress (REG_DWORD)
+    DWORD dwLogValue = 0;
+    size = sizeof(dwLogValue);
+    if (RegQueryValueExA(hKey, REG_VALUE_LOG_MAX_SIZE, NULL, &type, (LPBYTE)&dwLogValue, &size) == ERROR_SUCCESS
+        && type == REG_DWORD) {
+        configLogMaxSizeKB = (int)dwLogValue;
+        if (configLogMaxSizeKB < 64) configLogMaxSizeKB = 64;
+        if (configLogMaxSizeKB > 1024 * 1024) configLogMaxSizeKB = 1024 * 1024;
+    }
+    size = sizeof(dwLogValue);
+    if (RegQueryValueExA(hKey, REG_VALUE_LOG_FILES, NULL, &type, (LPBYTE)&dwLogValue, &size) == ERROR_SUCCESS
+        && type == REG_DWORD) {
+        configLogFiles = (int)dwLogValue;
+        if (configLogFiles < 1) configLogFiles = 1;
+        if (configLogFiles > LOGGER_MAX_ARCHIVES) configLogFiles = LOGGER_MAX_ARCHIVES;
+    }
+    size = sizeof(dwLogValue);
+    if (RegQueryValueExA(hKey, REG_VALUE_LOG_COMPRESS, NULL, &type, (LPBYTE)&dwLogValue, &size) == ERROR_SUCCESS
+        && type == REG_DWORD) {
+        configLogCompress = (dwLogValue != 0);
+    }
+
+    // Read AcceptCompression (REG_DWORD)
+    DWORD dwCompression = 0;
+    size = sizeof(dwCompression);
+    if (RegQueryValueExA(hKey, REG_VALUE_ACCEPT_COMPRESSION, NULL, &type, (LPBYTE)&dwCompression, &size) == ERROR_SUCCESS
+        && type == REG_DWORD) {
+        configAcceptCompression = (dwCompression != 0);
+    }
+
+    // Read MetricsDays (REG_DWORD)
+    DWORD dwMetricsDays = 0;
+    size = sizeof(dwMetricsDays);
+    if (RegQueryValueExA(hKey, REG_VALUE_METRICS_DAYS, NULL, &type, (LPBYTE)&dwMetricsDays, &size) == ERROR_SUCCESS
+        && type == REG_DWORD) {
+        configMetricsDays = (int)dwMetricsDays;
+        if (configMetricsDays < 1) configMetricsDays = 1;
+        if (configMetricsDays > TSERIES_MAX_DAYS) configMetricsDays = TSERIES_MAX_DAYS;
+    }
+
+    // Read ScheduleMode (REG_SZ: fixed-rate or fixed-delay)
+    char scheduleMode[16] = "";
+    size = sizeof(scheduleMode) - 1;
+    if (RegQueryValueExA(hKey, REG_VALUE_SCHEDULE_MODE, NULL, &type, (LPBYTE)scheduleMode, &size) == ERROR_SUCCESS
+        && type == REG_SZ) {
+        configScheduleMode = lstrcmpiA(scheduleMode, "fixed-delay") == 0 ? SCHED_FIXED_DELAY : SCHED_FIXED_RATE;
+    }
+
+    // Read LogLevel (REG_SZ: error, warn, info, debug or trace)
+    char logLevel[16] = "";
+    size = sizeof(logLevel) - 1;
+    if (RegQueryValueExA(hKey, REG_VALUE_LOG_LEVEL, NULL, &type, (LPBYTE)logLevel, &size) == ERROR_SUCCESS
+        && type == REG_SZ) {
+        configLogLevel = ParseLogLevel(logLevel);
+    }
+
+    // Read ResponseFormat (REG_SZ)
+    char format[DECODER_SPEC_SIZE] = "";
+    size = sizeof(format) - 1;
+    if (RegQueryValueExA(hKey, REG_VALUE_RESPONSE_FORMAT, NULL, &type, (LPBYTE)format, &size) == ERROR_SUCCESS
+        && type == REG_SZ) {
+        DecoderConfig dc;
+        if (decoder_parse(format, &dc)) {
+            strcpy(configResponseFormat, format);
+        }
+    }
+
+    // Read AdditionalEndpoints (REG_MULTI_SZ, one "<url> [interval] [format]" per string)
+    configExtraEndpointCount = 0;
+    size = 0;
+    if (RegQueryValueExA(hKey, REG_VALUE_EXTRA_ENDPOINTS, NULL, &type, NULL, &size) == ERROR_SUCCESS
+        && type == REG_MULTI_SZ && size > 0) {
+        char* multiSz = (char*)calloc(size + 2, 1);
+        if (multiSz) {
+            if (RegQueryValueExA(hKey, REG_VALUE_EXTRA_ENDPOINTS, NULL, &type, (LPBYTE)multiSz, &size) == ERROR_SUCCESS) {
+                for (const char* p = multiSz; *p; p += strlen(p) + 1) {
+                    AddExtraEndpointSpec(p);
+                }
+            }
+            free(multiSz);
+        }
     }
 
     RegCloseKey(hKey);
@@ -729,7 +1287,7 @@ void SaveConfigToRegistry() {
     LONG result = RegCreateKeyExA(HKEY_CURRENT_USER, REG_KEY_PATH, 0, NULL,
                                   REG_OPTION_NON_VOLATILE, KEY_WRITE, NULL, &hKey, &disposition);
     if (result != ERROR_SUCCESS) {
-        LogMessage("ERROR: Failed to create/open registry key. Error: %lu", result);
+        LogError("ERROR: Failed to create/open registry key. Error: %lu", result);
         return;
     }
 
@@ -752,9 +1310,77 @@ void SaveConfigToRegistry() {
     RegSetValueExA(hKey, REG_VALUE_HISTORY_LIMIT, 0, REG_DWORD,
                    (const BYTE*)&dwHistoryLimit, sizeof(dwHistoryLimit));
 
+    // Write MaxResponseKB (REG_DWORD)
+    DWORD dwMaxResponse = (DWORD)configMaxResponseKB;
+    RegSetValueExA(hKey, REG_VALUE_MAX_RESPONSE, 0, REG_DWORD,
+                   (const BYTE*)&dwMaxResponse, sizeof(dwMaxResponse));
+
+    // Write RetryMaxDelayMs, BackoffMaxSeconds and BreakerThreshold (REG_DWORD)
+    DWORD dwBackoff = (DWORD)configRetryMaxDelayMs;
+    RegSetValueExA(hKey, REG_VALUE_RETRY_MAX_DELAY, 0, REG_DWORD, (const BYTE*)&dwBackoff, sizeof(dwBackoff));
+    dwBackoff = (DWORD)configBackoffMaxSeconds;
+    RegSetValueExA(hKey, REG_VALUE_BACKOFF_MAX, 0, REG_DWORD, (const BYTE*)&dwBackoff, sizeof(dwBackoff));
+    dwBackoff = (DWORD)configBreakerThreshold;
+    RegSetValueExA(hKey, REG_VALUE_BREAKER_THRESHOLD, 0, REG_DWORD, (const BYTE*)&dwBackoff, sizeof(dwBackoff));
+
+    // Write DegradedLatencyMs, DegradedPolls and DegradedWindow (REG_DWORD)
+    DWORD dwDegraded = (DWORD)configDegradedLatencyMs;
+    RegSetValueExA(hKey, REG_VALUE_DEGRADED_LATENCY, 0, REG_DWORD, (const BYTE*)&dwDegraded, sizeof(dwDegraded));
+    dwDegraded = (DWORD)configDegradedPolls;
+    RegSetValueExA(hKey, REG_VALUE_DEGRADED_POLLS, 0, REG_DWORD, (const BYTE*)&dwDegraded, sizeof(dwDegraded));
+    dwDegraded = (DWORD)configDegradedWindow;
+    RegSetValueExA(hKey, REG_VALUE_DEGRADED_WINDOW, 0, REG_DWORD, (const BYTE*)&dwDegraded, sizeof(dwDegraded));
+
+    // Write LogMaxSizeKB, LogFiles and LogCompress (REG_DWORD)
+    DWORD dwLogValue = (DWORD)configLogMaxSizeKB;
+    RegSetValueExA(hKey, REG_VALUE_LOG_MAX_SIZE, 0, REG_DWORD, (const BYTE*)&dwLogValue, sizeof(dwLogValue));
+    dwLogValue = (DWORD)configLogFiles;
+    RegSetValueExA(hKey, REG_VALUE_LOG_FILES, 0, REG_DWORD, (const BYTE*)&dwLogValue, sizeof(dwLogValue));
+    dwLogValue = (DWORD)configLogCompress;
+    RegSetValueExA(hKey, REG_VALUE_LOG_COMPRESS, 0, REG_DWORD, (const BYTE*)&dwLogValue, sizeof(dwLogValue));
+
+    // Write AcceptCompression (REG_DWORD)
+    DWORD dwCompression = (DWORD)configAcceptCompression;
+    RegSetValueExA(hKey, REG_VALUE_ACCEPT_COMPRESSION, 0, REG_DWORD, (const BYTE*)&dwCompression, sizeof(dwCompression));
+
+    // Write MetricsDays (REG_DWORD)
+    DWORD dwMetricsDays = (DWORD)configMetricsDays;
+    RegSetValueExA(hKey, REG_VALUE_METRICS_DAYS, 0, REG_DWORD, (const BYTE*)&dwMetricsDays, sizeof(dwMetricsDays));
+
+    // Write ScheduleMode (REG_SZ)
+    const char* scheduleMode = configScheduleMode == SCHED_FIXED_DELAY ? "fixed-delay" : "fixed-rate";
+    RegSetValueExA(hKey, REG_VALUE_SCHEDULE_MODE, 0, REG_SZ, (const BYTE*)scheduleMode, (DWORD)(strlen(scheduleMode) + 1));
+
+    // Write LogLevel (REG_SZ)
+    const char* logLevel = LogLevelName(configLogLevel);
+    RegSetValueExA(hKey, REG_VALUE_LOG_LEVEL, 0, REG_SZ, (const BYTE*)logLevel, (DWORD)(strlen(logLevel) + 1));
+
+    // Write ResponseFormat (REG_SZ)
+    RegSetValueExA(hKey, REG_VALUE_RESPONSE_FORMAT, 0, REG_SZ,
+                   (const BYTE*)configResponseFormat, (DWORD)(strlen(configResponseFormat) + 1));
+
+    // Write AdditionalEndpoints (REG_MULTI_SZ)
+    if (configExtraEndpointCount > 0) {
+        size_t multiLen = (size_t)configExtraEndpointCount * ENDPOINT_SPEC_LEN + 1;
+        char* multiSz = (char*)calloc(multiLen, 1);
+        if (multiSz) {
+            size_t pos = 0;
+            for (int i = 0; i < configExtraEndpointCount; i++) {
+                pos += FormatEndpointSpec(&configExtraEndpoints[i], multiSz + pos, multiLen - pos - 1) + 1;
+            }
+            multiSz[pos] = '\0';
+            RegSetValueExA(hKey, REG_VALUE_EXTRA_ENDPOINTS, 0, REG_MULTI_SZ,
+                           (const BYTE*)multiSz, (DWORD)(pos + 1));
+            free(multiSz);
+        }
+    } else {
+        RegDeleteValueA(hKey, REG_VALUE_EXTRA_ENDPOINTS);
+    }
+
     RegCloseKey(hKey);
-    LogMessage("Configuration saved to registry: URL=%s, Interval=%d, Logging=%s, HistoryLimit=%d",
-               configApiUrl, configRefreshInterval, configLoggingEnabled ? "enabled" : "disabled", configHistoryLimit);
+    LogInfo("Configuration saved to registry: URL=%s, Interval=%d, Logging=%s, HistoryLimit=%d, AdditionalEndpoints=%d",
+            configApiUrl, configRefreshInterval, configLoggingEnabled ? "enabled" : "disabled", configHistoryLimit,
+            configExtraEndpointCount);
 }
 
 BOOL IsFirstLaunch() {
@@ -782,7 +1408,7 @@ void MarkAsConfigured() {
     LONG result = RegCreateKeyExA(HKEY_CURRENT_USER, REG_KEY_PATH, 0, NULL,
                                   REG_OPTION_NON_VOLATILE, KEY_WRITE, NULL, &hKey, &disposition);
     if (result != ERROR_SUCCESS) {
-        LogMessage("ERROR: Failed to create/open registry key for MarkAsConfigured. Error: %lu", result);
+        LogError("ERROR: Failed to create/open registry key for MarkAsConfigured. Error: %lu", result);
         return;
     }
 
@@ -796,26 +1422,76 @@ void MarkAsConfigured() {
 void LoadConfigFromIni(const char* iniPath) {
     GetPrivateProfileStringA("General", "ApiUrl", "http://example.com/api/status",
                             configApiUrl, sizeof(configApiUrl), iniPath);
-    configRefreshInterval = GetPrivateProfileIntA("General", "RefreshInterval", 60, iniPath);
+    configRefreshInterval = ClampRefreshInterval((int)GetPrivateProfileIntA("General", "RefreshInterval", 60, iniPath));
     configLoggingEnabled = (BOOL)GetPrivateProfileIntA("General", "LoggingEnabled", 1, iniPath);
 }
 
 // --- History ring buffer ---
+// The ring, its interned messages and the journal belong to the UI thread,
+// which records transitions as it applies poll results. Workers never touch
+// them, so readers always see a whole ring.
 
 const char* ApiResultToString(ApiResult r) {
     switch (r) {
-        case RESULT_NONE:    return "-";
-        case RESULT_SUCCESS: return "Success";
-        case RESULT_FAIL:    return "Fail";
-        case RESULT_ERROR:   return "Error";
-        case RESULT_INVALID: return "Invalid";
-        default:             return "Unknown";
+        case RESULT_NONE:     return "-";
+        case RESULT_SUCCESS:  return "Success";
+        case RESULT_FAIL:     return "Fail";
+        case RESULT_ERROR:    return "Error";
+        case RESULT_INVALID:  return "Invalid";
+        case RESULT_DEGRADED: return "Degraded";
+        default:              return "Unknown";
     }
 }
 
+static LONGLONG SystemTimeToTicks(const SYSTEMTIME* st) {
+    FILETIME ft;
+    ULARGE_INTEGER ticks;
+    if (!SystemTimeToFileTime(st, &ft)) return 0;
+    ticks.LowPart = ft.dwLowDateTime;
+    ticks.HighPart = ft.dwHighDateTime;
+    return (LONGLONG)ticks.QuadPart;
+}
+
+static void TicksToSystemTime(LONGLONG time, SYSTEMTIME* st) {
+    FILETIME ft;
+    ULARGE_INTEGER ticks;
+    ticks.QuadPart = (ULONGLONG)time;
+    ft.dwLowDateTime = ticks.LowPart;
+    ft.dwHighDateTime = ticks.HighPart;
+    if (!FileTimeToSystemTime(&ft, st)) memset(st, 0, sizeof(*st));
+}
+
+// Messages are capped at the 255 characters the endpoint status holds
+static unsigned InternHistoryMessage(const char* text, size_t len) {
+    if (len > 255) len = 255;
+    return intern_add(&historyMessages, text, len);
+}
+
+static unsigned InternHistoryUrl(const char* url, size_t len) {
+    if (len > 511) len = 511;
+    return intern_add(&historyMessages, url, len);
+}
+
+// URL of a monitor table slot, for history saved with only the slot index
+static const char* HistorySlotUrl(LONG endpoint) {
+    return endpoint >= 0 && endpoint < g_endpointCount ? g_endpoints[endpoint].url : "";
+}
+
+static const char* HistoryText(unsigned id) {
+    return intern_get(&historyMessages, id);
+}
+
+static void ReleaseHistoryEntry(HistoryEntry* entry) {
+    if (!entry) return;
+    intern_release(&historyMessages, entry->oldMessage);
+    intern_release(&historyMessages, entry->newMessage);
+    intern_release(&historyMessages, entry->url);
+    entry->oldMessage = entry->newMessage = entry->url = INTERN_EMPTY;
+}
+
 void InitHistoryBuffer(int capacity) {
-    if (capacity < 10) capacity = 10;
-    if (capacity > 10000) capacity = 10000;
+    if (capacity < HISTORY_LIMIT_MIN) capacity = HISTORY_LIMIT_MIN;
+    if (capacity > HISTORY_LIMIT_MAX) capacity = HISTORY_LIMIT_MAX;
 
     if (historyBuffer && capacity == historyCapacity) return;
 
@@ -832,6 +1508,10 @@ void InitHistoryBuffer(int capacity) {
                 newBuf[(toCopy - 1 - i) % capacity] = *src;
             }
         }
+        // Entries that no longer fit give up their messages
+        for (int i = toCopy; i < historyCount; i++) {
+            ReleaseHistoryEntry(GetHistoryEntry(i));
+        }
         historyHead = toCopy % capacity;
         historyCount = toCopy;
     } else {
@@ -844,22 +1524,45 @@ void InitHistoryBuffer(int capacity) {
     historyCapacity = capacity;
 }
 
-void AddHistoryEntry(ApiResult oldResult, const char* oldMsg, ApiResult newResult, const char* newMsg) {
+// Places an entry at the head of the ring, overwriting the oldest when full.
+// The ring takes over the entry's message references.
+static void PushHistoryEntry(const HistoryEntry* entry) {
     if (!historyBuffer || historyCapacity <= 0) return;
-
-    HistoryEntry* entry = &historyBuffer[historyHead];
-    GetLocalTime(&entry->timestamp);
-    entry->oldResult = oldResult;
-    entry->newResult = newResult;
-    strncpy(entry->oldMessage, oldMsg ? oldMsg : "", sizeof(entry->oldMessage) - 1);
-    entry->oldMessage[sizeof(entry->oldMessage) - 1] = '\0';
-    strncpy(entry->newMessage, newMsg ? newMsg : "", sizeof(entry->newMessage) - 1);
-    entry->newMessage[sizeof(entry->newMessage) - 1] = '\0';
-
+    if (historyCount == historyCapacity) ReleaseHistoryEntry(&historyBuffer[historyHead]);
+    historyBuffer[historyHead] = *entry;
     historyHead = (historyHead + 1) % historyCapacity;
     if (historyCount < historyCapacity) historyCount++;
+    historyPushed++;
+}
+
+static void JournalHistoryEntry(const HistoryEntry* entry);
+
+// Records a transition; UI thread only. Results reach the UI thread before
+// they are applied (see DrainPollResults), so no transition needs a hand-off
+// of its own; the open History dialog is updated once per batch of results.
+void AddHistoryEntry(const char* url, ApiResult oldResult, const char* oldMsg, ApiResult newResult, const char* newMsg,
+                     const PhaseTimings* timings) {
+    if (!historyBuffer || historyCapacity <= 0) return;
+    if (!url) url = "";
+    if (!oldMsg) oldMsg = "";
+    if (!newMsg) newMsg = "";
+
+    SYSTEMTIME now;
+    GetLocalTime(&now);
+    HistoryEntry entry = {0};
+    entry.time = SystemTimeToTicks(&now);
+    entry.oldResult = (BYTE)oldResult;
+    entry.newResult = (BYTE)newResult;
+    if (timings) entry.timings = *timings;
+    entry.url = InternHistoryUrl(url, strnlen(url, 511));
+    entry.oldMessage = InternHistoryMessage(oldMsg, strnlen(oldMsg, 255));
+    entry.newMessage = InternHistoryMessage(newMsg, strnlen(newMsg, 255));
+    PushHistoryEntry(&entry);
+    JournalHistoryEntry(&entry);
 }
 
+static void webview_push_history_append(void);
+
 HistoryEntry* GetHistoryEntry(int displayIndex) {
     if (!historyBuffer || displayIndex < 0 || displayIndex >= historyCount) return NULL;
     // displayIndex 0 = most recent
@@ -867,7 +1570,18 @@ HistoryEntry* GetHistoryEntry(int displayIndex) {
     return &historyBuffer[bufIdx];
 }
 
+// Empties the ring
+static void ClearHistory(void) {
+    for (int i = 0; i < historyCount; i++) {
+        ReleaseHistoryEntry(GetHistoryEntry(i));
+    }
+    historyCount = 0;
+    historyHead = 0;
+}
+
 void FreeHistoryBuffer(void) {
+    ClearHistory();
+    intern_free(&historyMessages);
     free(historyBuffer);
     historyBuffer = NULL;
     historyCapacity = 0;
@@ -875,52 +1589,251 @@ void FreeHistoryBuffer(void) {
     historyHead = 0;
 }
 
-void SaveHistoryToRegistry(void) {
-    HKEY hKey;
-    DWORD disposition;
-    LONG result = RegCreateKeyExA(HKEY_CURRENT_USER, REG_KEY_PATH, 0, NULL,
-                                  REG_OPTION_NON_VOLATILE, KEY_WRITE, NULL, &hKey, &disposition);
-    if (result != ERROR_SUCCESS) {
-        LogMessage("ERROR: Failed to open registry for history save. Error: %lu", result);
+// --- History journal ---
+// Every transition is appended to history.journal and synced before
+// AddHistoryEntry returns. Once the journal holds as many records as the
+// ring, the ring is written to history.snapshot and the journal restarts.
+// Startup replays the snapshot, then any journal records newer than it.
+
+#define HISTORY_RECORD_ENTRY    1
+#define HISTORY_RECORD_SNAPSHOT 2   // First record of a snapshot
+
+#define HISTORY_FLAG_TIMINGS    0x01    // PhaseTimings follow the messages
+#define HISTORY_FLAG_URL        0x02    // The endpoint URL follows the timings, endpoint bytes long
+
+// On-disk record; the two messages follow, oldLen + newLen bytes, unterminated.
+// Records written before flags existed have it 0.
+typedef struct {
+    BYTE type;
+    BYTE oldResult;
+    BYTE newResult;
+    BYTE flags;
+    LONG endpoint;           // Length of the URL; without HISTORY_FLAG_URL, the monitor table slot
+    ULONGLONG seq;           // Entry: its sequence number; snapshot: newest sequence it contains
+    SYSTEMTIME timestamp;
+    WORD oldLen;
+    WORD newLen;
+} HistoryRecord;
+
+#define HISTORY_RECORD_MAX (sizeof(HistoryRecord) + 2 * 256 + sizeof(PhaseTimings) + 512)   // Largest record
+
+static ULONGLONG historySnapshotSeq = 0;   // Newest sequence number replayed from the snapshot
+
+static void HistoryStorePath(const char* file, char* out, size_t outLen) {
+    snprintf(out, outLen, "%s\\%s", historyDir, file);
+}
+
+static size_t EncodeHistoryRecord(const HistoryEntry* entry, ULONGLONG seq, BYTE* out, size_t outLen) {
+    HistoryRecord rec = {0};
+    const char* oldMessage = HistoryText(entry->oldMessage);
+    const char* newMessage = HistoryText(entry->newMessage);
+    const char* url = HistoryText(entry->url);
+    size_t oldLen = strlen(oldMessage);
+    size_t newLen = strlen(newMessage);
+    size_t urlLen = strlen(url);
+    size_t len = sizeof(rec) + oldLen + newLen + sizeof(entry->timings) + urlLen;
+    if (len > outLen) return 0;
+
+    rec.type = HISTORY_RECORD_ENTRY;
+    rec.flags = HISTORY_FLAG_TIMINGS | HISTORY_FLAG_URL;
+    rec.oldResult = entry->oldResult;
+    rec.newResult = entry->newResult;
+    rec.endpoint = (LONG)urlLen;
+    rec.seq = seq;
+    TicksToSystemTime(entry->time, &rec.timestamp);
+    rec.oldLen = (WORD)oldLen;
+    rec.newLen = (WORD)newLen;
+    memcpy(out, &rec, sizeof(rec));
+    memcpy(out + sizeof(rec), oldMessage, oldLen);
+    memcpy(out + sizeof(rec) + oldLen, newMessage, newLen);
+    memcpy(out + sizeof(rec) + oldLen + newLen, &entry->timings, sizeof(entry->timings));
+    memcpy(out + len - urlLen, url, urlLen);
+    return len;
+}
+
+// Replay callback for both files: rebuilds the ring, skipping journal records
+// the snapshot already covers (left behind if compaction was interrupted)
+static void ReplayHistoryRecord(void* ctx, const void* data, size_t len) {
+    int fromSnapshot = (ctx != NULL);
+    HistoryRecord rec;
+    if (len < sizeof(rec)) return;
+    memcpy(&rec, data, sizeof(rec));
+
+    if (rec.type == HISTORY_RECORD_SNAPSHOT) {
+        if (fromSnapshot) historySnapshotSeq = historySeq = rec.seq;
         return;
     }
+    size_t timingsLen = (rec.flags & HISTORY_FLAG_TIMINGS) ? sizeof(PhaseTimings) : 0;
+    size_t urlLen = 0;
+    if (rec.flags & HISTORY_FLAG_URL) {
+        if (rec.endpoint < 0 || rec.endpoint > 511) return;
+        urlLen = (size_t)rec.endpoint;
+    }
+    if (rec.type != HISTORY_RECORD_ENTRY || len != sizeof(rec) + rec.oldLen + rec.newLen + timingsLen + urlLen) return;
+    if (!fromSnapshot && rec.seq <= historySnapshotSeq) return;
+
+    HistoryEntry entry = {0};
+    const char* text = (const char*)data + sizeof(rec);
+    if (timingsLen) memcpy(&entry.timings, text + rec.oldLen + rec.newLen, timingsLen);
+    if (rec.flags & HISTORY_FLAG_URL) {
+        entry.url = InternHistoryUrl(text + rec.oldLen + rec.newLen + timingsLen, urlLen);
+    } else {
+        // Older records name the slot; the table as configured now is the best guess
+        const char* url = HistorySlotUrl(rec.endpoint);
+        entry.url = InternHistoryUrl(url, strlen(url));
+    }
+    entry.time = SystemTimeToTicks(&rec.timestamp);
+    entry.oldResult = rec.oldResult;
+    entry.newResult = rec.newResult;
+    entry.oldMessage = InternHistoryMessage(text, rec.oldLen);
+    entry.newMessage = InternHistoryMessage(text + rec.oldLen, rec.newLen);
+    PushHistoryEntry(&entry);
+    if (rec.seq > historySeq) historySeq = rec.seq;
+}
 
-    if (historyCount == 0 || !historyBuffer) {
-        DWORD zero = 0;
-        RegSetValueExA(hKey, REG_VALUE_HISTORY_COUNT, 0, REG_DWORD,
-                       (const BYTE*)&zero, sizeof(zero));
-        RegDeleteValueA(hKey, REG_VALUE_HISTORY_DATA);
-        RegCloseKey(hKey);
-        LogMessage("History saved to registry: 0 entries.");
+static void JournalHistoryEntry(const HistoryEntry* entry) {
+    BYTE record[HISTORY_RECORD_MAX];
+    size_t len = EncodeHistoryRecord(entry, ++historySeq, record, sizeof(record));
+    if (!historyJournal.file || !len) return;
+
+    // Reaches the disk with the next SyncHistoryJournal, at most a second later
+    if (!journal_append(&historyJournal, record, len)) {
+        LogError("ERROR: Failed to append to history journal. Error: %lu", GetLastError());
+        return;
+    }
+    historyJournalDirty = TRUE;
+    if (historyJournal.records >= (size_t)historyCapacity) {
+        CompactHistory();
+    }
+}
+
+static DWORD WINAPI SyncHistoryJournalWork(LPVOID param) {
+    HANDLE file = (HANDLE)param;
+    if (!FlushFileBuffers(file)) {
+        LogError("ERROR: Failed to flush history journal. Error: %lu", GetLastError());
+    }
+    CloseHandle(file);
+    InterlockedExchange(&historySyncPending, 0);
+    return 0;
+}
+
+// Flushes journal appends to disk on a thread-pool thread, so a transition
+// never waits for the disk on the UI thread. Called once a second; the flush
+// works on a duplicate handle, which stays valid if the journal is reset or
+// closed meanwhile. A power loss can cost the last second of transitions.
+static void SyncHistoryJournal(void) {
+    if (!historyJournalDirty || !historyJournal.file) return;
+    if (InterlockedCompareExchange(&historySyncPending, 1, 0) != 0) return;   // Next tick
+
+    HANDLE copy;
+    if (!DuplicateHandle(GetCurrentProcess(), (HANDLE)historyJournal.file, GetCurrentProcess(), &copy,
+                         0, FALSE, DUPLICATE_SAME_ACCESS)) {
+        InterlockedExchange(&historySyncPending, 0);
         return;
     }
+    historyJournalDirty = FALSE;
+    if (!QueueUserWorkItem(SyncHistoryJournalWork, copy, WT_EXECUTELONGFUNCTION)) {
+        CloseHandle(copy);
+        historyJournalDirty = TRUE;
+        InterlockedExchange(&historySyncPending, 0);
+    }
+}
 
-    // Serialize most-recent-first
-    DWORD dataSize = (DWORD)(historyCount * sizeof(HistoryEntry));
-    BYTE* data = (BYTE*)malloc(dataSize);
-    if (!data) {
-        RegCloseKey(hKey);
+// Writes the ring to a new snapshot and empties the journal
+void CompactHistory(void) {
+    if (!historyJournal.file) return;
+
+    char snapshotPath[MAX_PATH];
+    char tempPath[MAX_PATH];
+    HistoryStorePath(HISTORY_SNAPSHOT_FILE, snapshotPath, sizeof(snapshotPath));
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", snapshotPath);
+    DeleteFileA(tempPath);
+
+    Journal snapshot;
+    if (!journal_open(&snapshot, tempPath, NULL, NULL)) {
+        LogError("ERROR: Failed to create history snapshot. Error: %lu", GetLastError());
         return;
     }
 
-    for (int i = 0; i < historyCount; i++) {
-        HistoryEntry* entry = GetHistoryEntry(i); // 0 = most recent
-        if (entry) {
-            memcpy(data + i * sizeof(HistoryEntry), entry, sizeof(HistoryEntry));
+    HistoryRecord header = {0};
+    header.type = HISTORY_RECORD_SNAPSHOT;
+    header.seq = historySeq;
+    BOOL ok = journal_append(&snapshot, &header, sizeof(header));
+
+    // Oldest first, so replay rebuilds the ring in order
+    BYTE record[HISTORY_RECORD_MAX];
+    for (int i = historyCount - 1; i >= 0 && ok; i--) {
+        size_t len = EncodeHistoryRecord(GetHistoryEntry(i), 0, record, sizeof(record));
+        ok = len && journal_append(&snapshot, record, len);
+    }
+    ok = ok && journal_sync(&snapshot);
+    journal_close(&snapshot);
+
+    if (!ok || !MoveFileExA(tempPath, snapshotPath, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        LogError("ERROR: Failed to write history snapshot. Error: %lu", GetLastError());
+        DeleteFileA(tempPath);
+        return;
+    }
+
+    // A crash before this point replays the old journal over the new snapshot;
+    // the sequence numbers make those records no-ops
+    historySnapshotSeq = historySeq;
+    journal_reset(&historyJournal);
+    historyJournalDirty = FALSE;
+    LogDebug("History compacted: %d entries in snapshot.", historyCount);
+}
+
+// Loads history from the snapshot and journal, migrating the old registry copy on first use
+void OpenHistoryStore(void) {
+    char path[MAX_PATH];
+    if (SHGetFolderPathA(NULL, CSIDL_LOCAL_APPDATA, NULL, 0, path) == S_OK) {
+        snprintf(historyDir, sizeof(historyDir), "%s\\APIMonitor", path);
+        CreateDirectoryA(historyDir, NULL);
+    } else {
+        GetModuleFileNameA(NULL, historyDir, MAX_PATH);
+        char* lastSlash = strrchr(historyDir, '\\');
+        if (lastSlash) *lastSlash = '\0';
+    }
+
+    HistoryStorePath(HISTORY_SNAPSHOT_FILE, path, sizeof(path));
+    long snapshotRecords = journal_replay(path, ReplayHistoryRecord, (void*)1);
+
+    HistoryStorePath(HISTORY_JOURNAL_FILE, path, sizeof(path));
+    BOOL journalExisted = (GetFileAttributesA(path) != INVALID_FILE_ATTRIBUTES);
+    if (!journal_open(&historyJournal, path, ReplayHistoryRecord, NULL)) {
+        LogError("ERROR: Failed to open history journal %s. Error: %lu", path, GetLastError());
+        return;
+    }
+    if (historyJournal.discarded) {
+        LogWarn("WARNING: Discarded %lu bytes of incomplete history journal.", (unsigned long)historyJournal.discarded);
+    }
+
+    if (snapshotRecords < 0 && !journalExisted) {
+        // First run with the journal: take over history saved by older versions
+        LoadHistoryFromRegistry();
+        CompactHistory();
+        HKEY hKey;
+        if (RegOpenKeyExA(HKEY_CURRENT_USER, REG_KEY_PATH, 0, KEY_SET_VALUE, &hKey) == ERROR_SUCCESS) {
+            RegDeleteValueA(hKey, REG_VALUE_HISTORY_DATA);
+            RegDeleteValueA(hKey, REG_VALUE_HISTORY_COUNT);
+            RegCloseKey(hKey);
         }
     }
 
-    DWORD dwCount = (DWORD)historyCount;
-    RegSetValueExA(hKey, REG_VALUE_HISTORY_COUNT, 0, REG_DWORD,
-                   (const BYTE*)&dwCount, sizeof(dwCount));
-    RegSetValueExA(hKey, REG_VALUE_HISTORY_DATA, 0, REG_BINARY,
-                   data, dataSize);
+    LogInfo("History loaded: %d entries (%ld in snapshot, %lu journaled).", historyCount,
+            snapshotRecords > 0 ? snapshotRecords - 1 : 0L, (unsigned long)historyJournal.records);
+    LogDebug("History memory: %lu bytes for %d slots, %lu bytes for %u distinct messages.",
+             (unsigned long)((size_t)historyCapacity * sizeof(HistoryEntry)), historyCapacity,
+             (unsigned long)intern_memory(&historyMessages), historyMessages.live);
+}
 
-    free(data);
-    RegCloseKey(hKey);
-    LogMessage("History saved to registry: %d entries.", historyCount);
+// Folds the journal into a snapshot so the next start replays one file
+void CloseHistoryStore(void) {
+    if (historyJournal.records > 0) CompactHistory();
+    journal_close(&historyJournal);
 }
 
+// Reads history saved by versions before the journal (REG_BINARY ring copy)
 void LoadHistoryFromRegistry(void) {
     HKEY hKey;
     LONG result = RegOpenKeyExA(HKEY_CURRENT_USER, REG_KEY_PATH, 0, KEY_READ, &hKey);
@@ -945,10 +1858,13 @@ void LoadHistoryFromRegistry(void) {
         return;
     }
 
-    // Validate size matches count
-    if (size != dwCount * sizeof(HistoryEntry)) {
-        LogMessage("WARNING: History data size mismatch (expected %lu, got %lu). Discarding.",
-                   (unsigned long)(dwCount * sizeof(HistoryEntry)), (unsigned long)size);
+    // Validate size matches count (entries saved before multi-endpoint support lack the endpoint field)
+    size_t recordSize = sizeof(LegacyHistoryEntry);
+    if (size == dwCount * offsetof(LegacyHistoryEntry, endpoint)) {
+        recordSize = offsetof(LegacyHistoryEntry, endpoint);
+    } else if (size != dwCount * sizeof(LegacyHistoryEntry)) {
+        LogWarn("WARNING: History data size mismatch (expected %lu, got %lu). Discarding.",
+                (unsigned long)(dwCount * sizeof(LegacyHistoryEntry)), (unsigned long)size);
         RegCloseKey(hKey);
         return;
     }
@@ -973,584 +1889,1569 @@ void LoadHistoryFromRegistry(void) {
 
     // Data is stored most-recent-first; insert oldest-first so ring buffer order is correct
     for (int i = toLoad - 1; i >= 0; i--) {
-        HistoryEntry* src = (HistoryEntry*)(data + i * sizeof(HistoryEntry));
-        HistoryEntry* dst = &historyBuffer[historyHead];
-        *dst = *src;
-        historyHead = (historyHead + 1) % historyCapacity;
-        if (historyCount < historyCapacity) historyCount++;
+        LegacyHistoryEntry legacy = {0};
+        memcpy(&legacy, data + i * recordSize, recordSize);
+        legacy.oldMessage[sizeof(legacy.oldMessage) - 1] = '\0';
+        legacy.newMessage[sizeof(legacy.newMessage) - 1] = '\0';
+
+        HistoryEntry entry = {0};
+        const char* url = HistorySlotUrl(legacy.endpoint);
+        entry.time = SystemTimeToTicks(&legacy.timestamp);
+        entry.url = InternHistoryUrl(url, strlen(url));
+        entry.oldResult = (BYTE)legacy.oldResult;
+        entry.newResult = (BYTE)legacy.newResult;
+        entry.oldMessage = InternHistoryMessage(legacy.oldMessage, strlen(legacy.oldMessage));
+        entry.newMessage = InternHistoryMessage(legacy.newMessage, strlen(legacy.newMessage));
+        PushHistoryEntry(&entry);
     }
 
     free(data);
-    LogMessage("History loaded from registry: %d entries.", toLoad);
-}
-
-void ApplyConfiguration() {
-    if (g_hwnd) {
-        if (timerRefresh) KillTimer(g_hwnd, 1);
-        timerRefresh = SetTimer(g_hwnd, 1, configRefreshInterval * 1000, RefreshTimer);
-    }
-    LogMessage("Configuration applied: URL=%s, Interval=%d, Logging=%s",
-               configApiUrl, configRefreshInterval, configLoggingEnabled ? "enabled" : "disabled");
+    LogInfo("History loaded from registry: %d entries.", toLoad);
 }
 
-// --- Configuration dialog ---
+// --- Poll time series ---
 
-// Helper: launch a validation thread for the given URL
-static void StartValidation(HWND hDlg, const char* url) {
-    LONG gen = InterlockedIncrement(&g_validateGeneration);
-    ValidateParams* vp = (ValidateParams*)malloc(sizeof(ValidateParams));
-    if (!vp) return;
-    strncpy(vp->url, url, sizeof(vp->url) - 1);
-    vp->url[sizeof(vp->url) - 1] = '\0';
-    vp->hDlg = hDlg;
-    vp->generation = gen;
-    HANDLE hThread = CreateThread(NULL, 0, ValidateUrlThread, vp, 0, NULL);
-    if (hThread) CloseHandle(hThread);
-    else free(vp);
-}
-
-// Validation thread: makes HTTP GET and posts result back to dialog
-DWORD WINAPI ValidateUrlThread(LPVOID param) {
-    ValidateParams* vp = (ValidateParams*)param;
-    HWND hDlg = vp->hDlg;
-    LONG myGen = vp->generation;
-    LRESULT valid = 0;
-
-    // Parse URL
-    char urlCopy[512];
-    strncpy(urlCopy, vp->url, sizeof(urlCopy) - 1);
-    urlCopy[sizeof(urlCopy) - 1] = '\0';
-
-    char* host = NULL;
-    char* path = NULL;
-    int port = 80;
-    BOOL isHttps = FALSE;
-
-    if (strncmp(urlCopy, "http://", 7) == 0) {
-        host = urlCopy + 7;
-    } else if (strncmp(urlCopy, "https://", 8) == 0) {
-        host = urlCopy + 8;
-        port = 443;
-        isHttps = TRUE;
-    } else {
-        host = urlCopy;
-    }
+static LONGLONG CurrentFileTimeTicks(void) {
+    FILETIME ft;
+    ULARGE_INTEGER ticks;
+    GetSystemTimeAsFileTime(&ft);
+    ticks.LowPart = ft.dwLowDateTime;
+    ticks.HighPart = ft.dwHighDateTime;
+    return (LONGLONG)ticks.QuadPart;
+}
 
-    char* slash = strchr(host, '/');
-    if (slash) {
-        *slash = '\0';
-        path = slash + 1;
-    } else {
-        path = "";
+// Loads the saved rollups; called after OpenHistoryStore has picked the directory
+void OpenPollSeries(void) {
+    if (!tseries_init(&pollSeries, configMetricsDays)) {
+        LogError("ERROR: Out of memory allocating the poll time series.");
+        return;
     }
-
-    char* colon = strchr(host, ':');
-    if (colon) {
-        *colon = '\0';
-        port = atoi(colon + 1);
+    char path[MAX_PATH];
+    HistoryStorePath(METRICS_FILE, path, sizeof(path));
+    if (!tseries_open(&pollSeries, path, CurrentFileTimeTicks())) {
+        LogError("ERROR: Failed to open %s, poll rollups will not be saved. Error: %lu", path, GetLastError());
+        return;
     }
+    LogInfo("Poll rollups loaded: %lu for %d endpoint(s), kept for %d day(s).",
+            (unsigned long)tseries_live(&pollSeries), pollSeries.seriesCount, configMetricsDays);
+}
 
-    wchar_t wHost[256], wPath[512];
-    MultiByteToWideChar(CP_UTF8, 0, host, -1, wHost, 256);
-    char fullPath[512] = "/";
-    if (strlen(path) > 0) {
-        sprintf(fullPath, "/%s", path);
-    }
-    MultiByteToWideChar(CP_UTF8, 0, fullPath, -1, wPath, 512);
+// Writes out the partial minute and hour of every series
+void ClosePollSeries(void) {
+    tseries_close(&pollSeries);
+    tseries_free(&pollSeries);
+}
 
-    HINTERNET hSession = NULL, hConnect = NULL, hRequest = NULL;
+// Body bytes the response took on the wire
+static unsigned WireBytes(const PendingCheck* pc) {
+    return (pc->winhttpInflates && pc->wireLength) ? pc->wireLength : pc->wireBytes;
+}
 
-    hSession = WinHttpOpen(L"APIMonitor/1.0", WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
-                          WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0);
-    if (!hSession) goto cleanup;
+// Body bytes after decompression
+static unsigned BodyBytes(const PendingCheck* pc) {
+    return pc->inflating ? (unsigned)inflate_total_out(&pc->inflater) : pc->wireBytes;
+}
 
-    hConnect = WinHttpConnect(hSession, wHost, (INTERNET_PORT)port, 0);
-    if (!hConnect) goto cleanup;
+// Measures a finished poll for its endpoint's time series
+static void MeasurePoll(const PendingCheck* pc, ApiResult result, TSeriesSample* sample) {
+    LARGE_INTEGER now, freq;
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&freq);
+
+    memset(sample, 0, sizeof(*sample));
+    sample->time = CurrentFileTimeTicks();
+    sample->latencyMs = (unsigned)((now.QuadPart - pc->started.QuadPart) * 1000 / freq.QuadPart);
+    sample->bytes = WireBytes(pc);
+    sample->ok = (result == RESULT_SUCCESS);
+    sample->attempts = (BYTE)pc->check.attempt;
+}
 
-    {
-        DWORD flags = isHttps ? WINHTTP_FLAG_SECURE : 0;
-        hRequest = WinHttpOpenRequest(hConnect, L"GET", wPath,
-                                     NULL, WINHTTP_NO_REFERER,
-                                     WINHTTP_DEFAULT_ACCEPT_TYPES, flags);
+// "812 ms (dns 12, connect 30, tls 80, wait 690)": the phases a check went
+// through, those it skipped left out. Empty when nothing was timed.
+static void FormatPhaseTimings(const PhaseTimings* t, char* out, size_t outLen) {
+    static const char* const names[] = { "dns", "connect", "tls", "send", "wait", "receive" };
+    const WORD values[] = { t->dnsMs, t->connectMs, t->tlsMs, t->sendMs, t->waitMs, t->receiveMs };
+    unsigned total = 0;
+    for (int i = 0; i < 6; i++) total += values[i];
+
+    out[0] = '\0';
+    if (outLen == 0 || total == 0) return;
+    size_t pos = (size_t)snprintf(out, outLen, "%u ms (", total);
+    const char* sep = "";
+    for (int i = 0; i < 6 && pos < outLen; i++) {
+        if (!values[i]) continue;
+        pos += (size_t)snprintf(out + pos, outLen - pos, "%s%s %u", sep, names[i], (unsigned)values[i]);
+        sep = ", ";
     }
-    if (!hRequest) goto cleanup;
+    if (pos < outLen) snprintf(out + pos, outLen - pos, ")");
+}
+
+// Adds a poll to the endpoint's time series; UI thread only
+static void RecordPollSample(MonitorEndpoint* ep, const TSeriesSample* sample) {
+    if (ep->series < 0) ep->series = tseries_series(&pollSeries, ep->url);
+    if (ep->series < 0) return;
+    TSeriesSample s = *sample;
+    s.series = (short)ep->series;
+    tseries_record(&pollSeries, &s);
+}
 
-    // 5 second timeouts
-    {
-        int timeout = 5000;
-        WinHttpSetOption(hRequest, WINHTTP_OPTION_CONNECT_TIMEOUT, &timeout, sizeof(timeout));
-        WinHttpSetOption(hRequest, WINHTTP_OPTION_RECEIVE_TIMEOUT, &timeout, sizeof(timeout));
-        WinHttpSetOption(hRequest, WINHTTP_OPTION_SEND_TIMEOUT, &timeout, sizeof(timeout));
+// --- Persistent HTTP connection ---
+
+// Base64 of "user:password" for a Basic Authorization header
+static void EncodeBasicCredentials(const char* user, const char* password, char* out, size_t outSize) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char plain[URL_USER_MAX * 2];
+    int len = snprintf(plain, sizeof(plain), "%s:%s", user, password);
+    if (len < 0 || len >= (int)sizeof(plain)) len = (int)strlen(plain);
+
+    size_t n = 0;
+    for (int i = 0; i < len && n + 4 < outSize; i += 3) {
+        unsigned v = (unsigned char)plain[i] << 16;
+        if (i + 1 < len) v |= (unsigned char)plain[i + 1] << 8;
+        if (i + 2 < len) v |= (unsigned char)plain[i + 2];
+        out[n++] = alphabet[(v >> 18) & 63];
+        out[n++] = alphabet[(v >> 12) & 63];
+        out[n++] = (i + 1 < len) ? alphabet[(v >> 6) & 63] : '=';
+        out[n++] = (i + 2 < len) ? alphabet[v & 63] : '=';
     }
+    out[n] = '\0';
+    SecureZeroMemory(plain, sizeof(plain));
+}
 
-    if (!WinHttpSendRequest(hRequest, WINHTTP_NO_ADDITIONAL_HEADERS, 0,
-                           WINHTTP_NO_REQUEST_DATA, 0, 0, 0))
-        goto cleanup;
+// Cracks a URL into a new descriptor holding one reference; NULL when out of memory.
+// A URL that cannot be polled still gets a descriptor, with error set.
+static EndpointDescriptor* CreateEndpointDescriptor(const char* url) {
+    EndpointDescriptor* d = (EndpointDescriptor*)calloc(1, sizeof(EndpointDescriptor));
+    if (!d) return NULL;
+    d->refCount = 1;
+    strncpy(d->url, url, sizeof(d->url) - 1);
+
+    UrlParts parts;
+    d->error = url_parse(d->url, &parts);
+    if (d->error) return d;
+
+    if (!MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, parts.host, -1, d->host, URL_HOST_MAX)) {
+        d->error = "host is not valid UTF-8";
+        return d;
+    }
+    MultiByteToWideChar(CP_UTF8, 0, parts.target, -1, d->target, URL_TARGET_MAX);   // ASCII once escaped
+    d->port = (INTERNET_PORT)parts.port;
+
+    // The target is escaped already: WinHTTP must send it exactly as it is
+    d->requestFlags = WINHTTP_FLAG_ESCAPE_DISABLE | (parts.secure ? WINHTTP_FLAG_SECURE : 0);
+    if (parts.hasUserinfo) {
+        char credentials[(URL_USER_MAX * 2 + 2) / 3 * 4 + 1];
+        EncodeBasicCredentials(parts.user, parts.password, credentials, sizeof(credentials));
+        swprintf(d->headers, sizeof(d->headers) / sizeof(wchar_t), L"Authorization: Basic %hs\r\n", credentials);
+        SecureZeroMemory(credentials, sizeof(credentials));
+        d->credentials = TRUE;
+    }
+    SecureZeroMemory(&parts, sizeof(parts));
+    return d;
+}
 
-    if (!WinHttpReceiveResponse(hRequest, NULL))
-        goto cleanup;
+static EndpointDescriptor* RetainEndpointDescriptor(EndpointDescriptor* d) {
+    if (d) InterlockedIncrement(&d->refCount);
+    return d;
+}
 
-    {
-        DWORD statusCode = 0, size = sizeof(statusCode);
-        if (!WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
-                                NULL, &statusCode, &size, NULL))
-            goto cleanup;
-        if (statusCode != 200)
-            goto cleanup;
+static void ReleaseEndpointDescriptor(EndpointDescriptor* d) {
+    if (d && InterlockedDecrement(&d->refCount) == 0) {
+        SecureZeroMemory(d->headers, sizeof(d->headers));
+        free(d);
     }
+}
 
-    // Read response body
-    {
-        char response[4096] = {0};
-        DWORD totalSize = 0, downloaded = 0;
-
-        do {
-            DWORD sizeAvailable = 0;
-            if (!WinHttpQueryDataAvailable(hRequest, &sizeAvailable)) break;
-            if (sizeAvailable == 0) break;
+// Retry-After of a response (delta-seconds or an HTTP date) in ms; 0 when absent or past
+static unsigned QueryRetryAfterMs(HINTERNET hRequest) {
+    wchar_t value[64];
+    DWORD size = sizeof(value);
+    if (!WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_RETRY_AFTER, WINHTTP_HEADER_NAME_BY_INDEX,
+                             value, &size, WINHTTP_NO_HEADER_INDEX)) {
+        return 0;
+    }
 
-            char* buffer = malloc(sizeAvailable + 1);
-            if (!buffer) break;
-            if (!WinHttpReadData(hRequest, buffer, sizeAvailable, &downloaded)) {
-                free(buffer);
-                break;
-            }
-            buffer[downloaded] = '\0';
+    ULONGLONG seconds;
+    if (value[0] >= L'0' && value[0] <= L'9') {
+        seconds = wcstoul(value, NULL, 10);
+    } else {
+        SYSTEMTIME st;
+        FILETIME ft;
+        if (!WinHttpTimeToSystemTime(value, &st) || !SystemTimeToFileTime(&st, &ft)) return 0;
+        ULARGE_INTEGER at;
+        at.LowPart = ft.dwLowDateTime;
+        at.HighPart = ft.dwHighDateTime;
+        LONGLONG now = CurrentFileTimeTicks();
+        if ((LONGLONG)at.QuadPart <= now) return 0;
+        seconds = ((LONGLONG)at.QuadPart - now) / 10000000;
+    }
+    if (seconds > RETRY_AFTER_MAX_SECONDS) seconds = RETRY_AFTER_MAX_SECONDS;
+    return (unsigned)(seconds * 1000);
+}
 
-            if (totalSize + downloaded < sizeof(response) - 1) {
-                strcat(response, buffer);
-                totalSize += downloaded;
-            }
-            free(buffer);
-        } while (downloaded > 0);
+// Copies a response header into out; empty when absent or too long to keep
+static void QueryHeaderString(HINTERNET hRequest, DWORD query, wchar_t* out, DWORD outLen) {
+    DWORD size = outLen * sizeof(wchar_t);
+    if (!WinHttpQueryHeaders(hRequest, query, WINHTTP_HEADER_NAME_BY_INDEX, out, &size, WINHTTP_NO_HEADER_INDEX)) {
+        out[0] = L'\0';
+    }
+}
 
-        // Check for expected XML tags
-        if (strstr(response, "<result") || strstr(response, "<r>")) {
-            valid = 1;
+// Prepares to inflate a 2xx response's body when it is compressed and WinHTTP
+// is not already decompressing it
+static void BeginInflate(PendingCheck* pc, HINTERNET hRequest) {
+    wchar_t encoding[32];
+    QueryHeaderString(hRequest, WINHTTP_QUERY_CONTENT_ENCODING, encoding, sizeof(encoding) / sizeof(wchar_t));
+    if (!encoding[0] || lstrcmpiW(encoding, L"identity") == 0) return;
+
+    if (pc->winhttpInflates) {
+        // The body arrives decompressed; Content-Length, when sent, is what travelled
+        DWORD length = 0, size = sizeof(length);
+        if (WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_CONTENT_LENGTH | WINHTTP_QUERY_FLAG_NUMBER,
+                                NULL, &length, &size, NULL)) {
+            pc->wireLength = length;
         }
+        return;
     }
 
-cleanup:
-    if (hRequest) WinHttpCloseHandle(hRequest);
-    if (hConnect) WinHttpCloseHandle(hConnect);
-    if (hSession) WinHttpCloseHandle(hSession);
-
-    // Only post result if this generation is still current
-    if (InterlockedCompareExchange(&g_validateGeneration, myGen, myGen) == myGen) {
-        PostMessage(hDlg, WM_VALIDATE_RESULT, (WPARAM)myGen, valid);
+    InflateFormat format;
+    if (lstrcmpiW(encoding, L"gzip") == 0 || lstrcmpiW(encoding, L"x-gzip") == 0) {
+        format = INFLATE_GZIP;
+    } else if (lstrcmpiW(encoding, L"deflate") == 0) {
+        format = INFLATE_DEFLATE;
+    } else {
+        LogWarn("WARNING: %s answered with unsupported Content-Encoding %ls.", pc->desc->url, encoding);
+        pc->inflateError = "unsupported Content-Encoding";
+        return;
     }
 
-    free(vp);
-    return 0;
-}
+    if (!pc->inflated) {
+        pc->inflated = (CheckBuffer*)malloc(sizeof(CheckBuffer));
+        if (pc->inflated) check_buffer_init(pc->inflated, pc->check.body->max);
+    }
+    if (!pc->inflated || !inflate_init(&pc->inflater, format)) {
+        pc->inflateError = "out of memory";
+        return;
+    }
+    check_buffer_reset(pc->inflated);
+    pc->inflating = TRUE;
+}
 
-void ShowConfigDialog(HWND hwndParent) {
-    (void)hwndParent;
-    ShowWebViewDialog("config", 480, 380);
+// Drops the previous attempt's inflate state
+static void EndInflate(PendingCheck* pc) {
+    if (pc->inflating) inflate_free(&pc->inflater);
+    pc->inflating = FALSE;
+    pc->inflateError = NULL;
+    pc->inflateDone = FALSE;
+    pc->wireBytes = 0;
+    pc->wireLength = 0;
 }
 
-// --- Timer and refresh ---
+// Records the first time an attempt reaches a phase mark
+static void MarkPhase(PendingCheck* pc, PhaseMark mark) {
+    if (pc->marks[mark]) return;
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    pc->marks[mark] = now.QuadPart;
+}
 
-void SetRefreshInterval(int seconds, BOOL isUserSetting) {
-    if (isUserSetting) {
-        configRefreshInterval = seconds;
-        SaveConfigToRegistry();
+// Milliseconds from one mark to the next; a phase that started but never
+// finished runs until the attempt ended, which shows where a failure stalled
+static WORD PhaseSpan(const PendingCheck* pc, PhaseMark from, PhaseMark to, LONGLONG freq) {
+    LONGLONG start = pc->marks[from];
+    LONGLONG end = pc->marks[to] ? pc->marks[to] : pc->marks[PHASE_MARK_DONE];
+    if (!start || end < start) return 0;
+    LONGLONG ms = (end - start) * 1000 / freq;
+    return (WORD)(ms > 0xFFFF ? 0xFFFF : ms);
+}
+
+// Splits the last attempt into its phases. WinHTTP reports no handshake of
+// its own: on https it runs between connecting and sending the request.
+static void MeasurePhases(const PendingCheck* pc, PhaseTimings* t) {
+    LARGE_INTEGER freq;
+    QueryPerformanceFrequency(&freq);
+
+    memset(t, 0, sizeof(*t));
+    t->dnsMs = PhaseSpan(pc, PHASE_MARK_RESOLVING, PHASE_MARK_RESOLVED, freq.QuadPart);
+    t->connectMs = PhaseSpan(pc, PHASE_MARK_CONNECTING, PHASE_MARK_CONNECTED, freq.QuadPart);
+    if (pc->desc->requestFlags & WINHTTP_FLAG_SECURE) {
+        t->tlsMs = PhaseSpan(pc, PHASE_MARK_CONNECTED, PHASE_MARK_SENDING, freq.QuadPart);
+    }
+    t->sendMs = PhaseSpan(pc, PHASE_MARK_SENDING, PHASE_MARK_SENT, freq.QuadPart);
+    t->waitMs = PhaseSpan(pc, PHASE_MARK_SENT, PHASE_MARK_FIRST_BYTE, freq.QuadPart);
+    t->receiveMs = PhaseSpan(pc, PHASE_MARK_FIRST_BYTE, PHASE_MARK_DONE, freq.QuadPart);
+}
+
+// Feeds WinHTTP completions for a request into its check state machine
+static void CALLBACK HttpStatusCallback(HINTERNET hInternet, DWORD_PTR context, DWORD status,
+                                        LPVOID info, DWORD infoLen) {
+    PendingCheck* pc = (PendingCheck*)context;
+    if (!pc) return;   // Session and connection handles carry no context
+
+    CheckEvent ev = {0};
+    switch (status) {
+        // Progress notifications: only timed
+        case WINHTTP_CALLBACK_STATUS_RESOLVING_NAME:
+            MarkPhase(pc, PHASE_MARK_RESOLVING);
+            return;
+        case WINHTTP_CALLBACK_STATUS_NAME_RESOLVED:
+            MarkPhase(pc, PHASE_MARK_RESOLVED);
+            return;
+        case WINHTTP_CALLBACK_STATUS_CONNECTING_TO_SERVER:
+            MarkPhase(pc, PHASE_MARK_CONNECTING);
+            return;
+        case WINHTTP_CALLBACK_STATUS_SENDING_REQUEST:
+            MarkPhase(pc, PHASE_MARK_SENDING);
+            return;
+        case WINHTTP_CALLBACK_STATUS_REQUEST_SENT:
+            MarkPhase(pc, PHASE_MARK_SENT);
+            return;
+        case WINHTTP_CALLBACK_STATUS_RESPONSE_RECEIVED:
+            // Also reported for every body read; only the first one is the response arriving
+            if (pc->marks[PHASE_MARK_SENT]) MarkPhase(pc, PHASE_MARK_FIRST_BYTE);
+            return;
 
-        if (currentResult != RESULT_SUCCESS) {
-            LogMessage("Interval change to %d seconds requested, but not applied due to non-success state.", seconds);
+        case WINHTTP_CALLBACK_STATUS_CONNECTED_TO_SERVER:
+            MarkPhase(pc, PHASE_MARK_CONNECTED);
+            pc->newConnection = TRUE;
             return;
+
+        case WINHTTP_CALLBACK_STATUS_SENDREQUEST_COMPLETE:
+            ev.type = CHECK_EV_SENT;
+            break;
+
+        case WINHTTP_CALLBACK_STATUS_HEADERS_AVAILABLE: {
+            MarkPhase(pc, PHASE_MARK_FIRST_BYTE);
+            DWORD statusCode = 0, size = sizeof(statusCode);
+            if (!WinHttpQueryHeaders(hInternet, WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
+                                     NULL, &statusCode, &size, NULL)) {
+                ev.type = CHECK_EV_ERROR;
+                ev.error = GetLastError();
+                ev.what = "No status code";
+                break;
+            }
+
+            // Record whether this attempt rode an existing keep-alive connection
+            if (pc->endpoint >= 0) {
+                BOOL reusedConnection = !pc->newConnection;
+                pc->connectionReused = reusedConnection;
+                LONG polls = InterlockedIncrement(&g_pollCount);
+                LONG reused = reusedConnection ? InterlockedIncrement(&g_pollReusedCount) : g_pollReusedCount;
+                LogDebug("Connection %s (attempt %d/%d, %ld of %ld polls reused a connection).",
+                         reusedConnection ? "reused" : "newly established",
+                         pc->check.attempt, pc->check.maxAttempts, reused, polls);
+            }
+            // Overloaded or rate-limited: the server may say when to come back
+            if (statusCode == 429 || statusCode == 503) {
+                pc->retryAfterMs = QueryRetryAfterMs(hInternet);
+            }
+
+            // Validators to send back next time, so an unchanged document costs a 304
+            if (pc->endpoint >= 0 && statusCode >= 200 && statusCode <= 299) {
+                QueryHeaderString(hInternet, WINHTTP_QUERY_ETAG, pc->received.etag,
+                                  sizeof(pc->received.etag) / sizeof(wchar_t));
+                QueryHeaderString(hInternet, WINHTTP_QUERY_LAST_MODIFIED, pc->received.lastModified,
+                                  sizeof(pc->received.lastModified) / sizeof(wchar_t));
+            }
+            if (statusCode >= 200 && statusCode <= 299) {
+                BeginInflate(pc, hInternet);
+            }
+            ev.type = CHECK_EV_HEADERS;
+            ev.status = statusCode;
+            break;
         }
+
+        case WINHTTP_CALLBACK_STATUS_DATA_AVAILABLE:
+            ev.type = CHECK_EV_DATA_AVAILABLE;
+            ev.size = *(DWORD*)info;
+            break;
+
+        case WINHTTP_CALLBACK_STATUS_READ_COMPLETE:
+            ev.type = CHECK_EV_READ_COMPLETE;
+            ev.size = infoLen;
+            break;
+
+        case WINHTTP_CALLBACK_STATUS_REQUEST_ERROR:
+            ev.type = CHECK_EV_ERROR;
+            ev.error = ((WINHTTP_ASYNC_RESULT*)info)->dwError;
+            break;
+
+        default:
+            return;
     }
 
-    if (timerRefresh) KillTimer(g_hwnd, 1);
-    timerRefresh = SetTimer(g_hwnd, 1, seconds * 1000, RefreshTimer);
-    LogMessage("Refresh timer updated: %d seconds (userSetting=%s)", seconds, isUserSetting ? "true" : "false");
+    check_step(&pc->check, &ev);
 }
 
-void RefreshStatus() {
-    LogMessage("RefreshStatus() called.");
-    DWORD threadId;
+// Returns the process-wide WinHTTP session, creating it on first use.
+// Keeping one session alive keeps Schannel's TLS session cache warm, so even
+// a fresh TCP connection resumes the TLS session instead of a full handshake.
+// The session is asynchronous: no thread ever blocks on the network.
+static HINTERNET GetHttpSession(void) {
+    EnterCriticalSection(&httpCriticalSection);
+    if (!g_httpSession) {
+        g_httpSession = WinHttpOpen(L"APIMonitor/1.0", WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
+                                    WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, WINHTTP_FLAG_ASYNC);
+        if (g_httpSession) {
+            WinHttpSetStatusCallback(g_httpSession, HttpStatusCallback,
+                                     WINHTTP_CALLBACK_FLAG_ALL_COMPLETIONS | WINHTTP_CALLBACK_FLAG_RESOLVE_NAME |
+                                     WINHTTP_CALLBACK_FLAG_CONNECT_TO_SERVER | WINHTTP_CALLBACK_FLAG_SEND_REQUEST |
+                                     WINHTTP_CALLBACK_FLAG_RECEIVE_RESPONSE, 0);
+            LogDebug("WinHTTP session created (async).");
+        }
+    }
+    HINTERNET hSession = g_httpSession;
+    LeaveCriticalSection(&httpCriticalSection);
+    return hSession;
+}
 
-    // Allocate thread parameters
-    ThreadParams* params = (ThreadParams*)malloc(sizeof(ThreadParams));
-    if (!params) {
-        LogMessage("ERROR: Failed to allocate memory for thread parameters");
-        return;
+// Opens a connection handle for a URL; on failure *what and *error describe why
+static HttpConnection* CreateHttpConnection(EndpointDescriptor* desc, const char** what, DWORD* error) {
+    HINTERNET hSession = GetHttpSession();
+    if (!hSession) {
+        *error = GetLastError();
+        *what = "HTTP init failed";
+        return NULL;
     }
-    params->attempt = 1;
-    params->maxAttempts = 3;
 
-    // Create thread with parameters
-    CloseHandle(CreateThread(NULL, 0, RefreshThread, params, 0, &threadId));
+    HttpConnection* conn = (HttpConnection*)calloc(1, sizeof(HttpConnection));
+    if (!conn) {
+        *error = ERROR_NOT_ENOUGH_MEMORY;
+        *what = "Connection failed";
+        return NULL;
+    }
+
+    conn->hConnect = WinHttpConnect(hSession, desc->host, desc->port, 0);
+    if (!conn->hConnect) {
+        *error = GetLastError();
+        *what = "Connection failed";
+        free(conn);
+        return NULL;
+    }
+    conn->desc = RetainEndpointDescriptor(desc);
+    conn->refCount = 1;
+    return conn;
 }
 
-void ParseXmlResponse(const char* xml, ApiResponse* response) {
-    response->result = RESULT_INVALID;
-    strncpy(response->message, "Invalid XML", sizeof(response->message) - 1);
+// Returns a referenced connection to the endpoint, connecting on first use.
+// Only the endpoint's current URL gets the persistent connection; a poll
+// started before the URL changed connects for itself.
+static HttpConnection* AcquireHttpConnection(MonitorEndpoint* ep, EndpointDescriptor* desc,
+                                             const char** what, DWORD* error) {
+    EnterCriticalSection(&httpCriticalSection);
+    if (!ep->connection) {
+        EnterCriticalSection(&monitorCriticalSection);
+        BOOL current = (ep->descriptor == desc);
+        LeaveCriticalSection(&monitorCriticalSection);
+
+        if (current) {
+            ep->connection = CreateHttpConnection(desc, what, error);
+            if (!ep->connection) {
+                LeaveCriticalSection(&httpCriticalSection);
+                return NULL;
+            }
+            LogDebug("Persistent HTTP connection created for %s", desc->url);
+        }
+    }
+    HttpConnection* conn = ep->connection;
+    if (conn && conn->desc == desc) {
+        InterlockedIncrement(&conn->refCount);
+        LeaveCriticalSection(&httpCriticalSection);
+        return conn;
+    }
+    LeaveCriticalSection(&httpCriticalSection);
+    return CreateHttpConnection(desc, what, error);
+}
 
-    if (!xml || strlen(xml) == 0) {
-        LogMessage("ERROR: Empty XML response received.");
-        strncpy(response->message, "Empty response", sizeof(response->message) - 1);
-        return;
+static void ReleaseHttpConnection(HttpConnection* conn) {
+    if (conn && InterlockedDecrement(&conn->refCount) == 0) {
+        WinHttpCloseHandle(conn->hConnect);
+        ReleaseEndpointDescriptor(conn->desc);
+        free(conn);
     }
+}
 
-    const char* resultTag = strstr(xml, "<r>");
-    const char* resultEnd = NULL;
-    const char* valueStart = NULL;
-    BOOL isShortTag = FALSE;
+// Drops the endpoint's connection; in-flight polls keep their reference until done
+static void ResetHttpConnection(MonitorEndpoint* ep) {
+    EnterCriticalSection(&httpCriticalSection);
+    HttpConnection* old = ep->connection;
+    ep->connection = NULL;
+    LeaveCriticalSection(&httpCriticalSection);
+    ReleaseHttpConnection(old);
+}
 
-    if (resultTag) {
-        isShortTag = TRUE;
-        resultEnd = strstr(resultTag, "</r>");
-        if (!resultEnd) {
-            LogMessage("ERROR: Invalid XML - unclosed <r> tag. Raw: %.100s", xml);
-            strncpy(response->message, "Unclosed <r> tag", sizeof(response->message) - 1);
-            return;
-        }
-        valueStart = resultTag + 3;
-    } else {
-        resultTag = strstr(xml, "<result");
-        if (!resultTag) {
-            LogMessage("ERROR: Invalid XML - no <result> tag found. Raw: %.100s", xml);
-            strncpy(response->message, "No result tag", sizeof(response->message) - 1);
-            return;
-        }
+void CloseHttpSession(void) {
+    for (int i = 0; i < MAX_ENDPOINTS; i++) {
+        ResetHttpConnection(&g_endpoints[i]);
+    }
+    EnterCriticalSection(&httpCriticalSection);
+    if (g_httpSession) {
+        WinHttpCloseHandle(g_httpSession);
+        g_httpSession = NULL;
+    }
+    LeaveCriticalSection(&httpCriticalSection);
+}
 
-        resultEnd = strstr(resultTag, "</result>");
-        if (!resultEnd) {
-            LogMessage("ERROR: Invalid XML - unclosed <result> tag. Raw: %.100s", xml);
-            strncpy(response->message, "Unclosed <result> tag", sizeof(response->message) - 1);
-            return;
-        }
+// --- Monitor table ---
 
-        const char* closeBracket = strchr(resultTag, '>');
-        if (!closeBracket || closeBracket >= resultEnd) {
-            LogMessage("ERROR: Invalid XML - malformed <result> tag. Raw: %.100s", xml);
-            strncpy(response->message, "Malformed <result> tag", sizeof(response->message) - 1);
-            return;
+// Severity used to pick the tray's worst-of status across endpoints
+static int ResultSeverity(ApiResult r) {
+    switch (r) {
+        case RESULT_SUCCESS:  return 1;
+        case RESULT_DEGRADED: return 2;
+        case RESULT_INVALID:  return 3;
+        case RESULT_ERROR:    return 4;
+        case RESULT_FAIL:     return 5;
+        default:             return 0;
+    }
+}
+
+// Assigns one slot of the monitor table; keeps state and connection when the URL is unchanged
+static void AssignEndpoint(int index, const char* url, int interval, const char* format) {
+    MonitorEndpoint* ep = &g_endpoints[index];
+    BOOL urlChanged = (index >= g_endpointCount) || strcmp(ep->url, url) != 0;
+    BOOL formatChanged = strcmp(ep->format, format) != 0;
+
+    // Crack a new URL once, here, rather than on every attempt
+    EndpointDescriptor* desc = NULL;
+    EndpointDescriptor* oldDesc = NULL;
+    if (urlChanged) {
+        desc = CreateEndpointDescriptor(url);
+        if (desc && desc->error && url[0]) {
+            LogWarn("WARNING: Endpoint URL %s cannot be polled: %s.", url, desc->error);
         }
-        valueStart = closeBracket + 1;
-    }
-
-    char resultValue[32] = {0};
-    size_t valueLen = resultEnd - valueStart;
-    if (valueLen >= sizeof(resultValue)) valueLen = sizeof(resultValue) - 1;
-    strncpy(resultValue, valueStart, valueLen);
-    resultValue[valueLen] = '\0';
-
-    const char* msgTag = strstr(xml, "<message>");
-    if (msgTag) {
-        const char* msgEnd = strstr(msgTag, "</message>");
-        if (msgEnd) {
-            msgTag += 9;
-            size_t msgLen = msgEnd - msgTag;
-            if (msgLen >= sizeof(response->message)) msgLen = sizeof(response->message) - 1;
-            strncpy(response->message, msgTag, msgLen);
-            response->message[msgLen] = '\0';
-
-            char* p = response->message;
-            while (*p && isspace((unsigned char)*p)) p++;
-            char* end = p + strlen(p) - 1;
-            while (end > p && isspace((unsigned char)*end)) *end-- = '\0';
+    }
+
+    ULONGLONG due = 0;
+    EnterCriticalSection(&monitorCriticalSection);
+    ep->refreshInterval = interval;
+    if (urlChanged) {
+        oldDesc = ep->descriptor;
+        ep->descriptor = desc;
+    }
+    if (urlChanged || formatChanged) {
+        // A different decoder can give a different verdict for the same response
+        strncpy(ep->url, url, sizeof(ep->url) - 1);
+        ep->url[sizeof(ep->url) - 1] = '\0';
+        strncpy(ep->format, format, sizeof(ep->format) - 1);
+        ep->format[sizeof(ep->format) - 1] = '\0';
+        decoder_parse(ep->format, &ep->decoder);
+        ep->generation++;
+        ep->result = RESULT_NONE;
+        ep->message[0] = '\0';
+        ep->activeInterval = interval;
+        ep->skippedTicks = 0;
+        ep->failures = 0;
+        memset(&ep->cached, 0, sizeof(ep->cached));
+        breaker_init(&ep->breaker);
+        ep->singleAttempt = FALSE;
+        due = GetTickCount64();   // Check new endpoints right away
+        if (urlChanged) {
+            ep->series = -1;
+            ep->wireBytes = 0;
+            ep->bodyBytes = 0;
+            memset(&ep->timings, 0, sizeof(ep->timings));
         }
+    } else if ((ep->result == RESULT_SUCCESS || ep->result == RESULT_NONE) && ep->activeInterval != interval) {
+        ep->activeInterval = interval;
+        due = GetTickCount64() + (ULONGLONG)interval * 1000;
     }
+    LeaveCriticalSection(&monitorCriticalSection);
+    ReleaseEndpointDescriptor(oldDesc);
 
-    char* p = resultValue;
-    while (*p && isspace((unsigned char)*p)) p++;
-    char* end = p + strlen(p) - 1;
-    while (end > p && isspace((unsigned char)*end)) *end-- = '\0';
+    // Slow polls of another URL, or counted over another window size, do not carry over
+    if (urlChanged || ep->latency.size != configDegradedWindow) {
+        slo_init(&ep->latency, configDegradedWindow);
+    }
 
-    for (char* c = p; *c; c++) {
-        *c = tolower((unsigned char)*c);
+    if (due) {
+        ep->lastDue = due;
+        ScheduleEndpoint(index, due);
     }
 
-    if (strcmp(p, "success") == 0) {
-        response->result = RESULT_SUCCESS;
-        LogMessage("XML parsed successfully: result=success, message=%s", response->message);
-    } else if (strcmp(p, "fail") == 0) {
-        response->result = RESULT_FAIL;
-        LogMessage("XML parsed: result=fail, message=%s", response->message);
-    } else {
-        LogMessage("ERROR: Invalid XML - unknown result value '%s'. Raw: %.100s", p, xml);
+    if (urlChanged) {
+        // Rebuild the persistent connection only if the URL actually changed
+        ResetHttpConnection(ep);
     }
 }
 
-DWORD WINAPI RefreshThread(LPVOID param) {
-    ThreadParams* params = (ThreadParams*)param;
-    const int maxAttempts = params->maxAttempts;
-    ApiResult finalResult = RESULT_ERROR;
-    char finalMessage[256] = "Unknown error";
-    char response[4096] = {0};
+// Syncs the monitor table with the primary URL and the additional endpoints
+void RebuildMonitorTable(void) {
+    int count = 0;
+    AssignEndpoint(count++, configApiUrl, configRefreshInterval, configResponseFormat);
+    for (int i = 0; i < configExtraEndpointCount && count < MAX_ENDPOINTS; i++) {
+        const EndpointConfig* ec = &configExtraEndpoints[i];
+        AssignEndpoint(count++, ec->url, ec->interval > 0 ? ec->interval : configRefreshInterval, ec->format);
+    }
 
-    // Validate API URL
-    if (strlen(configApiUrl) == 0) {
-        LogMessage("ERROR: API URL is not configured.");
-        strncpy(finalMessage, "API URL not configured", sizeof(finalMessage) - 1);
-        UpdateStatus(RESULT_ERROR, finalMessage);
-        free(params);
-        return 0;
+    // Retire slots no longer configured
+    for (int i = count; i < g_endpointCount; i++) {
+        sched_cancel(&g_scheduler, i);
+    }
+    EndpointDescriptor* retired[MAX_ENDPOINTS];
+    int retiredCount = 0;
+    EnterCriticalSection(&monitorCriticalSection);
+    for (int i = count; i < g_endpointCount; i++) {
+        g_endpoints[i].generation++;
+        g_endpoints[i].url[0] = '\0';
+        g_endpoints[i].format[0] = '\0';
+        g_endpoints[i].result = RESULT_NONE;
+        retired[retiredCount++] = g_endpoints[i].descriptor;
+        g_endpoints[i].descriptor = NULL;
+    }
+    g_endpointCount = count;
+    LeaveCriticalSection(&monitorCriticalSection);
+    for (int i = 0; i < retiredCount; i++) {
+        ReleaseEndpointDescriptor(retired[i]);
+    }
+    for (int i = count; i < MAX_ENDPOINTS; i++) {
+        ResetHttpConnection(&g_endpoints[i]);
     }
 
-    // Retry loop
-    for (int attempt = params->attempt; attempt <= maxAttempts; attempt++) {
-        // Update tooltip with attempt count
-        char tip[128];
-        snprintf(tip, sizeof(tip), "Updating API contents [%d/%d]...", attempt, maxAttempts);
-        strcpy(nid.szTip, tip);
-        nid.uFlags = NIF_TIP;
-        Shell_NotifyIconA(NIM_MODIFY, &nid);
-
-        LogMessage("API refresh attempt %d/%d started.", attempt, maxAttempts);
-
-        // Reset response buffer
-        response[0] = '\0';
-
-        // Parse URL (existing logic)
-        char urlCopy[512];
-        strncpy(urlCopy, configApiUrl, sizeof(urlCopy) - 1);
-        urlCopy[sizeof(urlCopy) - 1] = '\0';
-
-        char* protocol = NULL;
-        char* host = NULL;
-        char* path = NULL;
-        int port = 80;
-        BOOL isHttps = FALSE;
-
-        if (strncmp(urlCopy, "http://", 7) == 0) {
-            protocol = urlCopy;
-            host = urlCopy + 7;
-        } else if (strncmp(urlCopy, "https://", 8) == 0) {
-            protocol = urlCopy;
-            host = urlCopy + 8;
-            port = 443;
-            isHttps = TRUE;
-        } else {
-            host = urlCopy;
-        }
+    LogInfo("Monitor table rebuilt: %d endpoint(s).", count);
+}
 
-        char* slash = strchr(host, '/');
-        if (slash) {
-            *slash = '\0';
-            path = slash + 1;
-        } else {
-            path = "";
-        }
+void ApplyConfiguration() {
+    RebuildMonitorTable();
+    LogInfo("Configuration applied: URL=%s, Interval=%d, Logging=%s, AdditionalEndpoints=%d",
+            configApiUrl, configRefreshInterval, configLoggingEnabled ? "enabled" : "disabled",
+            configExtraEndpointCount);
+}
 
-        char* colon = strchr(host, ':');
-        if (colon) {
-            *colon = '\0';
-            port = atoi(colon + 1);
-        }
+// --- Async check transport ---
+// WinHTTP implementation of the check state machine's transport (see check.h).
+// Each operation is issued asynchronously and completes in HttpStatusCallback;
+// finished checks are handed to the worker pool for parsing and status updates.
+
+static int HttpCheckError(CheckEvent* ev, const char* what) {
+    ev->type = CHECK_EV_ERROR;
+    ev->error = GetLastError();
+    ev->what = what;
+    return CHECK_OP_DONE;
+}
+
+static int HttpCheckSend(CheckRequest* req, CheckEvent* ev) {
+    PendingCheck* pc = (PendingCheck*)req->context;
+
+    if (g_workersStopping) {
+        SetLastError(ERROR_WINHTTP_OPERATION_CANCELLED);
+        return HttpCheckError(ev, "Request cancelled");
+    }
 
-        wchar_t wHost[256], wPath[512];
-        MultiByteToWideChar(CP_UTF8, 0, host, -1, wHost, 256);
-        char fullPath[512] = "/";
-        if (strlen(path) > 0) {
-            sprintf(fullPath, "/%s", path);
+    if (pc->endpoint >= 0) {
+        // The tray belongs to the UI thread; let it show the attempt count
+        PostMessage(g_hwnd, WM_CHECK_PROGRESS, (WPARAM)pc->endpoint, MAKELPARAM(req->attempt, req->maxAttempts));
+        LogDebug("API refresh attempt %d/%d started for %s.", req->attempt, req->maxAttempts, pc->desc->url);
+    }
+
+    // Polls reuse the endpoint's persistent connection, validation uses a transient one
+    if (!pc->conn) {
+        const char* what = NULL;
+        DWORD error = 0;
+        pc->conn = (pc->endpoint >= 0) ? AcquireHttpConnection(&g_endpoints[pc->endpoint], pc->desc, &what, &error)
+                                       : CreateHttpConnection(pc->desc, &what, &error);
+        if (!pc->conn) {
+            ev->type = CHECK_EV_ERROR;
+            ev->error = error;
+            ev->what = what;
+            return CHECK_OP_DONE;
         }
-        MultiByteToWideChar(CP_UTF8, 0, fullPath, -1, wPath, 512);
-
-        // HTTP Request with error handling
-        HINTERNET hSession = NULL;
-        HINTERNET hConnect = NULL;
-        HINTERNET hRequest = NULL;
-        BOOL networkError = FALSE;
-        char errorMsg[128] = "";
-
-        // Create session
-        hSession = WinHttpOpen(L"APIMonitor/1.0", WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
-                              WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0);
-        if (!hSession) {
-            sprintf(errorMsg, "HTTP init failed: %lu", GetLastError());
-            LogMessage("ERROR: %s (attempt %d/%d)", errorMsg, attempt, maxAttempts);
-            networkError = TRUE;
+    }
+
+    pc->hRequest = WinHttpOpenRequest(pc->conn->hConnect, L"GET", pc->desc->target,
+                                      NULL, WINHTTP_NO_REFERER,
+                                      WINHTTP_DEFAULT_ACCEPT_TYPES, pc->desc->requestFlags);
+    if (!pc->hRequest) return HttpCheckError(ev, "Request creation failed");
+
+    int timeout = pc->timeoutMs;
+    if (pc->endpoint < 0) {
+        WinHttpSetOption(pc->hRequest, WINHTTP_OPTION_CONNECT_TIMEOUT, &timeout, sizeof(timeout));
+    }
+    WinHttpSetOption(pc->hRequest, WINHTTP_OPTION_RECEIVE_TIMEOUT, &timeout, sizeof(timeout));
+    WinHttpSetOption(pc->hRequest, WINHTTP_OPTION_SEND_TIMEOUT, &timeout, sizeof(timeout));
+    if (pc->desc->credentials) {
+        // Credentials from the URL are for its host only: a redirect must not carry them elsewhere
+        DWORD feature = WINHTTP_DISABLE_REDIRECTS;
+        WinHttpSetOption(pc->hRequest, WINHTTP_OPTION_DISABLE_FEATURE, &feature, sizeof(feature));
+    }
+
+    // Compressed bodies: WinHTTP inflates them itself where it can (Windows 8.1
+    // and later); elsewhere ask for them explicitly and inflate them in HttpCheckBody
+    pc->winhttpInflates = FALSE;
+    if (configAcceptCompression && g_winhttpDecompression != 0) {
+        DWORD decompression = WINHTTP_DECOMPRESSION_FLAG_ALL;
+        pc->winhttpInflates = WinHttpSetOption(pc->hRequest, WINHTTP_OPTION_DECOMPRESSION,
+                                               &decompression, sizeof(decompression));
+        if (InterlockedExchange(&g_winhttpDecompression, pc->winhttpInflates ? 1 : 0) < 0) {
+            LogInfo("Compressed responses are decompressed by %s.",
+                    pc->winhttpInflates ? "WinHTTP" : "the built-in inflater");
         }
+    }
 
-        // Connect
-        if (!networkError) {
-            hConnect = WinHttpConnect(hSession, wHost, (INTERNET_PORT)port, 0);
-            if (!hConnect) {
-                sprintf(errorMsg, "Connection failed: %lu", GetLastError());
-                LogMessage("ERROR: %s (attempt %d/%d)", errorMsg, attempt, maxAttempts);
-                networkError = TRUE;
-            }
+    // The descriptor's fixed headers, then a conditional request when the last
+    // full response carried validators
+    wchar_t headers[1024];
+    wcscpy(headers, pc->desc->headers);
+    const HttpValidators* v = &pc->cached.validators;
+    if (v->etag[0]) {
+        size_t used = wcslen(headers);
+        swprintf(headers + used, 1024 - used, L"If-None-Match: %s\r\n", v->etag);
+    }
+    if (v->lastModified[0]) {
+        size_t used = wcslen(headers);
+        swprintf(headers + used, 1024 - used, L"If-Modified-Since: %s\r\n", v->lastModified);
+    }
+    if (configAcceptCompression && !pc->winhttpInflates) {
+        size_t used = wcslen(headers);
+        swprintf(headers + used, 1024 - used, L"Accept-Encoding: gzip, deflate\r\n");
+    }
+
+    // The check is the request context; completions may run before this returns
+    decoder_begin(&pc->decoder, &pc->decoderConfig);
+    EndInflate(pc);
+    pc->newConnection = FALSE;
+    memset(pc->marks, 0, sizeof(pc->marks));
+    memset(&pc->received, 0, sizeof(pc->received));
+    if (!WinHttpSendRequest(pc->hRequest, headers[0] ? headers : WINHTTP_NO_ADDITIONAL_HEADERS,
+                            headers[0] ? (DWORD)-1L : 0, WINHTTP_NO_REQUEST_DATA, 0, 0, (DWORD_PTR)pc)) {
+        return HttpCheckError(ev, "Request failed");
+    }
+    return CHECK_OP_PENDING;
+}
+
+static int HttpCheckReceive(CheckRequest* req, CheckEvent* ev) {
+    PendingCheck* pc = (PendingCheck*)req->context;
+    if (!WinHttpReceiveResponse(pc->hRequest, NULL)) return HttpCheckError(ev, "No response");
+    return CHECK_OP_PENDING;
+}
+
+static int HttpCheckQueryData(CheckRequest* req, CheckEvent* ev) {
+    PendingCheck* pc = (PendingCheck*)req->context;
+    if (!WinHttpQueryDataAvailable(pc->hRequest, NULL)) return HttpCheckError(ev, NULL);
+    return CHECK_OP_PENDING;
+}
+
+static int HttpCheckRead(CheckRequest* req, char* buf, size_t len, CheckEvent* ev) {
+    PendingCheck* pc = (PendingCheck*)req->context;
+    if (!WinHttpReadData(pc->hRequest, buf, (DWORD)len, NULL)) return HttpCheckError(ev, NULL);
+    return CHECK_OP_PENDING;
+}
+
+// Keeps inflated bytes and feeds them to the decoder as they come out
+static int HttpCheckInflated(void* ctx, const char* data, size_t len) {
+    PendingCheck* pc = (PendingCheck*)ctx;
+    check_buffer_append(pc->inflated, data, len);
+    return decoder_feed(&pc->decoder, data, len);
+}
+
+// Decodes the body as it streams in and stops the download once the verdict is known
+static int HttpCheckBody(CheckRequest* req, const char* data, size_t len) {
+    PendingCheck* pc = (PendingCheck*)req->context;
+    pc->wireBytes += (unsigned)len;
+    if (pc->inflateError) return 1;
+    if (!pc->inflating) return decoder_feed(&pc->decoder, data, len);
+
+    switch (inflate_feed(&pc->inflater, data, len, HttpCheckInflated, pc)) {
+        case INFLATE_ERROR:
+            pc->inflateError = pc->inflater.error;
+            return 1;
+        case INFLATE_STOPPED:
+            return 1;
+        case INFLATE_DONE:
+            pc->inflateDone = TRUE;
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+// The timer can fire before CreateTimerQueueTimer has returned its handle.
+// Whichever side sees the other's mark resumes the check, so the check is
+// never touched once it may have finished and the handle is always deleted.
+static VOID CALLBACK HttpCheckRetryTimer(PVOID param, BOOLEAN timerFired) {
+    UNREFERENCED_PARAMETER(timerFired);
+    PendingCheck* pc = (PendingCheck*)param;
+
+    HANDLE timer = InterlockedExchangePointer((PVOID volatile*)&pc->retryTimer, RETRY_TIMER_FIRED);
+    if (!timer) return;   // Not published yet: HttpCheckWaitRetry resumes the check
+    pc->retryTimer = NULL;
+    DeleteTimerQueueTimer(NULL, timer, NULL);
+
+    CheckEvent ev = {0};
+    ev.type = CHECK_EV_RETRY_TIMER;
+    check_step(&pc->check, &ev);
+}
+
+static int HttpCheckWaitRetry(CheckRequest* req, unsigned delayMs, CheckEvent* ev) {
+    PendingCheck* pc = (PendingCheck*)req->context;
+
+    // Full jitter: anywhere up to a ceiling that doubles per failed attempt, so
+    // clients that failed together do not retry together
+    delayMs = backoff_jitter(delayMs, (unsigned)configRetryMaxDelayMs, req->attempt - 1, &pc->rng);
+    if (delayMs < CHECK_RETRY_MIN_DELAY_MS) delayMs = CHECK_RETRY_MIN_DELAY_MS;
+
+    if (pc->endpoint >= 0) {
+        LogError("ERROR: %s (attempt %d/%d)", req->errorMessage, req->attempt, req->maxAttempts);
+        LogWarn("Network error on attempt %d/%d - retrying in %u ms...",
+                req->attempt, req->maxAttempts, delayMs);
+    }
+
+    // No thread sleeps through the delay: a one-shot timer resumes the check
+    HANDLE timer = NULL;
+    if (!g_workersStopping &&
+        CreateTimerQueueTimer(&timer, NULL, HttpCheckRetryTimer, pc, delayMs, 0, WT_EXECUTEONLYONCE)) {
+        if (InterlockedCompareExchangePointer((PVOID volatile*)&pc->retryTimer, timer, NULL) == NULL) {
+            return CHECK_OP_PENDING;
         }
+        // Already fired and left the check to us
+        DeleteTimerQueueTimer(NULL, timer, NULL);
+        pc->retryTimer = NULL;
+    }
+    ev->type = CHECK_EV_RETRY_TIMER;
+    return CHECK_OP_DONE;
+}
 
-        // Create request
-        if (!networkError) {
-            DWORD flags = isHttps ? WINHTTP_FLAG_SECURE : 0;
-            hRequest = WinHttpOpenRequest(hConnect, L"GET", wPath,
-                                         NULL, WINHTTP_NO_REFERER,
-                                         WINHTTP_DEFAULT_ACCEPT_TYPES, flags);
-            if (!hRequest) {
-                sprintf(errorMsg, "Request creation failed: %lu", GetLastError());
-                LogMessage("ERROR: %s (attempt %d/%d)", errorMsg, attempt, maxAttempts);
-                networkError = TRUE;
-            }
+static void HttpCheckClose(CheckRequest* req) {
+    PendingCheck* pc = (PendingCheck*)req->context;
+    if (pc->hRequest) {
+        MarkPhase(pc, PHASE_MARK_DONE);
+        // Detach first so no late notification reaches a check that has moved on
+        WinHttpSetStatusCallback(pc->hRequest, NULL, 0, 0);
+        WinHttpCloseHandle(pc->hRequest);
+        pc->hRequest = NULL;
+    }
+}
+
+static void HttpCheckFinished(CheckRequest* req) {
+    QueueCompletedCheck((PendingCheck*)req->context);
+}
+
+static const CheckTransport g_httpTransport = {
+    HttpCheckSend,
+    HttpCheckReceive,
+    HttpCheckQueryData,
+    HttpCheckRead,
+    HttpCheckWaitRetry,
+    HttpCheckClose,
+    HttpCheckFinished
+};
+
+static PendingCheck* NewPendingCheck(int endpoint, LONG generation, EndpointDescriptor* desc) {
+    PendingCheck* pc = (PendingCheck*)calloc(1, sizeof(PendingCheck));
+    if (!pc) return NULL;
+    pc->endpoint = endpoint;
+    pc->generation = generation;
+    LARGE_INTEGER seed;
+    QueryPerformanceCounter(&seed);
+    pc->rng = ((unsigned)seed.QuadPart ^ ((unsigned)endpoint * 2654435761u)) | 1;
+
+    // Reuse the endpoint's parked response buffer when there is one
+    if (endpoint >= 0) {
+        pc->body = (CheckBuffer*)InterlockedExchangePointer((PVOID*)&g_endpoints[endpoint].responseBuffer, NULL);
+    }
+    if (!pc->body) {
+        pc->body = (CheckBuffer*)malloc(sizeof(CheckBuffer));
+        if (!pc->body) {
+            free(pc);
+            return NULL;
         }
+        check_buffer_init(pc->body, 0);
+    }
+    pc->body->max = (size_t)configMaxResponseKB * 1024;
+    pc->desc = RetainEndpointDescriptor(desc);
+    return pc;
+}
+
+static void FreeResponseBuffer(CheckBuffer* buf) {
+    if (!buf) return;
+    check_buffer_free(buf);
+    free(buf);
+}
+
+static void FreePendingCheck(PendingCheck* pc) {
+    ReleaseHttpConnection(pc->conn);
+    ReleaseEndpointDescriptor(pc->desc);
+    EndInflate(pc);
+    FreeResponseBuffer(pc->inflated);
 
-        // Set timeouts
-        if (!networkError) {
-            int timeout = 10000;
-            WinHttpSetOption(hRequest, WINHTTP_OPTION_RECEIVE_TIMEOUT, &timeout, sizeof(timeout));
-            WinHttpSetOption(hRequest, WINHTTP_OPTION_SEND_TIMEOUT, &timeout, sizeof(timeout));
+    // Park the buffer for the endpoint's next check unless another one got there first
+    if (pc->endpoint < 0 ||
+        InterlockedCompareExchangePointer((PVOID*)&g_endpoints[pc->endpoint].responseBuffer, pc->body, NULL) != NULL) {
+        FreeResponseBuffer(pc->body);
+    }
+    free(pc);
+}
+
+// Keeps a full response's verdict with its validators for the endpoint's next conditional request
+static void RememberVerdict(const PendingCheck* pc, ApiResult result, const char* message) {
+    MonitorEndpoint* ep = &g_endpoints[pc->endpoint];
+    EnterCriticalSection(&monitorCriticalSection);
+    if (ep->generation == pc->generation) {
+        memset(&ep->cached, 0, sizeof(ep->cached));
+        if (pc->received.etag[0] || pc->received.lastModified[0]) {
+            ep->cached.validators = pc->received;
+            ep->cached.result = result;
+            strncpy(ep->cached.message, message, sizeof(ep->cached.message) - 1);
+            ep->cached.bytes = WireBytes(pc);
         }
+    }
+    LeaveCriticalSection(&monitorCriticalSection);
+}
 
-        // Send request
-        if (!networkError) {
-            if (!WinHttpSendRequest(hRequest, WINHTTP_NO_ADDITIONAL_HEADERS, 0,
-                                   WINHTTP_NO_REQUEST_DATA, 0, 0, 0)) {
-                sprintf(errorMsg, "Request failed: %lu", GetLastError());
-                LogMessage("ERROR: %s (attempt %d/%d)", errorMsg, attempt, maxAttempts);
-                networkError = TRUE;
-            }
+// Drops the endpoint's validators so the next poll downloads the document again
+static void ForgetVerdict(const PendingCheck* pc) {
+    MonitorEndpoint* ep = &g_endpoints[pc->endpoint];
+    EnterCriticalSection(&monitorCriticalSection);
+    if (ep->generation == pc->generation) memset(&ep->cached, 0, sizeof(ep->cached));
+    LeaveCriticalSection(&monitorCriticalSection);
+}
+
+// Runs on a worker thread once a check has finished: evaluate it and post the result to the UI thread
+static void CompleteCheck(PendingCheck* pc) {
+    CheckRequest* req = &pc->check;
+    const CheckBuffer* content = pc->inflating ? pc->inflated : req->body;   // Inflated when compressed
+    const char* body = content->data ? content->data : "";
+
+    if (pc->endpoint < 0) {
+        // Validation: the URL must answer 2xx with a response its decoder understands
+        LRESULT valid = FALSE;
+        if (req->outcome == CHECK_OUTCOME_BODY && !pc->inflateError) {
+            char message[256];
+            valid = decoder_finish(&pc->decoder, req->statusCode, content->data, content->len,
+                                   message, sizeof(message), NULL) != DECODE_INVALID;
         }
 
-        // Receive response
-        if (!networkError) {
-            if (!WinHttpReceiveResponse(hRequest, NULL)) {
-                sprintf(errorMsg, "No response: %lu", GetLastError());
-                LogMessage("ERROR: %s (attempt %d/%d)", errorMsg, attempt, maxAttempts);
-                networkError = TRUE;
-            }
+        // Only post result if this generation is still current
+        if (InterlockedCompareExchange(&g_validateGeneration, pc->generation, pc->generation) == pc->generation) {
+            PostMessage(pc->hDlg, WM_VALIDATE_RESULT, (WPARAM)pc->generation, valid);
         }
+        FreePendingCheck(pc);
+        return;
+    }
 
-        // Check status code (only if we got a response)
-        DWORD statusCode = 0;
-        if (!networkError) {
-            DWORD size = sizeof(statusCode);
-            if (WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
-                                   NULL, &statusCode, &size, NULL)) {
-                if (statusCode != 200) {
-                    sprintf(errorMsg, "HTTP %lu", statusCode);
-                    LogMessage("ERROR: Received %s (attempt %d/%d), not retrying.", errorMsg, attempt, maxAttempts);
-                    finalResult = RESULT_ERROR;
-                    strncpy(finalMessage, errorMsg, sizeof(finalMessage) - 1);
-                    // Clean up handles
-                    WinHttpCloseHandle(hRequest);
-                    WinHttpCloseHandle(hConnect);
-                    WinHttpCloseHandle(hSession);
-                    break; // Don't retry on HTTP errors
-                }
+    ApiResult finalResult = RESULT_ERROR;
+    char finalMessage[256] = "Unknown error";
+
+    switch (req->outcome) {
+        case CHECK_OUTCOME_BODY: {
+            if (pc->inflateError) {
+                // A server answer, so retrying would not help
+                LogError("ERROR: Compressed response from %s could not be decoded: %s (attempt %d/%d).",
+                         pc->desc->url, pc->inflateError, req->attempt, req->maxAttempts);
+                finalResult = RESULT_INVALID;
+                snprintf(finalMessage, sizeof(finalMessage), "Invalid compressed response (%s)", pc->inflateError);
+                // Never decoded, so a 304 must not bring back the previous document's verdict
+                ForgetVerdict(pc);
+                break;
+            }
+            LogTrace("API response received (attempt %d/%d, %lu bytes%s%s): %.500s",
+                     req->attempt, req->maxAttempts, (unsigned long)content->len,
+                     pc->inflating ? ", inflated" : "",
+                     req->stoppedEarly ? ", stopped after the verdict" : "", body);
+            if (content->truncated) {
+                LogWarn("WARNING: Response from %s exceeded %lu KB and was truncated (see MaxResponseKB).",
+                        pc->desc->url, (unsigned long)(content->max / 1024));
+            }
+            if (req->readFailed) {
+                LogWarn("WARNING: Response from %s ended early (%s); judged on the %lu bytes received.",
+                        pc->desc->url, req->errorMessage, (unsigned long)content->len);
             }
+            ApiResponse apiResponse = {0};
+            DecodeResponse(&pc->decoder, req->statusCode, content, &apiResponse);
+            if (apiResponse.result == RESULT_FAIL) {
+                LogDebug("API returned 'fail' on attempt %d/%d - no further retries.", req->attempt, req->maxAttempts);
+            }
+            finalResult = apiResponse.result;
+            if (content->truncated && finalResult == RESULT_INVALID) {
+                // Make it obvious the verdict may have been cut off rather than missing
+                snprintf(finalMessage, sizeof(finalMessage), "%s (response truncated at %lu KB)",
+                         apiResponse.message, (unsigned long)(content->max / 1024));
+            } else {
+                strncpy(finalMessage, apiResponse.message, sizeof(finalMessage) - 1);
+            }
+            // A verdict stands in for the document on later 304s, so only keep one
+            // judged on all of it (or on as much as the decoder needed)
+            if (!req->readFailed && !content->truncated &&
+                (req->stoppedEarly || !pc->inflating || pc->inflateDone)) {
+                RememberVerdict(pc, finalResult, finalMessage);
+            } else {
+                ForgetVerdict(pc);
+            }
+            break;
         }
+        case CHECK_OUTCOME_NOT_MODIFIED:
+            if (pc->cached.validators.etag[0] || pc->cached.validators.lastModified[0]) {
+                // Same document as last time: same verdict, without downloading or parsing it
+                finalResult = pc->cached.result;
+                strncpy(finalMessage, pc->cached.message, sizeof(finalMessage) - 1);
+                LONG count = InterlockedIncrement(&g_notModifiedCount);
+                LONG64 saved = InterlockedAdd64(&g_notModifiedBytes, pc->cached.bytes);
+                LogDebug("API response not modified (attempt %d/%d): reused the cached verdict "
+                         "(%ld parse(s) and %lld bytes saved so far).",
+                         req->attempt, req->maxAttempts, count, saved);
+            } else {
+                LogError("ERROR: Received HTTP 304 without a conditional request (attempt %d/%d).",
+                         req->attempt, req->maxAttempts);
+                strncpy(finalMessage, "HTTP 304", sizeof(finalMessage) - 1);
+            }
+            break;
+        case CHECK_OUTCOME_HTTP_ERROR:
+            LogError("ERROR: Received %s (attempt %d/%d), not retrying.", req->errorMessage, req->attempt, req->maxAttempts);
+            strncpy(finalMessage, req->errorMessage, sizeof(finalMessage) - 1);
+            break;
+        default:
+            // All attempts exhausted
+            LogError("ERROR: %s (attempt %d/%d)", req->errorMessage, req->attempt, req->maxAttempts);
+            strncpy(finalMessage, req->errorMessage, sizeof(finalMessage) - 1);
+            break;
+    }
 
-        // Read response data if no network error and status is 200
-        if (!networkError && statusCode == 200) {
-            DWORD totalSize = 0;
-            DWORD downloaded = 0;
+    TSeriesSample sample;
+    MeasurePoll(pc, finalResult, &sample);
+    PhaseTimings timings;
+    MeasurePhases(pc, &timings);
+    PostPollResult(pc->endpoint, pc->generation, pc->seq, finalResult, finalMessage, &sample, &timings,
+                   pc->retryAfterMs, WireBytes(pc), BodyBytes(pc), pc->connectionReused);
+    char phases[128];
+    FormatPhaseTimings(&timings, phases, sizeof(phases));
+    LogDebug("API check of %s completed with result: %d%s%s", pc->desc->url, finalResult,
+             phases[0] ? ", last attempt took " : "", phases);
+    FreePendingCheck(pc);
+}
 
-            do {
-                DWORD sizeAvailable = 0;
-                if (!WinHttpQueryDataAvailable(hRequest, &sizeAvailable)) break;
-                if (sizeAvailable == 0) break;
+// --- Configuration dialog ---
 
-                char* buffer = malloc(sizeAvailable + 1);
-                if (!WinHttpReadData(hRequest, buffer, sizeAvailable, &downloaded)) {
-                    free(buffer);
-                    break;
-                }
-                buffer[downloaded] = '\0';
+// Helper: start an asynchronous single-attempt check of the given URL and response format
+static void StartValidation(HWND hDlg, const char* url, const char* format) {
+    LONG gen = InterlockedIncrement(&g_validateGeneration);
+    DecoderConfig dc;
+    if (!decoder_parse(format, &dc)) {
+        PostMessage(hDlg, WM_VALIDATE_RESULT, (WPARAM)gen, FALSE);
+        return;
+    }
+    // Cracked the same way as a configured endpoint, so what validates is what gets polled
+    EndpointDescriptor* desc = CreateEndpointDescriptor(url);
+    if (!desc || desc->error) {
+        if (desc) LogDebug("Validation of %s rejected the URL: %s.", url, desc->error);
+        ReleaseEndpointDescriptor(desc);
+        PostMessage(hDlg, WM_VALIDATE_RESULT, (WPARAM)gen, FALSE);
+        return;
+    }
+    PendingCheck* pc = NewPendingCheck(-1, gen, desc);
+    ReleaseEndpointDescriptor(desc);
+    if (!pc) {
+        // The dialog waits for a result, so report one
+        LogError("ERROR: Out of memory starting validation of %s", url);
+        PostMessage(hDlg, WM_VALIDATE_RESULT, (WPARAM)gen, FALSE);
+        return;
+    }
+    pc->decoderConfig = dc;
+    pc->hDlg = hDlg;
+    pc->timeoutMs = 5000;
+    check_init(&pc->check, &g_httpTransport, pc, pc->body, 1, 0);
+    pc->check.onBody = HttpCheckBody;
+    check_start(&pc->check);
+}
 
-                if (totalSize + downloaded < sizeof(response) - 1) {
-                    strcat(response, buffer);
-                    totalSize += downloaded;
-                }
-                free(buffer);
-            } while (downloaded > 0);
+void ShowConfigDialog(HWND hwndParent) {
+    (void)hwndParent;
+    ShowWebViewDialog("config", 480, 380);
+}
 
-            LogMessage("API response received (attempt %d/%d): %.500s", attempt, maxAttempts, response);
-        }
+// --- Timer and refresh ---
 
-        // Clean up handles
-        if (hRequest) WinHttpCloseHandle(hRequest);
-        if (hConnect) WinHttpCloseHandle(hConnect);
-        if (hSession) WinHttpCloseHandle(hSession);
-
-        // Check if we should retry
-        if (networkError) {
-            if (attempt < maxAttempts) {
-                LogMessage("Network error on attempt %d/%d - retrying in 2 seconds...", attempt, maxAttempts);
-                Sleep(2000); // Wait before retry
-                continue; // Retry loop
-            } else {
-                // All attempts exhausted
-                strncpy(finalMessage, errorMsg, sizeof(finalMessage) - 1);
-                finalResult = RESULT_ERROR;
-                break;
-            }
+// Arms the refresh timer for the earliest deadline; UI thread only
+static void ArmRefreshTimer(void) {
+    ULONGLONG due;
+    if (!g_hwnd || !sched_next(&g_scheduler, &due)) {
+        if (timerRefresh) KillTimer(g_hwnd, 1);
+        timerRefresh = 0;
+        g_timerDue = 0;
+        return;
+    }
+    if (timerRefresh && due == g_timerDue) return;
+
+    ULONGLONG now = GetTickCount64();
+    ULONGLONG delay = due > now ? due - now : 0;
+    if (delay < USER_TIMER_MINIMUM) delay = USER_TIMER_MINIMUM;
+    if (delay > USER_TIMER_MAXIMUM) delay = USER_TIMER_MAXIMUM;
+    timerRefresh = SetTimer(g_hwnd, 1, (UINT)delay, RefreshTimer);
+    g_timerDue = due;
+}
+
+// Sets when the endpoint is checked next; UI thread only
+void ScheduleEndpoint(int index, ULONGLONG due) {
+    sched_set(&g_scheduler, index, due);
+    ArmRefreshTimer();
+}
+
+// Applies the interval the endpoint's latest result calls for; UI thread only.
+// Fixed delay counts the interval from now, when the result arrived. Fixed
+// rate keeps the deadline set when the check was dispatched, and only moves
+// onto a new grid (from the latest deadline) when the interval changes.
+void SetRefreshInterval(int index, int seconds) {
+    MonitorEndpoint* ep = &g_endpoints[index];
+    ULONGLONG now = GetTickCount64();
+    ULONGLONG interval = (ULONGLONG)seconds * 1000;
+
+    if (configScheduleMode == SCHED_FIXED_DELAY) {
+        ep->activeInterval = seconds;
+        ScheduleEndpoint(index, now + interval);
+    } else if (ep->activeInterval != seconds) {
+        ep->activeInterval = seconds;
+        ScheduleEndpoint(index, sched_next_rate(ep->lastDue, interval, now, NULL));
+    }
+}
+
+// Picks the endpoint's next check from its latest result; UI thread only.
+// Healthy endpoints go back to their configured interval. Unhealthy ones are
+// checked again after ACCELERATED_INTERVAL, then after a random delay whose
+// ceiling doubles with every further failure up to BackoffMaxSeconds, and
+// never sooner than a 429/503 response's Retry-After. Consecutive errors open
+// the circuit breaker: no checks for BackoffMaxSeconds, then one probe.
+// Degraded endpoints still answer, so they are not backed off; they are
+// checked at least every DEGRADED_INTERVAL so recovery shows within a window.
+void ScheduleNextCheck(int index, ApiResult result, unsigned retryAfterMs) {
+    MonitorEndpoint* ep = &g_endpoints[index];
+    BreakerChange change = breaker_record(&ep->breaker, configBreakerThreshold, result == RESULT_ERROR);
+    if (change != BREAKER_UNCHANGED) {
+        EnterCriticalSection(&monitorCriticalSection);
+        ep->singleAttempt = (ep->breaker.state != BREAKER_CLOSED);
+        LeaveCriticalSection(&monitorCriticalSection);
+    }
+    if (change == BREAKER_CLOSED_AGAIN) {
+        LogInfo("Circuit breaker closed for %s.", ep->url);
+    }
+
+    if (result == RESULT_SUCCESS) {
+        ep->failures = 0;
+        SetRefreshInterval(index, ep->refreshInterval);
+        return;
+    }
+    if (result == RESULT_DEGRADED) {
+        ep->failures = 0;
+        SetRefreshInterval(index, ep->refreshInterval < DEGRADED_INTERVAL ? ep->refreshInterval : DEGRADED_INTERVAL);
+        return;
+    }
+
+    ep->failures++;
+    ULONGLONG floorMs = (ULONGLONG)ACCELERATED_INTERVAL * 1000;
+    ULONGLONG capMs = (ULONGLONG)configBackoffMaxSeconds * 1000;
+    ULONGLONG delay = floorMs;
+    if (ep->failures > 1 && capMs > floorMs) {
+        delay += backoff_jitter((unsigned)floorMs, (unsigned)(capMs - floorMs), ep->failures - 2, &g_backoffRng);
+    }
+    if (ep->breaker.state == BREAKER_OPEN && delay < capMs) delay = capMs;
+    if (change == BREAKER_OPENED) {
+        LogWarn("Circuit breaker opened for %s after %d consecutive error(s); probing again in %llu s.",
+                ep->url, ep->breaker.errors, delay / 1000);
+    }
+    if (retryAfterMs > delay) {
+        delay = retryAfterMs;
+        LogInfo("Honouring Retry-After from %s: next check in %llu s.", ep->url, delay / 1000);
+    }
+
+    // Backoff counts from the failure, whatever the schedule mode
+    ep->activeInterval = (int)((delay + 999) / 1000);
+    ScheduleEndpoint(index, GetTickCount64() + delay);
+}
+
+// Queues an endpoint's check; an open breaker lets it through as its probe
+static BOOL QueueScheduledCheck(int index) {
+    MonitorEndpoint* ep = &g_endpoints[index];
+    if (!QueueEndpointCheck(index)) return FALSE;
+    if (breaker_probe(&ep->breaker)) {
+        LogInfo("Circuit breaker half-open for %s: sending one probe.", ep->url);
+    }
+    return TRUE;
+}
+
+// Logs how closely the schedule was kept and stops the refresh timer
+void StopScheduler(HWND hwnd) {
+    if (timerRefresh) KillTimer(hwnd, 1);
+    timerRefresh = 0;
+    if (g_scheduledRuns > 0) {
+        LogInfo("Scheduler: %llu deadline(s) reached, %llu ms late on average (max %llu ms), "
+                "%llu period(s) missed, %ld tick(s) skipped while polling.",
+                g_scheduledRuns, g_scheduleLateTotalMs / g_scheduledRuns, g_scheduleLateMaxMs,
+                g_scheduleMissed, g_skippedTickCount);
+    }
+    // Results still to be applied find an empty scheduler and leave the timer off
+    sched_free(&g_scheduler);
+}
+
+// Manual refresh: check every endpoint now; one already being polled keeps its poll
+void RefreshStatus() {
+    LogTrace("RefreshStatus() called.");
+    int joined = 0;
+    for (int i = 0; i < g_endpointCount; i++) {
+        if (!QueueScheduledCheck(i)) joined++;
+    }
+    if (joined > 0) {
+        g_joinedRefreshCount += joined;
+        LogDebug("Manual refresh joined %d poll(s) already in flight (%ld so far).", joined, g_joinedRefreshCount);
+    }
+}
+
+// --- Worker pool ---
+
+// Queues a check unless the endpoint is already queued or being polled, so each
+// endpoint has at most one request outstanding and the queue can never overflow.
+// Returns FALSE if no check was queued.
+BOOL QueueEndpointCheck(int index) {
+    if (index < 0 || index >= g_endpointCount) return FALSE;
+    if (InterlockedCompareExchange(&g_endpoints[index].inFlight, 1, 0) != 0) return FALSE;
+
+    EnterCriticalSection(&workQueueCriticalSection);
+    g_workQueue[(g_workQueueHead + g_workQueueCount) % MAX_ENDPOINTS] = index;
+    g_workQueueCount++;
+    LeaveCriticalSection(&workQueueCriticalSection);
+    WakeConditionVariable(&workQueueCondition);
+    return TRUE;
+}
+
+// Hands a finished check to the pool; dropped once the pool is shutting down
+void QueueCompletedCheck(PendingCheck* pc) {
+    EnterCriticalSection(&workQueueCriticalSection);
+    if (g_workersStopping) {
+        LeaveCriticalSection(&workQueueCriticalSection);
+        FreePendingCheck(pc);
+        return;
+    }
+    pc->next = NULL;
+    if (g_completedTail) g_completedTail->next = pc;
+    else g_completedHead = pc;
+    g_completedTail = pc;
+    LeaveCriticalSection(&workQueueCriticalSection);
+    WakeConditionVariable(&workQueueCondition);
+}
+
+// Workers only start checks and evaluate finished ones; network waits happen in WinHTTP
+DWORD WINAPI WorkerThread(LPVOID param) {
+    UNREFERENCED_PARAMETER(param);
+
+    for (;;) {
+        EnterCriticalSection(&workQueueCriticalSection);
+        while (g_workQueueCount == 0 && !g_completedHead && !g_workersStopping) {
+            SleepConditionVariableCS(&workQueueCondition, &workQueueCriticalSection, INFINITE);
         }
+        if (g_workersStopping) {
+            LeaveCriticalSection(&workQueueCriticalSection);
+            break;
+        }
+        if (g_completedHead) {
+            PendingCheck* pc = g_completedHead;
+            g_completedHead = pc->next;
+            if (!g_completedHead) g_completedTail = NULL;
+            LeaveCriticalSection(&workQueueCriticalSection);
+            CompleteCheck(pc);
+            continue;
+        }
+        int index = g_workQueue[g_workQueueHead];
+        g_workQueueHead = (g_workQueueHead + 1) % MAX_ENDPOINTS;
+        g_workQueueCount--;
+        LeaveCriticalSection(&workQueueCriticalSection);
 
-        // Parse the XML response
-        ApiResponse apiResponse = {0};
-        ParseXmlResponse(response, &apiResponse);
+        CheckEndpoint(index);
+    }
+    return 0;
+}
 
-        // If API returns "fail", don't retry further
-        if (apiResponse.result == RESULT_FAIL) {
-            LogMessage("API returned 'fail' on attempt %d/%d - no further retries.", attempt, maxAttempts);
-            finalResult = RESULT_FAIL;
-            strncpy(finalMessage, apiResponse.message, sizeof(finalMessage) - 1);
-            break; // Exit retry loop
+void StartWorkerPool(void) {
+    g_workersStopping = FALSE;
+    for (int i = 0; i < WORKER_POOL_SIZE; i++) {
+        g_workerThreads[i] = CreateThread(NULL, 0, WorkerThread, NULL, 0, NULL);
+        if (!g_workerThreads[i]) {
+            LogError("ERROR: Failed to create worker thread %d. Error: %lu", i, GetLastError());
         }
+    }
+    LogInfo("Worker pool started with %d threads (response scanner: %s).",
+            WORKER_POOL_SIZE, xml_status_simd_name());
+}
 
-        // For success or invalid XML, use the result and exit loop
-        finalResult = apiResponse.result;
-        strncpy(finalMessage, apiResponse.message, sizeof(finalMessage) - 1);
-        break; // Success or non-retryable error
+void StopWorkerPool(void) {
+    EnterCriticalSection(&workQueueCriticalSection);
+    g_workersStopping = TRUE;
+    g_workQueueCount = 0;
+    LeaveCriticalSection(&workQueueCriticalSection);
+    WakeAllConditionVariable(&workQueueCondition);
+
+    // Closing the session aborts checks still in flight inside WinHTTP
+    CloseHttpSession();
+
+    for (int i = 0; i < WORKER_POOL_SIZE; i++) {
+        if (!g_workerThreads[i]) continue;
+        WaitForSingleObject(g_workerThreads[i], 3000);
+        CloseHandle(g_workerThreads[i]);
+        g_workerThreads[i] = NULL;
     }
 
-    // Update the UI with final result
-    UpdateStatus(finalResult, finalMessage);
+    // Finished checks nobody evaluated
+    EnterCriticalSection(&workQueueCriticalSection);
+    PendingCheck* pc = g_completedHead;
+    g_completedHead = g_completedTail = NULL;
+    LeaveCriticalSection(&workQueueCriticalSection);
+    while (pc) {
+        PendingCheck* next = pc->next;
+        FreePendingCheck(pc);
+        pc = next;
+    }
+    for (int i = 0; i < MAX_ENDPOINTS; i++) {
+        FreeResponseBuffer((CheckBuffer*)InterlockedExchangePointer((PVOID*)&g_endpoints[i].responseBuffer, NULL));
+    }
+    LogInfo("Worker pool stopped.");
+}
 
-    // Clean up parameters
-    free(params);
-    LogMessage("API refresh thread completed with result: %d", finalResult);
-    return 0;
+// Turns a decoded response into a status
+void DecodeResponse(DecoderState* decoder, unsigned long statusCode, const CheckBuffer* body, ApiResponse* response) {
+    const char* reason = NULL;
+    const char* name = decoder_name(decoder->config);
+    DecodeVerdict verdict = decoder_finish(decoder, statusCode, body->data, body->len,
+                                           response->message, sizeof(response->message), &reason);
+
+    switch (verdict) {
+        case DECODE_SUCCESS:
+            response->result = RESULT_SUCCESS;
+            LogDebug("Response decoded (%s): result=success, message=%s", name, response->message);
+            break;
+        case DECODE_FAIL:
+            response->result = RESULT_FAIL;
+            LogDebug("Response decoded (%s): result=fail, message=%s", name, response->message);
+            break;
+        default:
+            response->result = RESULT_INVALID;
+            LogError("ERROR: Invalid %s response - %s. Raw: %.100s", name, reason ? reason : "unknown",
+                     body->data ? body->data : "");
+            break;
+    }
+}
+
+// Starts a check (with retries) for an endpoint and returns without waiting for it
+void CheckEndpoint(int index) {
+    MonitorEndpoint* ep = &g_endpoints[index];
+
+    // Snapshot the slot so a concurrent reconfiguration can be detected
+    char url[512];
+    DecoderConfig decoderConfig;
+    EnterCriticalSection(&monitorCriticalSection);
+    LONG generation = ep->generation;
+    ULONGLONG seq = ++ep->pollsStarted;
+    int attempts = ep->singleAttempt ? 1 : CHECK_MAX_ATTEMPTS;
+    CachedVerdict cached = ep->cached;
+    strncpy(url, ep->url, sizeof(url) - 1);
+    url[sizeof(url) - 1] = '\0';
+    EndpointDescriptor* desc = RetainEndpointDescriptor(ep->descriptor);
+    decoderConfig = ep->decoder;
+    LeaveCriticalSection(&monitorCriticalSection);
+
+    // Validate API URL
+    if (strlen(url) == 0) {
+        LogError("ERROR: API URL is not configured (endpoint %d).", index);
+        PostPollResult(index, generation, seq, RESULT_ERROR, "API URL not configured", NULL, NULL, 0, 0, 0, FALSE);
+        ReleaseEndpointDescriptor(desc);
+        return;
+    }
+    if (!desc || desc->error) {
+        char message[256];
+        snprintf(message, sizeof(message), "Invalid API URL (%s)", desc ? desc->error : "out of memory");
+        LogError("ERROR: %s: %s", message, url);
+        PostPollResult(index, generation, seq, RESULT_ERROR, message, NULL, NULL, 0, 0, 0, FALSE);
+        ReleaseEndpointDescriptor(desc);
+        return;
+    }
+
+    PendingCheck* pc = NewPendingCheck(index, generation, desc);
+    ReleaseEndpointDescriptor(desc);
+    if (!pc) {
+        LogError("ERROR: Out of memory starting check of %s", url);
+        InterlockedExchange(&ep->inFlight, 0);
+        return;
+    }
+    pc->decoderConfig = decoderConfig;
+    pc->seq = seq;
+    pc->cached = cached;
+    pc->timeoutMs = 10000;
+    check_init(&pc->check, &g_httpTransport, pc, pc->body, attempts, CHECK_RETRY_DELAY_MS);
+    pc->check.onBody = HttpCheckBody;
+    QueryPerformanceCounter(&pc->started);
+    check_start(&pc->check);
+}
+
+// Posts a finished poll for the UI thread; safe on any thread
+void PostPollResult(int index, LONG generation, ULONGLONG seq, ApiResult result, const char* message,
+                    const TSeriesSample* sample, const PhaseTimings* timings, unsigned retryAfterMs,
+                    unsigned wireBytes, unsigned bodyBytes, BOOL connectionReused) {
+    PollResult* r = (PollResult*)calloc(1, sizeof(PollResult));
+    if (!r) {
+        LogError("ERROR: Out of memory posting the result of endpoint %d.", index);
+        InterlockedExchange(&g_endpoints[index].inFlight, 0);
+        return;
+    }
+    r->endpoint = index;
+    r->generation = generation;
+    r->seq = seq;
+    r->result = result;
+    strncpy(r->message, message ? message : "", sizeof(r->message) - 1);
+    if (sample) r->sample = *sample;
+    if (timings) r->timings = *timings;
+    r->retryAfterMs = retryAfterMs;
+    r->wireBytes = wireBytes;
+    r->bodyBytes = bodyBytes;
+    r->connectionReused = connectionReused;
+
+    // Only the first result of a batch needs to wake the UI thread
+    if (mailbox_post(&resultMailbox, &r->node) && g_hwnd) {
+        PostMessage(g_hwnd, WM_POLL_RESULTS, 0, 0);
+    }
+
+    // The endpoint can be polled again; a later check always has a higher seq
+    InterlockedExchange(&g_endpoints[index].inFlight, 0);
+}
+
+// Turns a success into RESULT_DEGRADED while DegradedPolls of the last
+// DegradedWindow answers took longer than DegradedLatencyMs; UI thread only.
+// Errors are left out of the window: their latency is a timeout or a refused
+// connection, not how fast the server answers.
+static void ApplyLatencySlo(MonitorEndpoint* ep, PollResult* r) {
+    if (configDegradedLatencyMs <= 0 || !r->sample.time || r->result == RESULT_ERROR) return;
+    int slow = slo_record(&ep->latency, r->sample.latencyMs, (unsigned)configDegradedLatencyMs);
+    if (r->result != RESULT_SUCCESS || slow < configDegradedPolls) return;
+
+    // Worded from the configuration only, not the server's message, so it
+    // stays the same while degraded and adds no history entry per slow poll
+    r->result = RESULT_DEGRADED;
+    snprintf(r->message, sizeof(r->message), "Slow: over %d ms in %d or more of the last %d polls",
+             configDegradedLatencyMs, configDegradedPolls, ep->latency.size);
+}
+
+// Applies posted results in the order their checks started; UI thread only.
+// A result is dropped if its endpoint was reconfigured or a later check of it
+// has already been applied.
+void DrainPollResults(void) {
+    MailboxNode* node = mailbox_take(&resultMailbox);
+    if (!node) return;
+
+    int applied = 0;
+    while (node) {
+        PollResult* r = (PollResult*)node;
+        node = node->next;
+        MonitorEndpoint* ep = &g_endpoints[r->endpoint];
+        if (ep->generation != r->generation) {
+            LogDebug("Discarding result for reconfigured endpoint %d.", r->endpoint);
+        } else if (r->seq <= ep->appliedSeq) {
+            g_staleResultCount++;
+            LogDebug("Discarding stale result #%llu for endpoint %d (#%llu already applied, %ld dropped so far).",
+                     r->seq, r->endpoint, ep->appliedSeq, g_staleResultCount);
+        } else {
+            ep->appliedSeq = r->seq;
+            if (r->sample.time) RecordPollSample(ep, &r->sample);
+            ep->wireBytes += r->wireBytes;
+            ep->bodyBytes += r->bodyBytes;
+            if (r->wireBytes < r->bodyBytes) {
+                LogDebug("Compressed response from %s: %u bytes for %u (%llu for %llu across polls).",
+                         ep->url, r->wireBytes, r->bodyBytes, ep->wireBytes, ep->bodyBytes);
+            }
+            ep->timings = r->timings;
+            ep->lastConnectionReused = r->connectionReused;
+            ApplyLatencySlo(ep, r);
+            UpdateStatus(r->endpoint, r->result, r->message);
+            ScheduleNextCheck(r->endpoint, r->result, r->retryAfterMs);
+            applied++;
+        }
+        free(r);
+    }
+
+    if (applied > 0) {
+        UpdateTrayStatus();
+        // Let an open History dialog pick up the batch's transitions
+        if (g_historyViewHwnd) webview_push_history_append();
+    }
 }
 
-void UpdateStatus(ApiResult result, const char* message) {
+// Applies one endpoint's result; UI thread only
+void UpdateStatus(int index, ApiResult result, const char* message) {
+    MonitorEndpoint* ep = &g_endpoints[index];
+    if (!message) message = "";
+
     // Detect status changes and record in history (skip if this is the first result)
-    BOOL resultChanged = (result != currentResult);
-    BOOL messageChanged = (message && strcmp(currentMessage, message) != 0);
-    if (currentResult != RESULT_NONE && (resultChanged || (messageChanged && result != RESULT_SUCCESS))) {
-        AddHistoryEntry(currentResult, currentMessage, result, message ? message : "");
+    BOOL resultChanged = (result != ep->result);
+    BOOL messageChanged = (strcmp(ep->message, message) != 0);
+    if (ep->result != RESULT_NONE && (resultChanged || (messageChanged && result != RESULT_SUCCESS))) {
+        AddHistoryEntry(ep->url, ep->result, ep->message, result, message, &ep->timings);
     }
 
-    currentResult = result;
-    if (message) {
-        strncpy(currentMessage, message, sizeof(currentMessage) - 1);
-        currentMessage[sizeof(currentMessage) - 1] = '\0';
+    ep->result = result;
+    strncpy(ep->message, message, sizeof(ep->message) - 1);
+    ep->message[sizeof(ep->message) - 1] = '\0';
+    GetSystemTime(&ep->lastUpdateTime);
+    lastUpdateTime = ep->lastUpdateTime;
+
+    // Unchanged results are routine; only changes are worth an info line
+    LogLevel statusLevel = (resultChanged || messageChanged) ? LOG_INFO : LOG_DEBUG;
+    switch (result) {
+        case RESULT_SUCCESS:
+            LogAt(statusLevel, "Status update: SUCCESS - %s (%s)", message, ep->url);
+            break;
+        case RESULT_FAIL:
+            LogAt(statusLevel, "Status update: FAIL - %s (%s)", message, ep->url);
+            break;
+        case RESULT_ERROR:
+            LogAt(statusLevel, "Status update: ERROR - %s (%s)", message, ep->url);
+            break;
+        case RESULT_INVALID:
+            LogAt(statusLevel, "Status update: INVALID - %s (%s)", message, ep->url);
+            break;
+        case RESULT_DEGRADED:
+            LogAt(statusLevel, "Status update: DEGRADED - %s (%s)", message, ep->url);
+            break;
+        default:
+            break;
+    }
+}
+
+// Shows the worst status across all endpoints in the tray; UI thread only
+void UpdateTrayStatus(void) {
+    int worst = 0;
+    for (int i = 1; i < g_endpointCount; i++) {
+        if (ResultSeverity(g_endpoints[i].result) > ResultSeverity(g_endpoints[worst].result)) worst = i;
     }
-    GetSystemTime(&lastUpdateTime);
+    currentEndpoint = worst;
+    currentResult = g_endpoints[worst].result;
+    strncpy(currentMessage, g_endpoints[worst].message, sizeof(currentMessage) - 1);
+    currentMessage[sizeof(currentMessage) - 1] = '\0';
+
     UpdateTooltip();
 
-    switch (result) {
+    switch (currentResult) {
         case RESULT_SUCCESS:
-            LogMessage("Status update: SUCCESS - %s", message ? message : "No message");
             SetIcon(hIconSuccess);
-            SetRefreshInterval(configRefreshInterval, FALSE);
             break;
         case RESULT_FAIL:
-            LogMessage("Status update: FAIL - %s", message ? message : "No message");
             SetIcon(hIconFail);
-            SetRefreshInterval(10, FALSE);
             break;
-        case RESULT_ERROR:
-            LogMessage("Status update: ERROR - %s", message ? message : "No message");
-            SetIcon(hIconEmpty);
-            SetRefreshInterval(10, FALSE);
+        case RESULT_DEGRADED:
+            SetIcon(hIconDegraded);
             break;
+        case RESULT_ERROR:
         case RESULT_INVALID:
-            LogMessage("Status update: INVALID - %s", message ? message : "No message");
             SetIcon(hIconEmpty);
-            SetRefreshInterval(10, FALSE);
+            break;
+        default:
             break;
     }
 }
 
 void UpdateTooltip() {
-    char tooltip[128];
-    if (currentResult == RESULT_ERROR) {
+    char tooltip[256];
+    if (g_endpointCount > 1 && currentResult != RESULT_SUCCESS && currentResult != RESULT_NONE) {
+        // Multi-endpoint summary: how many are unhealthy plus the worst message
+        int unhealthy = 0;
+        for (int i = 0; i < g_endpointCount; i++) {
+            if (g_endpoints[i].result != RESULT_SUCCESS && g_endpoints[i].result != RESULT_NONE) unhealthy++;
+        }
+        snprintf(tooltip, sizeof(tooltip), "%d of %d endpoints unhealthy\n%s",
+                 unhealthy, g_endpointCount, currentMessage);
+    } else if (currentResult == RESULT_ERROR) {
         strcpy(tooltip, "Unable to connect to API!");
     } else if (currentResult == RESULT_INVALID) {
         strcpy(tooltip, "API response incorrect!");
@@ -1575,7 +3476,12 @@ void UpdateTooltip() {
             snprintf(tooltip, sizeof(tooltip), "Updated %llu seconds ago", diff);
         }
 
-        if (strlen(currentMessage) > 0) {
+        if (g_endpointCount > 1) {
+            size_t remaining = sizeof(tooltip) - strlen(tooltip) - 1;
+            char summary[48];
+            snprintf(summary, sizeof(summary), "\nAll %d endpoints OK", g_endpointCount);
+            strncat(tooltip, summary, remaining);
+        } else if (strlen(currentMessage) > 0) {
             size_t remaining = sizeof(tooltip) - strlen(tooltip) - 1;
             strncat(tooltip, "\n", remaining);
             remaining = sizeof(tooltip) - strlen(tooltip) - 1;
@@ -1583,11 +3489,24 @@ void UpdateTooltip() {
         }
     }
 
-    if (strlen(tooltip) > 63) {
-        tooltip[60] = '.';
-        tooltip[61] = '.';
-        tooltip[62] = '.';
-        tooltip[63] = '\0';
+    // Where the shown endpoint's latest poll spent its time
+    if (g_endpointCount == 1 || (currentResult != RESULT_SUCCESS && currentResult != RESULT_NONE)) {
+        char phases[96];
+        FormatPhaseTimings(&g_endpoints[currentEndpoint].timings, phases, sizeof(phases));
+        if (phases[0]) {
+            size_t remaining = sizeof(tooltip) - strlen(tooltip) - 1;
+            strncat(tooltip, "\n", remaining);
+            remaining = sizeof(tooltip) - strlen(tooltip) - 1;
+            strncat(tooltip, phases, remaining);
+        }
+    }
+
+    size_t tipMax = sizeof(nid.szTip) - 1;
+    if (strlen(tooltip) > tipMax) {
+        tooltip[tipMax - 3] = '.';
+        tooltip[tipMax - 2] = '.';
+        tooltip[tipMax - 1] = '.';
+        tooltip[tipMax] = '\0';
     }
 
     strcpy(nid.szTip, tooltip);
@@ -1599,10 +3518,11 @@ void SetIcon(HICON icon) {
     const char* iconName = "Unknown";
     if (icon == hIconSuccess) iconName = "Success";
     else if (icon == hIconFail) iconName = "Fail";
+    else if (icon == hIconDegraded) iconName = "Degraded";
     else if (icon == hIconEmpty) iconName = "Empty";
     else if (icon == hIconBlank) iconName = "Blank";
 
-    LogMessage("SetIcon called: icon=%s", iconName);
+    LogTrace("SetIcon called: icon=%s", iconName);
 
     currentIcon = icon;
     iconVisible = TRUE;
@@ -1617,9 +3537,10 @@ void CALLBACK TooltipTimer(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime)
     UNREFERENCED_PARAMETER(idEvent);
     UNREFERENCED_PARAMETER(dwTime);
 
-    if (currentResult != RESULT_ERROR && currentResult != RESULT_INVALID) {
+    if (g_endpointCount > 1 || (currentResult != RESULT_ERROR && currentResult != RESULT_INVALID)) {
         UpdateTooltip();
     }
+    SyncHistoryJournal();
 }
 
 void CALLBACK RefreshTimer(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime) {
@@ -1628,8 +3549,48 @@ void CALLBACK RefreshTimer(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime)
     UNREFERENCED_PARAMETER(idEvent);
     UNREFERENCED_PARAMETER(dwTime);
 
-    LogMessage("Scheduled refresh timer fired.");
-    RefreshStatus();
+    // Queue every endpoint whose deadline has passed, then sleep until the next one.
+    // Fixed delay schedules a fallback here and moves it once the result arrives.
+    ULONGLONG now = GetTickCount64();
+    ULONGLONG deadline;
+    int index;
+    int due = 0;
+    g_timerDue = 0;
+    while ((index = sched_pop_due(&g_scheduler, now, &deadline)) >= 0) {
+        MonitorEndpoint* ep = &g_endpoints[index];
+        ULONGLONG interval = (ULONGLONG)ep->activeInterval * 1000;
+        unsigned missed = 0;
+        ULONGLONG next = configScheduleMode == SCHED_FIXED_RATE ? sched_next_rate(deadline, interval, now, &missed)
+                                                                : now + interval;
+        if (next <= now) next = now + 1000;   // Never re-queue an endpoint already due, or this loop would not end
+        ep->lastDue = next - interval;
+        sched_set(&g_scheduler, index, next);
+
+        // Drift: how late the timer ran, and for fixed rate, whole periods lost
+        ULONGLONG late = now - deadline;
+        g_scheduledRuns++;
+        g_scheduleLateTotalMs += late;
+        if (late > g_scheduleLateMaxMs) g_scheduleLateMaxMs = late;
+        if (missed > 0) {
+            g_scheduleMissed += missed;
+            LogDebug("Check of %s ran %llu ms late, %u period(s) skipped.", ep->url, late, missed);
+        }
+
+        if (QueueScheduledCheck(index)) {
+            due++;
+        } else {
+            // Still polling from an earlier tick: let that poll stand for this one
+            ep->skippedTicks++;
+            g_skippedTickCount++;
+            LogDebug("Skipped scheduled check of %s, previous poll still running (%d skipped, %ld all endpoints).",
+                     ep->url, ep->skippedTicks, g_skippedTickCount);
+        }
+    }
+    ArmRefreshTimer();
+
+    if (due > 0) {
+        LogTrace("Scheduled refresh timer fired: %d endpoint(s) due.", due);
+    }
 }
 
 void CaptureCurrentDisplaySettings() {
@@ -1642,8 +3603,8 @@ void CaptureCurrentDisplaySettings() {
         lastDpiY = GetDeviceCaps(hdc, LOGPIXELSY);
         ReleaseDC(NULL, hdc);
     }
-    LogMessage("Display settings captured: %dx%d, DPI: %dx%d",
-               lastScreenWidth, lastScreenHeight, lastDpiX, lastDpiY);
+    LogDebug("Display settings captured: %dx%d, DPI: %dx%d",
+             lastScreenWidth, lastScreenHeight, lastDpiX, lastDpiY);
 }
 
 BOOL HasDisplaySettingsChanged() {
@@ -1665,14 +3626,14 @@ BOOL HasDisplaySettingsChanged() {
                     currentDpiY != lastDpiY);
 
     if (changed) {
-        LogMessage("Display settings change detected.");
+        LogDebug("Display settings change detected.");
     }
 
     return changed;
 }
 
 void RefreshTrayIconForNewResolution() {
-    LogMessage("Refreshing tray icon for new resolution/DPI.");
+    LogDebug("Refreshing tray icon for new resolution/DPI.");
 
     HICON savedIcon = currentIcon;
 
@@ -1791,6 +3752,12 @@ static BOOL json_get_string(const char *json, const char *key, char *out, size_t
     p++;
     size_t i = 0;
     while (*p && *p != '"' && i < outLen - 1) {
+        if (*p == '\\' && p[1]) {
+            p++;
+            out[i++] = (*p == 'n') ? '\n' : (*p == 'r') ? '\r' : (*p == 't') ? '\t' : *p;
+            p++;
+            continue;
+        }
         out[i++] = *p++;
     }
     out[i] = '\0';
@@ -1846,12 +3813,13 @@ static void json_escape_string(const char *in, wchar_t *out, size_t outLen) {
 // Wide-char version of ApiResultToString
 static const wchar_t* ApiResultToStringW(ApiResult r) {
     switch (r) {
-        case RESULT_NONE:    return L"-";
-        case RESULT_SUCCESS: return L"Success";
-        case RESULT_FAIL:    return L"Fail";
-        case RESULT_ERROR:   return L"Error";
-        case RESULT_INVALID: return L"Invalid";
-        default:             return L"Unknown";
+        case RESULT_NONE:     return L"-";
+        case RESULT_SUCCESS:  return L"Success";
+        case RESULT_FAIL:     return L"Fail";
+        case RESULT_ERROR:    return L"Error";
+        case RESULT_INVALID:  return L"Invalid";
+        case RESULT_DEGRADED: return L"Degraded";
+        default:              return L"Unknown";
     }
 }
 
@@ -1864,52 +3832,116 @@ static void webview_push_init_config(void) {
     json_escape_string(configApiUrl, wUrl, 1024);
     wchar_t wLogPath[1024];
     json_escape_string(logFilePath, wLogPath, 1024);
-    wchar_t script[4096];
-    swprintf(script, 4096,
-        L"window.onInit({\"view\":\"config\",\"config\":{\"url\":\"%s\",\"interval\":%d,\"loggingEnabled\":%s,\"historyLimit\":%d,\"logPath\":\"%s\"}})",
+
+    wchar_t wFormat[DECODER_SPEC_SIZE * 2];
+    json_escape_string(configResponseFormat, wFormat, DECODER_SPEC_SIZE * 2);
+
+    // Additional endpoints as newline-separated "<url> [interval] [format]" lines
+    size_t textLen = (size_t)configExtraEndpointCount * ENDPOINT_SPEC_LEN + 1;
+    char* text = (char*)calloc(textLen, 1);
+    wchar_t* wEndpoints = (wchar_t*)malloc(textLen * 2 * sizeof(wchar_t));
+    size_t scriptLen = textLen * 2 + 4096;
+    wchar_t* script = (wchar_t*)malloc(scriptLen * sizeof(wchar_t));
+    if (!text || !wEndpoints || !script) {
+        free(text);
+        free(wEndpoints);
+        free(script);
+        return;
+    }
+    size_t pos = 0;
+    for (int i = 0; i < configExtraEndpointCount; i++) {
+        if (i > 0) text[pos++] = '\n';
+        pos += FormatEndpointSpec(&configExtraEndpoints[i], text + pos, textLen - pos - 1);
+    }
+    text[pos] = '\0';
+    json_escape_string(text, wEndpoints, textLen * 2);
+
+    swprintf(script, scriptLen,
+        L"window.onInit({\"view\":\"config\",\"config\":{\"url\":\"%s\",\"interval\":%d,\"loggingEnabled\":%s,\"historyLimit\":%d,\"logPath\":\"%s\",\"format\":\"%s\",\"endpoints\":\"%s\"}})",
         wUrl, configRefreshInterval,
         configLoggingEnabled ? L"true" : L"false",
-        configHistoryLimit, wLogPath);
+        configHistoryLimit, wLogPath, wFormat, wEndpoints);
     webview_execute_script(script);
+    free(script);
+    free(wEndpoints);
+    free(text);
 }
 
-static void webview_push_history_json(wchar_t *buf, size_t bufLen) {
-    size_t pos = 0;
-    pos += swprintf(buf + pos, bufLen - pos, L"[");
-    for (int i = 0; i < historyCount && pos < bufLen - 200; i++) {
+// Longest JSON object one history entry can produce: both strings may double when escaped
+#define HISTORY_JSON_ENTRY_MAX (2 * 256 + 2 * 512 + 384)
+
+// Builds {"offset","total","newest","showEndpoint","entries":[...]} for display
+// indices offset..offset+limit-1 (0 = most recent). Entry IDs never change, so
+// the dialog can tell which cached rows are still valid. Returns a malloc'd string.
+static wchar_t* webview_history_page_json(int offset, int limit) {
+    if (offset < 0) offset = 0;
+    if (limit < 0) limit = 0;
+    if (limit > HISTORY_PAGE_MAX) limit = HISTORY_PAGE_MAX;
+
+    size_t bufLen = (size_t)limit * HISTORY_JSON_ENTRY_MAX + 256;
+    wchar_t* buf = (wchar_t*)malloc(bufLen * sizeof(wchar_t));
+    if (!buf) return NULL;
+
+    int end = offset + limit < historyCount ? offset + limit : historyCount;
+    if (offset == 0) g_historySentNewest = (LONGLONG)historyPushed - 1;
+    size_t pos = swprintf(buf, bufLen, L"{\"offset\":%d,\"total\":%d,\"newest\":%lld,\"showEndpoint\":%s,\"entries\":[",
+                          offset, historyCount, (long long)historyPushed - 1, g_endpointCount > 1 ? L"true" : L"false");
+    for (int i = offset; i < end; i++) {
         HistoryEntry* entry = GetHistoryEntry(i);
         if (!entry) continue;
-        if (i > 0) pos += swprintf(buf + pos, bufLen - pos, L",");
 
-        wchar_t wMsg[512];
-        json_escape_string(entry->newMessage, wMsg, 512);
+        SYSTEMTIME timestamp;
+        TicksToSystemTime(entry->time, &timestamp);
+        wchar_t wMsg[2 * 256];
+        json_escape_string(HistoryText(entry->newMessage), wMsg, 2 * 256);
+        wchar_t wEndpoint[2 * 512];
+        json_escape_string(HistoryText(entry->url), wEndpoint, 2 * 512);
+        char phases[96];
+        FormatPhaseTimings(&entry->timings, phases, sizeof(phases));
 
         pos += swprintf(buf + pos, bufLen - pos,
-            L"{\"time\":\"%04d-%02d-%02d %02d:%02d:%02d\",\"from\":\"%s\",\"to\":\"%s\",\"message\":\"%s\"}",
-            entry->timestamp.wYear, entry->timestamp.wMonth, entry->timestamp.wDay,
-            entry->timestamp.wHour, entry->timestamp.wMinute, entry->timestamp.wSecond,
-            ApiResultToStringW(entry->oldResult),
-            ApiResultToStringW(entry->newResult),
-            wMsg);
+            L"%s{\"id\":%lld,\"time\":\"%04d-%02d-%02d %02d:%02d:%02d\",\"endpoint\":\"%s\",\"from\":\"%s\",\"to\":\"%s\",\"message\":\"%s\",\"timings\":\"%hs\"}",
+            i > offset ? L"," : L"",
+            (long long)(historyPushed - 1 - i),
+            timestamp.wYear, timestamp.wMonth, timestamp.wDay,
+            timestamp.wHour, timestamp.wMinute, timestamp.wSecond,
+            wEndpoint,
+            ApiResultToStringW((ApiResult)entry->oldResult),
+            ApiResultToStringW((ApiResult)entry->newResult),
+            wMsg, phases);
     }
-    if (pos < bufLen - 1) pos += swprintf(buf + pos, bufLen - pos, L"]");
+    swprintf(buf + pos, bufLen - pos, L"]}");
+    return buf;
+}
+
+// Runs prefix + page + suffix, e.g. "window.onHistoryPage(" ... ")"
+static void webview_push_history_page(const wchar_t* prefix, int offset, int limit, const wchar_t* suffix) {
+    wchar_t* page = webview_history_page_json(offset, limit);
+    if (!page) return;
+    size_t scriptLen = wcslen(prefix) + wcslen(page) + wcslen(suffix) + 1;
+    wchar_t* script = (wchar_t*)malloc(scriptLen * sizeof(wchar_t));
+    if (script) {
+        swprintf(script, scriptLen, L"%s%s%s", prefix, page, suffix);
+        webview_execute_script(script);
+        free(script);
+    }
+    free(page);
 }
 
 static void webview_push_init_history(void) {
-    // Allocate buffer large enough for history entries
-    size_t bufLen = (size_t)historyCount * 256 + 256;
-    if (bufLen < 1024) bufLen = 1024;
-    wchar_t *histJson = (wchar_t*)malloc(bufLen * sizeof(wchar_t));
-    if (!histJson) return;
-    webview_push_history_json(histJson, bufLen);
-
-    size_t scriptLen = bufLen + 256;
-    wchar_t *script = (wchar_t*)malloc(scriptLen * sizeof(wchar_t));
-    if (!script) { free(histJson); return; }
-    swprintf(script, scriptLen, L"window.onInit({\"view\":\"history\",\"history\":%s})", histJson);
-    webview_execute_script(script);
-    free(script);
-    free(histJson);
+    // From here on, new entries are pushed as they are added
+    g_historyViewHwnd = g_webviewHwnd;
+
+    // Only the first page; the dialog asks for the rest as it scrolls
+    webview_push_history_page(L"window.onInit({\"view\":\"history\",\"history\":", 0, HISTORY_PAGE_SIZE, L"})");
+}
+
+// Sends the entries added since the dialog last saw the newest one, as a page at offset 0
+static void webview_push_history_append(void) {
+    LONGLONG added = (LONGLONG)historyPushed - 1 - g_historySentNewest;
+    if (added <= 0) return;
+    if (added > HISTORY_PAGE_MAX) added = HISTORY_PAGE_MAX;
+    webview_push_history_page(L"window.onHistoryAppend(", 0, (int)added, L")");
 }
 
 static void webview_push_validation_result(BOOL valid) {
@@ -1918,20 +3950,70 @@ static void webview_push_validation_result(BOOL valid) {
     webview_execute_script(script);
 }
 
-static void webview_push_history_update(void) {
-    size_t bufLen = (size_t)historyCount * 256 + 256;
-    if (bufLen < 1024) bufLen = 1024;
-    wchar_t *histJson = (wchar_t*)malloc(bufLen * sizeof(wchar_t));
-    if (!histJson) return;
-    webview_push_history_json(histJson, bufLen);
+static void UtcTicksToLocalTime(LONGLONG time, SYSTEMTIME* st) {
+    FILETIME ft, local;
+    ULARGE_INTEGER ticks;
+    ticks.QuadPart = (ULONGLONG)time;
+    ft.dwLowDateTime = ticks.LowPart;
+    ft.dwHighDateTime = ticks.HighPart;
+    if (!FileTimeToLocalFileTime(&ft, &local) || !FileTimeToSystemTime(&local, st)) memset(st, 0, sizeof(*st));
+}
+
+// Answers getMetrics: the URL's raw polls (last hour), minute rollups (last day)
+// or hour rollups (retention period), limited to the last `hours` when given
+static void webview_push_metrics(const char* url, const char* resolution, int hours) {
+    BOOL raw = (strcmp(resolution, "raw") == 0);
+    TSeriesLevel level = (strcmp(resolution, "hour") == 0) ? TSERIES_HOUR : TSERIES_MINUTE;
+    size_t max = raw ? TSERIES_RAW_SLOTS : level == TSERIES_HOUR ? (size_t)configMetricsDays * 24 : TSERIES_MINUTE_SLOTS;
+    LONGLONG from = hours > 0 ? CurrentFileTimeTicks() - (LONGLONG)hours * TSERIES_TICKS_PER_HOUR : 0;
+    if (raw && hours <= 0) from = CurrentFileTimeTicks() - TSERIES_TICKS_PER_HOUR;
+
+    TSeriesSample* samples = raw ? (TSeriesSample*)malloc(max * sizeof(TSeriesSample)) : NULL;
+    TSeriesRollup* rollups = raw ? NULL : (TSeriesRollup*)malloc(max * sizeof(TSeriesRollup));
+    size_t bufLen = max * 160 + 1024;
+    wchar_t* script = (wchar_t*)malloc(bufLen * sizeof(wchar_t));
+    if ((!samples && !rollups) || !script) {
+        free(samples);
+        free(rollups);
+        free(script);
+        return;
+    }
+
+    size_t count = 0;
+    int series = tseries_find(&pollSeries, url);
+    if (series >= 0) {
+        count = raw ? tseries_samples(&pollSeries, series, from, samples, max)
+                    : tseries_rollups(&pollSeries, series, level, from, rollups, max);
+    }
 
-    size_t scriptLen = bufLen + 128;
-    wchar_t *script = (wchar_t*)malloc(scriptLen * sizeof(wchar_t));
-    if (!script) { free(histJson); return; }
-    swprintf(script, scriptLen, L"window.onHistoryUpdate(%s)", histJson);
+    wchar_t wUrl[1024];
+    json_escape_string(url, wUrl, 1024);
+    size_t pos = swprintf(script, bufLen, L"window.onMetrics({\"url\":\"%s\",\"resolution\":\"%s\",\"points\":[",
+                          wUrl, raw ? L"raw" : level == TSERIES_HOUR ? L"hour" : L"minute");
+    for (size_t i = 0; i < count; i++) {
+        SYSTEMTIME st;
+        if (i > 0) script[pos++] = L',';
+        if (raw) {
+            const TSeriesSample* p = &samples[i];
+            UtcTicksToLocalTime(p->time, &st);
+            pos += swprintf(script + pos, bufLen - pos,
+                L"{\"time\":\"%04d-%02d-%02d %02d:%02d:%02d\",\"latency\":%u,\"bytes\":%u,\"attempts\":%u,\"ok\":%s}",
+                st.wYear, st.wMonth, st.wDay, st.wHour, st.wMinute, st.wSecond,
+                p->latencyMs, p->bytes, (unsigned)p->attempts, p->ok ? L"true" : L"false");
+        } else {
+            const TSeriesRollup* r = &rollups[i];
+            UtcTicksToLocalTime(r->start, &st);
+            pos += swprintf(script + pos, bufLen - pos,
+                L"{\"time\":\"%04d-%02d-%02d %02d:%02d\",\"count\":%u,\"errors\":%u,\"min\":%u,\"avg\":%u,\"p95\":%u,\"max\":%u}",
+                st.wYear, st.wMonth, st.wDay, st.wHour, st.wMinute,
+                r->count, r->errors, r->minMs, r->avgMs, r->p95Ms, r->maxMs);
+        }
+    }
+    swprintf(script + pos, bufLen - pos, L"]})");
     webview_execute_script(script);
     free(script);
-    free(histJson);
+    free(samples);
+    free(rollups);
 }
 
 // ============================================================================
@@ -2080,9 +4162,11 @@ static HRESULT STDMETHODCALLTYPE MsgReceived_Invoke(ICoreWebView2WebMessageRecei
         }
     } else if (strcmp(action, "validateUrl") == 0) {
         char url[512] = {0};
+        char format[DECODER_SPEC_SIZE] = {0};
         json_get_string(msg, "url", url, sizeof(url));
+        json_get_string(msg, "format", format, sizeof(format));
         if (url[0]) {
-            StartValidation(g_webviewHwnd, url);
+            StartValidation(g_webviewHwnd, url, format);
         }
     } else if (strcmp(action, "saveSettings") == 0) {
         char url[512] = {0};
@@ -2098,11 +4182,29 @@ static HRESULT STDMETHODCALLTYPE MsgReceived_Invoke(ICoreWebView2WebMessageRecei
             strncpy(configApiUrl, url, sizeof(configApiUrl) - 1);
             configApiUrl[sizeof(configApiUrl) - 1] = '\0';
         }
+        char format[DECODER_SPEC_SIZE] = {0};
+        if (json_get_string(msg, "format", format, sizeof(format))) {
+            DecoderConfig dc;
+            if (decoder_parse(format, &dc)) {
+                strcpy(configResponseFormat, format);
+            } else {
+                LogWarn("WARNING: Unknown response format '%s' ignored.", format);
+            }
+        }
+        size_t endpointsLen = (size_t)MAX_ENDPOINTS * ENDPOINT_SPEC_LEN;
+        char* endpoints = (char*)calloc(endpointsLen, 1);
+        if (endpoints) {
+            if (json_get_string(msg, "endpoints", endpoints, endpointsLen)) {
+                SetExtraEndpointsFromText(endpoints);
+            }
+            free(endpoints);
+        }
         if (interval == 60 || interval == 120 || interval == 300) {
             configRefreshInterval = interval;
         }
         configLoggingEnabled = logging;
-        if (histLimit >= 10 && histLimit <= 10000) {
+        ApplyLogLevel();
+        if (histLimit >= HISTORY_LIMIT_MIN && histLimit <= HISTORY_LIMIT_MAX) {
             configHistoryLimit = histLimit;
             InitHistoryBuffer(configHistoryLimit);
         }
@@ -2110,15 +4212,29 @@ static HRESULT STDMETHODCALLTYPE MsgReceived_Invoke(ICoreWebView2WebMessageRecei
         SaveConfigToRegistry();
         MarkAsConfigured();
         ApplyConfiguration();
-        LogMessage("Configuration updated via WebView dialog: URL=%s, Interval=%d, Logging=%s, HistoryLimit=%d",
-                   configApiUrl, configRefreshInterval, configLoggingEnabled ? "enabled" : "disabled", configHistoryLimit);
+        LogInfo("Configuration updated via WebView dialog: URL=%s, Interval=%d, Logging=%s, HistoryLimit=%d",
+                configApiUrl, configRefreshInterval, configLoggingEnabled ? "enabled" : "disabled", configHistoryLimit);
         PostMessage(g_webviewHwnd, WM_CLOSE, 0, 0);
     } else if (strcmp(action, "close") == 0) {
         PostMessage(g_webviewHwnd, WM_CLOSE, 0, 0);
     } else if (strcmp(action, "clearHistory") == 0) {
-        historyCount = 0;
-        historyHead = 0;
-        webview_push_history_update();
+        ClearHistory();
+        CompactHistory();
+        webview_push_history_page(L"window.onHistoryPage(", 0, HISTORY_PAGE_SIZE, L")");
+    } else if (strcmp(action, "getHistoryPage") == 0) {
+        int offset = 0;
+        int limit = HISTORY_PAGE_SIZE;
+        json_get_int(msg, "offset", &offset);
+        json_get_int(msg, "limit", &limit);
+        webview_push_history_page(L"window.onHistoryPage(", offset, limit, L")");
+    } else if (strcmp(action, "getMetrics") == 0) {
+        char url[512] = {0};
+        char resolution[16] = {0};
+        int hours = 0;
+        json_get_string(msg, "url", url, sizeof(url));
+        json_get_string(msg, "resolution", resolution, sizeof(resolution));
+        json_get_int(msg, "hours", &hours);
+        webview_push_metrics(url[0] ? url : configApiUrl, resolution, hours);
     } else if (strcmp(action, "resize") == 0) {
         int contentHeight = 0;
         json_get_int(msg, "height", &contentHeight);
@@ -2195,6 +4311,7 @@ static LRESULT CALLBACK WebViewWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARA
             return 0;
 
         case WM_DESTROY:
+            g_historyViewHwnd = NULL;
             g_webviewHwnd = NULL;
             g_webviewWindowShown = FALSE;
             KillTimer(hwnd, ID_TIMER_WEBVIEW_SHOW_FALLBACK);
@@ -2253,7 +4370,7 @@ static void ShowWebViewDialog(const char* view, int width, int height) {
         NULL, NULL, g_hInstance, NULL);
 
     if (!g_webviewHwnd) {
-        LogMessage("ERROR: Failed to create WebView2 window.");
+        LogError("ERROR: Failed to create WebView2 window.");
         return;
     }
     g_webviewWindowShown = FALSE;
@@ -2277,7 +4394,7 @@ static void ShowWebViewDialog(const char* view, int width, int height) {
     envHandler->lpVtbl->Release(envHandler);
 
     if (FAILED(hr)) {
-        LogMessage("ERROR: Failed to initialize WebView2 environment. HRESULT=0x%08lx", hr);
+        LogError("ERROR: Failed to initialize WebView2 environment. HRESULT=0x%08lx", hr);
         MessageBoxW(NULL,
             L"Failed to initialize WebView2.\n\n"
             L"Please ensure the Microsoft Edge WebView2 Runtime is installed.\n"
@@ -2293,22 +4410,27 @@ void ExitApplication(HWND hwnd) {
     if (alreadyExiting) return;
     alreadyExiting = TRUE;
 
-    LogMessage("=== Application shutting down ===");
+    LogInfo("=== Application shutting down ===");
 
     // Close WebView2 dialog if open
     if (g_webviewHwnd) SendMessage(g_webviewHwnd, WM_CLOSE, 0, 0);
 
-    if (timerRefresh) KillTimer(hwnd, 1);
+    StopScheduler(hwnd);
     if (timerTooltip) KillTimer(hwnd, 2);
 
-    SaveHistoryToRegistry();
+    StopWorkerPool();
+
+    DrainPollResults();
+    CloseHistoryStore();
     FreeHistoryBuffer();
+    ClosePollSeries();
 
     Shell_NotifyIconA(NIM_DELETE, &nid);
 
     if (hIconEmpty) DestroyIcon(hIconEmpty);
     if (hIconSuccess) DestroyIcon(hIconSuccess);
     if (hIconFail) DestroyIcon(hIconFail);
+    if (hIconDegraded) DestroyIcon(hIconDegraded);
     if (hIconBlank) DestroyIcon(hIconBlank);
     if (hMenu) DestroyMenu(hMenu);
 
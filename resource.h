@@ -7,6 +7,7 @@
 #define IDI_SUCCESS 102
 #define IDI_FAIL    103
 #define IDI_BLANK   104
+#define IDI_DEGRADED 105
 
 #define IDR_HTML_UI      200
 #define IDR_WEBVIEW2_DLL 201
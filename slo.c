@@ -0,0 +1,18 @@
+// slo.c
+#include "slo.h"
+
+void slo_init(LatencyWindow* w, int size) {
+    if (size < 1) size = 1;
+    if (size > SLO_WINDOW_MAX) size = SLO_WINDOW_MAX;
+    w->slow = 0;
+    w->size = size;
+    w->slowCount = 0;
+}
+
+int slo_record(LatencyWindow* w, unsigned latencyMs, unsigned thresholdMs) {
+    int slow = latencyMs > thresholdMs;
+    int oldest = (int)((w->slow >> (w->size - 1)) & 1);
+    w->slow = (w->slow << 1) | (unsigned long long)slow;
+    w->slowCount += slow - oldest;
+    return w->slowCount;
+}
@@ -0,0 +1,28 @@
+// slo.h
+// Rolling latency window behind the Degraded state.
+//
+// Remembers, for an endpoint's last N polls (N <= 64), whether each one was
+// slower than the latency threshold: one bit per poll in a 64-bit shift
+// register, plus a running count of the set bits. Recording a poll is O(1)
+// whatever N is: shift the new bit in and uncount the bit that falls out.
+// The caller declares the endpoint degraded while K or more of the last N
+// polls were slow.
+// Not thread-safe: each window belongs to one caller.
+#ifndef SLO_H
+#define SLO_H
+
+#define SLO_WINDOW_MAX 64
+
+typedef struct {
+    unsigned long long slow;      // Bit i set: the poll i polls ago was slow
+    int size;                     // N, 1..SLO_WINDOW_MAX
+    int slowCount;                // Bits set among the last size polls
+} LatencyWindow;
+
+// Empties the window; size is clamped to 1..SLO_WINDOW_MAX
+void slo_init(LatencyWindow* w, int size);
+
+// Records a poll's latency; returns how many of the last N polls were slow
+int slo_record(LatencyWindow* w, unsigned latencyMs, unsigned thresholdMs);
+
+#endif // SLO_H
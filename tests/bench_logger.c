@@ -0,0 +1,148 @@
+// bench_logger.c
+// Lines per second and caller-side latency of the log ring against the
+// LogMessage it replaced, which reopened the file under a lock per line.
+//
+// Each caller logs a poll-sized line (a 500-byte response body) and pauses
+// for 1 ms every 256 lines, roughly a burst of polls. Throughput counts the
+// lines found in the file afterwards (the ring drops lines rather than block
+// when it is full) over the time until they are all on disk, including the
+// writer's final flush.
+#include <windows.h>
+#include "logger.h"
+#include <sys/stat.h>
+
+#define BENCH_LINES   16384    // Per run, split over the callers
+#define BENCH_PAUSE   256      // Lines between 1 ms pauses
+#define BENCH_MAX_THREADS 8
+
+static char dir[] = "/tmp/apimonitor-logbench-XXXXXX";
+static char legacyPath[MAX_PATH];
+static char body[501];
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// --- LogMessage before the ring ---
+
+static pthread_mutex_t legacyLock = PTHREAD_MUTEX_INITIALIZER;
+
+static void legacy_check_size(void) {
+    FILE* f = fopen(legacyPath, "r");
+    if (!f) return;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    if (size > 10 * 1024 * 1024) fclose(fopen(legacyPath, "w"));
+}
+
+static void legacy_log(const char* format, ...) {
+    pthread_mutex_lock(&legacyLock);
+    legacy_check_size();
+    FILE* f = fopen(legacyPath, "a");
+    if (!f) {
+        pthread_mutex_unlock(&legacyLock);
+        return;
+    }
+    SYSTEMTIME st;
+    GetLocalTime(&st);
+    fprintf(f, "[%04d-%02d-%02d %02d:%02d:%02d] [TID:%lu] ",
+            st.wYear, st.wMonth, st.wDay, st.wHour, st.wMinute, st.wSecond, GetCurrentThreadId());
+    va_list args;
+    va_start(args, format);
+    vfprintf(f, format, args);
+    va_end(args);
+    fprintf(f, "\n");
+    fclose(f);
+    pthread_mutex_unlock(&legacyLock);
+}
+
+static void ring_log(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    logger_write(format, args);
+    va_end(args);
+}
+
+// Lines in the file that carry a logged message
+static int count_lines(const char* path) {
+    FILE* f = fopen(path, "r");
+    static char line[2048];
+    int n = 0;
+    if (!f) return 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (strstr(line, "] API response received")) n++;
+    }
+    fclose(f);
+    return n;
+}
+
+// --- Runs ---
+
+static int useRing;
+static int perThread;
+static double latency[BENCH_LINES];
+
+static void* caller(void* arg) {
+    double* out = latency + (long)arg * perThread;
+    for (int i = 0; i < perThread; i++) {
+        double t = now();
+        // Distinct lines, or the ring's repeat suppression would collapse them
+        if (useRing) ring_log("API response received (poll %d, %d bytes): %.500s", i, 500, body);
+        else legacy_log("API response received (poll %d, %d bytes): %.500s", i, 500, body);
+        out[i] = now() - t;
+        if (i % BENCH_PAUSE == BENCH_PAUSE - 1) usleep(1000);
+    }
+    return NULL;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+static void bench(int threads, int ring) {
+    pthread_t ids[BENCH_MAX_THREADS];
+    char path[MAX_PATH];
+    useRing = ring;
+    perThread = BENCH_LINES / threads;
+
+    snprintf(path, sizeof(path), "%s/ring.log", dir);
+    unlink(path);
+    unlink(legacyPath);
+    if (ring) logger_start(path);
+
+    double t = now();
+    for (long i = 0; i < threads; i++) pthread_create(&ids[i], NULL, caller, (void*)i);
+    for (int i = 0; i < threads; i++) pthread_join(ids[i], NULL);
+    if (ring) logger_stop();
+    double elapsed = now() - t - (double)(perThread / BENCH_PAUSE) * 0.001;
+
+    int n = perThread * threads;
+    int written = count_lines(ring ? path : legacyPath);
+    qsort(latency, (size_t)n, sizeof(double), compare_double);
+    printf("%-6s %d thread(s): %9.0f lines/s, %5d dropped, caller p50 %6.2f us, p99 %7.2f us, max %8.1f us\n",
+           ring ? "ring" : "fopen", threads, written / elapsed, n - written,
+           latency[n / 2] * 1e6, latency[n * 99 / 100] * 1e6, latency[n - 1] * 1e6);
+}
+
+int main(void) {
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    snprintf(legacyPath, sizeof(legacyPath), "%s/legacy.log", dir);
+    memset(body, 'x', sizeof(body) - 1);
+
+    printf("logger (%d lines of ~560 bytes per run, 1 ms pause every %d lines)\n", BENCH_LINES, BENCH_PAUSE);
+    for (int threads = 1; threads <= BENCH_MAX_THREADS; threads *= 2) {
+        bench(threads, 0);
+        bench(threads, 1);
+    }
+
+    char command[MAX_PATH + 16];
+    snprintf(command, sizeof(command), "rm -rf %s", dir);
+    return system(command) != 0;
+}
@@ -0,0 +1,153 @@
+// bench_xmlstatus.c
+// Streaming status parser throughput on 1 KB, 64 KB and 1 MB documents.
+//
+// Each document is mostly diagnostics text with sparse unrelated tags. It is
+// parsed twice: with the verdict at the end (every byte must be scanned) and
+// with the verdict at the top (the read stops after the first chunk). The
+// verdict-last case is also timed through the parser it replaced, which took
+// the whole body and made up to six strstr passes over it: once with the C
+// library's strstr, and once with a byte-at-a-time strstr like the one in
+// msvcrt, which the Windows build links.
+#include "xmlstatus.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_CHUNK 8192     // Bytes per WinHttpReadData call in the app
+#define BENCH_BYTES 200000000
+
+static const char* verdict = "<r>success</r><message>ok</message>";
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static char* make_doc(size_t len, int verdictFirst) {
+    static const char text[] = "abcdefgh ijklmnop\n";
+    char* doc = (char*)malloc(len + 1);
+    size_t v = strlen(verdict);
+
+    for (size_t i = 0; i < len; i++) doc[i] = text[i % (sizeof(text) - 1)];
+    for (size_t i = 200; i + 40 < len; i += 400) memcpy(doc + i, "<diag>x</diag>", 14);
+    memcpy(verdictFirst ? doc : doc + len - v, verdict, v);
+    doc[len] = '\0';
+    return doc;
+}
+
+typedef const char* (*StrstrFn)(const char* s, const char* find);
+
+static const char* libc_strstr(const char* s, const char* find) {
+    return strstr(s, find);
+}
+
+// The classic CRT strstr: restart the comparison at every position
+__attribute__((noinline))
+static const char* scalar_strstr(const char* s, const char* find) {
+    if (!*find) return s;
+    for (; *s; s++) {
+        const char* a = s;
+        const char* b = find;
+        while (*a && *b && *a == *b) a++, b++;
+        if (!*b) return s;
+    }
+    return NULL;
+}
+
+// ParseXmlResponse before the streaming parser, without its logging
+static int parse_legacy(const char* xml, char* message, StrstrFn strstr) {
+    strcpy(message, "Invalid XML");
+    if (!xml || strlen(xml) == 0) return 0;
+
+    const char* resultTag = strstr(xml, "<r>");
+    const char* resultEnd;
+    const char* valueStart;
+    if (resultTag) {
+        resultEnd = strstr(resultTag, "</r>");
+        if (!resultEnd) return 0;
+        valueStart = resultTag + 3;
+    } else {
+        resultTag = strstr(xml, "<result");
+        if (!resultTag) return 0;
+        resultEnd = strstr(resultTag, "</result>");
+        if (!resultEnd) return 0;
+        const char* closeBracket = strchr(resultTag, '>');
+        if (!closeBracket || closeBracket >= resultEnd) return 0;
+        valueStart = closeBracket + 1;
+    }
+
+    char resultValue[32] = {0};
+    size_t valueLen = resultEnd - valueStart;
+    if (valueLen >= sizeof(resultValue)) valueLen = sizeof(resultValue) - 1;
+    memcpy(resultValue, valueStart, valueLen);
+
+    const char* msgTag = strstr(xml, "<message>");
+    if (msgTag) {
+        const char* msgEnd = strstr(msgTag, "</message>");
+        if (msgEnd) {
+            size_t msgLen = msgEnd - msgTag - 9;
+            if (msgLen > 255) msgLen = 255;
+            memcpy(message, msgTag + 9, msgLen);
+            message[msgLen] = '\0';
+        }
+    }
+
+    char* p = resultValue;
+    while (*p && isspace((unsigned char)*p)) p++;
+    return strncmp(p, "success", 7) == 0;
+}
+
+// Returns bytes handed to the parser
+static size_t parse_streaming(const char* doc, size_t len, char* message) {
+    XmlStatusParser p;
+    size_t pos = 0;
+    xml_status_init(&p);
+    while (pos < len) {
+        size_t n = len - pos < BENCH_CHUNK ? len - pos : BENCH_CHUNK;
+        pos += n;
+        if (xml_status_feed(&p, doc + pos - n, n) == XML_STATUS_DONE) break;
+    }
+    xml_status_verdict(&p, message, 256, NULL);
+    return pos;
+}
+
+static void bench(size_t len, int verdictFirst) {
+    char* doc = make_doc(len, verdictFirst);
+    char message[256];
+    int iters = (int)(BENCH_BYTES / len);
+    size_t fed = 0;
+
+    double t = now();
+    for (int i = 0; i < iters; i++) fed = parse_streaming(doc, len, message);
+    double us = (now() - t) / iters * 1e6;
+
+    if (verdictFirst) {
+        printf("%8zu B, verdict first: %9.2f us, %7zu B read\n", len, us, fed);
+    } else {
+        volatile int sink = 0;
+        t = now();
+        for (int i = 0; i < iters; i++) sink += parse_legacy(doc, message, libc_strstr);
+        double libcUs = (now() - t) / iters * 1e6;
+        int scalarIters = iters / 50 > 0 ? iters / 50 : 1;
+        t = now();
+        for (int i = 0; i < scalarIters; i++) sink += parse_legacy(doc, message, scalar_strstr);
+        double scalarUs = (now() - t) / scalarIters * 1e6;
+        printf("%8zu B, verdict last : %9.2f us, %7zu B read, %7.0f MB/s\n", len, us, fed, len / us);
+        printf("%8s   strstr parser: libc %9.2f us (%.1fx), scalar %9.2f us (%.1fx)\n",
+               "", libcUs, libcUs / us, scalarUs, scalarUs / us);
+    }
+    free(doc);
+}
+
+int main(void) {
+    size_t sizes[] = { 1024, 65536, 1 << 20 };
+    printf("xmlstatus ('<' search: %s, %d-byte chunks)\n", xml_status_simd_name(), BENCH_CHUNK);
+    for (int i = 0; i < 3; i++) {
+        bench(sizes[i], 0);
+        bench(sizes[i], 1);
+    }
+    return 0;
+}
@@ -0,0 +1,343 @@
+// windows.h
+// Host stand-in for the slice of the Win32 API used by logger.c, journal.c,
+// mailbox.c and tseries.c, so their tests build with the host gcc.
+//
+// Only on the include path of those tests (-Itests/host). Files, events and
+// threads are POSIX descriptors, condition variables and pthreads behind a
+// tagged HANDLE; the Interlocked functions are GCC atomics with the same
+// full-barrier semantics. Nothing here is meant to be complete: a call the
+// modules do not make is not provided.
+#ifndef HOST_WINDOWS_H
+#define HOST_WINDOWS_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+// --- Types ---
+
+typedef int BOOL;
+typedef int LONG;                  // 32 bits, as on Windows
+typedef unsigned int ULONG;
+typedef unsigned long DWORD;       // Printed with %lu, as on Windows
+typedef long long LONGLONG;
+typedef unsigned short USHORT;
+typedef unsigned char BYTE;
+typedef void* PVOID;
+typedef void* LPVOID;
+typedef void* HANDLE;
+
+typedef union {
+    struct {
+        DWORD LowPart;
+        LONG HighPart;
+    };
+    LONGLONG QuadPart;
+} LARGE_INTEGER;
+
+typedef struct {
+    unsigned short wYear, wMonth, wDayOfWeek, wDay;
+    unsigned short wHour, wMinute, wSecond, wMilliseconds;
+} SYSTEMTIME;
+
+#define WINAPI
+typedef DWORD (WINAPI *LPTHREAD_START_ROUTINE)(LPVOID param);
+
+// --- Constants ---
+
+#define FALSE 0
+#define TRUE  1
+#define MAX_PATH 260
+#define INFINITE 0xFFFFFFFFUL
+#define INVALID_HANDLE_VALUE ((HANDLE)(long)-1)
+
+#define GENERIC_READ          0x80000000UL
+#define GENERIC_WRITE         0x40000000UL
+#define FILE_SHARE_READ       1
+#define FILE_SHARE_WRITE      2
+#define FILE_SHARE_DELETE     4
+#define OPEN_EXISTING         3
+#define OPEN_ALWAYS           4
+#define FILE_ATTRIBUTE_NORMAL 0x80
+#define FILE_BEGIN            SEEK_SET
+#define FILE_END              SEEK_END
+
+#define MOVEFILE_REPLACE_EXISTING  1
+#define MOVEFILE_WRITE_THROUGH     8
+#define COMPRESSION_FORMAT_DEFAULT 1
+#define FSCTL_SET_COMPRESSION      0x9C040
+#define WT_EXECUTELONGFUNCTION     0x10
+
+#define _strdup strdup
+
+// --- Handles ---
+
+#define HOST_HANDLE_FILE   1
+#define HOST_HANDLE_EVENT  2
+#define HOST_HANDLE_THREAD 3
+
+typedef struct {
+    int kind;
+    int fd;                        // File
+    pthread_mutex_t lock;          // Event
+    pthread_cond_t cond;
+    int signaled;
+    int manualReset;
+    pthread_t thread;              // Thread
+    LPTHREAD_START_ROUTINE start;
+    LPVOID param;
+} HostHandle;
+
+static inline HostHandle* host_handle(int kind) {
+    HostHandle* h = (HostHandle*)calloc(1, sizeof(HostHandle));
+    if (h) h->kind = kind;
+    return h;
+}
+
+static inline BOOL CloseHandle(HANDLE handle) {
+    HostHandle* h = (HostHandle*)handle;
+    if (!h || handle == INVALID_HANDLE_VALUE) return FALSE;
+    if (h->kind == HOST_HANDLE_FILE) close(h->fd);
+    if (h->kind == HOST_HANDLE_EVENT) {
+        pthread_mutex_destroy(&h->lock);
+        pthread_cond_destroy(&h->cond);
+    }
+    free(h);
+    return TRUE;
+}
+
+static inline DWORD GetLastError(void) {
+    return (DWORD)errno;
+}
+
+// --- Interlocked ---
+
+static inline LONG InterlockedIncrement(volatile LONG* p) {
+    return __atomic_add_fetch(p, 1, __ATOMIC_SEQ_CST);
+}
+
+static inline LONG InterlockedExchange(volatile LONG* p, LONG value) {
+    return __atomic_exchange_n(p, value, __ATOMIC_SEQ_CST);
+}
+
+static inline LONG InterlockedCompareExchange(volatile LONG* p, LONG value, LONG comparand) {
+    __atomic_compare_exchange_n(p, &comparand, value, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    return comparand;
+}
+
+static inline PVOID InterlockedExchangePointer(PVOID volatile* p, PVOID value) {
+    return __atomic_exchange_n(p, value, __ATOMIC_SEQ_CST);
+}
+
+static inline PVOID InterlockedCompareExchangePointer(PVOID volatile* p, PVOID value, PVOID comparand) {
+    __atomic_compare_exchange_n(p, &comparand, value, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    return comparand;
+}
+
+// --- Time and threads ---
+
+static inline void GetLocalTime(SYSTEMTIME* st) {
+    struct timeval tv;
+    struct tm tm;
+    gettimeofday(&tv, NULL);
+    localtime_r(&tv.tv_sec, &tm);
+    st->wYear = (unsigned short)(tm.tm_year + 1900);
+    st->wMonth = (unsigned short)(tm.tm_mon + 1);
+    st->wDayOfWeek = (unsigned short)tm.tm_wday;
+    st->wDay = (unsigned short)tm.tm_mday;
+    st->wHour = (unsigned short)tm.tm_hour;
+    st->wMinute = (unsigned short)tm.tm_min;
+    st->wSecond = (unsigned short)tm.tm_sec;
+    st->wMilliseconds = (unsigned short)(tv.tv_usec / 1000);
+}
+
+static inline DWORD GetCurrentThreadId(void) {
+    return (DWORD)syscall(SYS_gettid);
+}
+
+static inline void* host_thread_start(void* arg) {
+    HostHandle* h = (HostHandle*)arg;
+    h->start(h->param);
+    return NULL;
+}
+
+static inline HANDLE CreateThread(void* security, size_t stackSize, LPTHREAD_START_ROUTINE start,
+                                  LPVOID param, DWORD flags, DWORD* threadId) {
+    HostHandle* h = host_handle(HOST_HANDLE_THREAD);
+    (void)security; (void)stackSize; (void)flags; (void)threadId;
+    if (!h) return NULL;
+    h->start = start;
+    h->param = param;
+    if (pthread_create(&h->thread, NULL, host_thread_start, h) != 0) {
+        free(h);
+        return NULL;
+    }
+    return h;
+}
+
+typedef struct {
+    LPTHREAD_START_ROUTINE start;
+    PVOID param;
+} HostWorkItem;
+
+static inline void* host_work_item_start(void* arg) {
+    HostWorkItem item = *(HostWorkItem*)arg;
+    free(arg);
+    item.start(item.param);
+    return NULL;
+}
+
+// Runs the work item on a detached thread, like a thread-pool thread
+static inline BOOL QueueUserWorkItem(LPTHREAD_START_ROUTINE start, PVOID param, ULONG flags) {
+    HostWorkItem* item = (HostWorkItem*)malloc(sizeof(HostWorkItem));
+    pthread_t thread;
+    (void)flags;
+    if (!item) return FALSE;
+    item->start = start;
+    item->param = param;
+    if (pthread_create(&thread, NULL, host_work_item_start, item) != 0) {
+        free(item);
+        return FALSE;
+    }
+    pthread_detach(thread);
+    return TRUE;
+}
+
+static inline HANDLE CreateEventA(void* security, BOOL manualReset, BOOL initialState, const char* name) {
+    HostHandle* h = host_handle(HOST_HANDLE_EVENT);
+    (void)security; (void)name;
+    if (!h) return NULL;
+    pthread_mutex_init(&h->lock, NULL);
+    pthread_cond_init(&h->cond, NULL);
+    h->manualReset = manualReset;
+    h->signaled = initialState;
+    return h;
+}
+
+static inline BOOL SetEvent(HANDLE handle) {
+    HostHandle* h = (HostHandle*)handle;
+    pthread_mutex_lock(&h->lock);
+    h->signaled = 1;
+    pthread_cond_broadcast(&h->cond);
+    pthread_mutex_unlock(&h->lock);
+    return TRUE;
+}
+
+#define WAIT_OBJECT_0 0
+#define WAIT_TIMEOUT  258
+
+// Threads can only be joined (INFINITE); events honour the timeout
+static inline DWORD WaitForSingleObject(HANDLE handle, DWORD ms) {
+    HostHandle* h = (HostHandle*)handle;
+    if (h->kind == HOST_HANDLE_THREAD) {
+        pthread_join(h->thread, NULL);
+        return WAIT_OBJECT_0;
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += (time_t)(ms / 1000);
+    deadline.tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    DWORD result = WAIT_OBJECT_0;
+    pthread_mutex_lock(&h->lock);
+    while (!h->signaled) {
+        if (ms == INFINITE) {
+            pthread_cond_wait(&h->cond, &h->lock);
+        } else if (pthread_cond_timedwait(&h->cond, &h->lock, &deadline) == ETIMEDOUT) {
+            result = WAIT_TIMEOUT;
+            break;
+        }
+    }
+    if (result == WAIT_OBJECT_0 && !h->manualReset) h->signaled = 0;
+    pthread_mutex_unlock(&h->lock);
+    return result;
+}
+
+// --- Files ---
+
+static inline HANDLE CreateFileA(const char* path, DWORD access, DWORD share, void* security,
+                                 DWORD disposition, DWORD attributes, HANDLE templateFile) {
+    int flags = (access & GENERIC_WRITE) ? ((access & GENERIC_READ) ? O_RDWR : O_WRONLY) : O_RDONLY;
+    (void)share; (void)security; (void)attributes; (void)templateFile;
+    if (disposition == OPEN_ALWAYS) flags |= O_CREAT;
+
+    int fd = open(path, flags, 0644);
+    if (fd < 0) return INVALID_HANDLE_VALUE;
+    HostHandle* h = host_handle(HOST_HANDLE_FILE);
+    if (!h) {
+        close(fd);
+        return INVALID_HANDLE_VALUE;
+    }
+    h->fd = fd;
+    return h;
+}
+
+static inline BOOL ReadFile(HANDLE handle, void* data, DWORD len, DWORD* bytesRead, void* overlapped) {
+    ssize_t n = read(((HostHandle*)handle)->fd, data, len);
+    (void)overlapped;
+    *bytesRead = n < 0 ? 0 : (DWORD)n;
+    return n >= 0;
+}
+
+static inline BOOL WriteFile(HANDLE handle, const void* data, DWORD len, DWORD* written, void* overlapped) {
+    ssize_t n = write(((HostHandle*)handle)->fd, data, len);
+    (void)overlapped;
+    *written = n < 0 ? 0 : (DWORD)n;
+    return n >= 0;
+}
+
+static inline BOOL SetFilePointerEx(HANDLE handle, LARGE_INTEGER distance, LARGE_INTEGER* newPos, DWORD method) {
+    off_t pos = lseek(((HostHandle*)handle)->fd, (off_t)distance.QuadPart, (int)method);
+    if (pos < 0) return FALSE;
+    if (newPos) newPos->QuadPart = pos;
+    return TRUE;
+}
+
+static inline BOOL GetFileSizeEx(HANDLE handle, LARGE_INTEGER* size) {
+    int fd = ((HostHandle*)handle)->fd;
+    off_t pos = lseek(fd, 0, SEEK_CUR);
+    size->QuadPart = lseek(fd, 0, SEEK_END);
+    lseek(fd, pos, SEEK_SET);
+    return size->QuadPart >= 0;
+}
+
+static inline BOOL SetEndOfFile(HANDLE handle) {
+    int fd = ((HostHandle*)handle)->fd;
+    return ftruncate(fd, lseek(fd, 0, SEEK_CUR)) == 0;
+}
+
+static inline BOOL FlushFileBuffers(HANDLE handle) {
+    return fsync(((HostHandle*)handle)->fd) == 0;
+}
+
+// NTFS compression has no host equivalent; the request simply succeeds
+static inline BOOL DeviceIoControl(HANDLE handle, DWORD code, void* in, DWORD inLen, void* out,
+                                   DWORD outLen, DWORD* returned, void* overlapped) {
+    (void)handle; (void)code; (void)in; (void)inLen; (void)out; (void)outLen; (void)overlapped;
+    if (returned) *returned = 0;
+    return TRUE;
+}
+
+static inline BOOL DeleteFileA(const char* path) {
+    return unlink(path) == 0;
+}
+
+// rename() replaces the target, like MOVEFILE_REPLACE_EXISTING
+static inline BOOL MoveFileExA(const char* from, const char* to, DWORD flags) {
+    (void)flags;
+    return rename(from, to) == 0;
+}
+
+#endif // HOST_WINDOWS_H
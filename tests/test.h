@@ -0,0 +1,41 @@
+// test.h
+// Minimal expectation helpers shared by the host test programs.
+//
+// Each tests/test_*.c is a standalone program built with the host compiler
+// by `make test`. A failed expectation prints its location and the test
+// carries on; test_report() returns non-zero if any expectation failed, so
+// main() can simply return it.
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+#include <string.h>
+
+static int test_checks;
+static int test_failures;
+
+#define EXPECT(cond) do { \
+    test_checks++; \
+    if (!(cond)) { \
+        test_failures++; \
+        fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+#define EXPECT_STR(actual, expected) do { \
+    const char* a_ = (actual); \
+    const char* e_ = (expected); \
+    test_checks++; \
+    if (!a_ || strcmp(a_, e_) != 0) { \
+        test_failures++; \
+        fprintf(stderr, "%s:%d: %s is \"%s\", expected \"%s\"\n", \
+                __FILE__, __LINE__, #actual, a_ ? a_ : "(null)", e_); \
+    } \
+} while (0)
+
+static int test_report(const char* name) {
+    printf("%s: %d checks, %d failed\n", name, test_checks, test_failures);
+    return test_failures ? 1 : 0;
+}
+
+#endif // TEST_H
@@ -0,0 +1,120 @@
+// test_backoff.c
+// Full-jitter delay bounds and spread, and circuit breaker transitions.
+#include "backoff.h"
+#include "test.h"
+
+#define SAMPLES 100000
+
+static unsigned ceiling_of(unsigned baseMs, unsigned capMs, int n) {
+    unsigned long long c = baseMs;
+    for (int i = 0; i < n && c < capMs; i++) c *= 2;
+    return (unsigned)(c < capMs ? c : capMs);
+}
+
+static void test_jitter_bounds(void) {
+    unsigned rng = 12345;
+    long outside = 0;
+
+    // Every attempt count, including ones that would overflow base * 2^n
+    for (int n = 0; n <= 64; n++) {
+        unsigned ceiling = ceiling_of(2000, 300000, n);
+        for (int i = 0; i < 2000; i++) {
+            if (backoff_jitter(2000, 300000, n, &rng) > ceiling) outside++;
+        }
+    }
+    EXPECT(outside == 0);
+    EXPECT(ceiling_of(2000, 300000, 7) == 256000);
+    EXPECT(ceiling_of(2000, 300000, 8) == 300000);
+
+    // A cap below the base wins; a zero base gives no delay at all
+    for (int i = 0; i < 1000; i++) {
+        EXPECT(backoff_jitter(5000, 1000, 0, &rng) <= 1000);
+        EXPECT(backoff_jitter(0, 1000, 10, &rng) == 0);
+    }
+}
+
+// Delays cover the whole range [0, ceiling] evenly
+static void test_jitter_spread(void) {
+    unsigned rng = 777;
+    const unsigned ceiling = 16000;
+    unsigned lo = ~0u, hi = 0;
+    long buckets[10] = {0};
+    double sum = 0;
+
+    for (int i = 0; i < SAMPLES; i++) {
+        unsigned d = backoff_jitter(1000, ceiling, 4, &rng);
+        if (d < lo) lo = d;
+        if (d > hi) hi = d;
+        sum += d;
+        buckets[d * 10 / (ceiling + 1)]++;
+    }
+    double mean = sum / SAMPLES;
+    printf("  n=4: min %u, max %u, mean %.0f (ceiling %u)\n", lo, hi, mean, ceiling);
+    EXPECT(lo < ceiling / 100);
+    EXPECT(hi > ceiling - ceiling / 100);
+    EXPECT(mean > ceiling * 0.48 && mean < ceiling * 0.52);
+    for (int b = 0; b < 10; b++) {
+        EXPECT(buckets[b] > SAMPLES / 10 * 9 / 10 && buckets[b] < SAMPLES / 10 * 11 / 10);
+    }
+}
+
+// Endpoints that failed together do not retry in lockstep
+static void test_jitter_decorrelated(void) {
+    unsigned a = 1, b = 2;
+    int same = 0;
+    for (int i = 0; i < 1000; i++) {
+        if (backoff_jitter(2000, 300000, 5, &a) == backoff_jitter(2000, 300000, 5, &b)) same++;
+    }
+    EXPECT(same < 5);
+
+    // A zero state is replaced rather than sticking at zero
+    unsigned zero = 0;
+    EXPECT(backoff_random(&zero) != 0);
+    EXPECT(zero != 0);
+}
+
+static void test_breaker(void) {
+    Breaker b;
+    breaker_init(&b);
+    EXPECT(b.state == BREAKER_CLOSED);
+    EXPECT(!breaker_probe(&b));
+
+    // Opens on the threshold-th consecutive error; a success in between resets the count
+    EXPECT(breaker_record(&b, 3, 1) == BREAKER_UNCHANGED);
+    EXPECT(breaker_record(&b, 3, 1) == BREAKER_UNCHANGED);
+    EXPECT(breaker_record(&b, 3, 0) == BREAKER_UNCHANGED);
+    EXPECT(b.errors == 0);
+    EXPECT(breaker_record(&b, 3, 1) == BREAKER_UNCHANGED);
+    EXPECT(breaker_record(&b, 3, 1) == BREAKER_UNCHANGED);
+    EXPECT(breaker_record(&b, 3, 1) == BREAKER_OPENED);
+    EXPECT(b.state == BREAKER_OPEN);
+
+    // A result still in flight when it opened changes nothing
+    EXPECT(breaker_record(&b, 3, 1) == BREAKER_UNCHANGED);
+    EXPECT(b.state == BREAKER_OPEN);
+
+    // Failed probe: open again straight away, whatever the count
+    EXPECT(breaker_probe(&b));
+    EXPECT(b.state == BREAKER_HALF_OPEN);
+    EXPECT(!breaker_probe(&b));
+    EXPECT(breaker_record(&b, 3, 1) == BREAKER_OPENED);
+    EXPECT(b.state == BREAKER_OPEN);
+
+    // Successful probe closes it
+    EXPECT(breaker_probe(&b));
+    EXPECT(breaker_record(&b, 3, 0) == BREAKER_CLOSED_AGAIN);
+    EXPECT(b.state == BREAKER_CLOSED && b.errors == 0);
+
+    // Threshold 0 never opens
+    breaker_init(&b);
+    for (int i = 0; i < 100; i++) EXPECT(breaker_record(&b, 0, 1) == BREAKER_UNCHANGED);
+    EXPECT(b.state == BREAKER_CLOSED);
+}
+
+int main(void) {
+    test_jitter_bounds();
+    test_jitter_spread();
+    test_jitter_decorrelated();
+    test_breaker();
+    return test_report("backoff");
+}
@@ -0,0 +1,350 @@
+// test_check.c
+// Drives the check state machine through a scripted fake transport.
+#include "check.h"
+#include "test.h"
+#include <stdlib.h>
+
+// --- Fake transport ---
+
+typedef struct {
+    // Script
+    const char* body;
+    size_t bodyLen;
+    unsigned long status;
+    int failSends;           // Number of sends that fail before one succeeds
+    int failReceive;         // Fail every receive instead of returning headers
+    size_t chunk;            // Most bytes reported available per query
+    size_t errorAfter;       // Fail the query once this many body bytes were read (0 = never)
+    int async;               // Complete every operation later through check_step()
+
+    // Observed
+    size_t pos;
+    int sends;
+    int waits;
+    unsigned lastDelay;
+    int closes;
+    int finished;
+    CheckEvent pending;
+    int hasPending;
+} Fake;
+
+static int fake_complete(CheckRequest* req, CheckEvent* ev) {
+    Fake* f = (Fake*)req->context;
+    if (!f->async) return CHECK_OP_DONE;
+    f->pending = *ev;
+    f->hasPending = 1;
+    return CHECK_OP_PENDING;
+}
+
+static int fake_send(CheckRequest* req, CheckEvent* ev) {
+    Fake* f = (Fake*)req->context;
+    f->sends++;
+    f->pos = 0;
+    if (f->failSends > 0) {
+        f->failSends--;
+        ev->type = CHECK_EV_ERROR;
+        ev->error = 12029;
+    } else {
+        ev->type = CHECK_EV_SENT;
+    }
+    return fake_complete(req, ev);
+}
+
+static int fake_receive(CheckRequest* req, CheckEvent* ev) {
+    Fake* f = (Fake*)req->context;
+    if (f->failReceive) {
+        ev->type = CHECK_EV_ERROR;
+        ev->error = 12002;
+    } else {
+        ev->type = CHECK_EV_HEADERS;
+        ev->status = f->status;
+    }
+    return fake_complete(req, ev);
+}
+
+static int fake_query(CheckRequest* req, CheckEvent* ev) {
+    Fake* f = (Fake*)req->context;
+    if (f->errorAfter && f->pos >= f->errorAfter) {
+        ev->type = CHECK_EV_ERROR;
+        ev->error = 12030;
+        return fake_complete(req, ev);
+    }
+    size_t left = f->bodyLen - f->pos;
+    ev->type = CHECK_EV_DATA_AVAILABLE;
+    ev->size = left < f->chunk ? left : f->chunk;
+    return fake_complete(req, ev);
+}
+
+static int fake_read(CheckRequest* req, char* buf, size_t len, CheckEvent* ev) {
+    Fake* f = (Fake*)req->context;
+    size_t left = f->bodyLen - f->pos;
+    if (len > left) len = left;
+    memcpy(buf, f->body + f->pos, len);
+    f->pos += len;
+    ev->type = CHECK_EV_READ_COMPLETE;
+    ev->size = len;
+    return fake_complete(req, ev);
+}
+
+static int fake_wait_retry(CheckRequest* req, unsigned delayMs, CheckEvent* ev) {
+    Fake* f = (Fake*)req->context;
+    f->waits++;
+    f->lastDelay = delayMs;
+    ev->type = CHECK_EV_RETRY_TIMER;
+    return fake_complete(req, ev);
+}
+
+static void fake_close(CheckRequest* req) {
+    ((Fake*)req->context)->closes++;
+}
+
+static void fake_finished(CheckRequest* req) {
+    ((Fake*)req->context)->finished++;
+}
+
+static const CheckTransport fakeTransport = {
+    fake_send, fake_receive, fake_query, fake_read, fake_wait_retry, fake_close, fake_finished
+};
+
+static void fake_script(Fake* f, const char* body, unsigned long status) {
+    memset(f, 0, sizeof(*f));
+    f->body = body;
+    f->bodyLen = strlen(body);
+    f->status = status;
+    f->chunk = 7;
+}
+
+// Runs a check to completion, delivering pending completions as a real
+// transport would from its callback
+static void run(CheckRequest* req, Fake* f, CheckBuffer* body, int maxAttempts) {
+    check_init(req, &fakeTransport, f, body, maxAttempts, 2000);
+    check_start(req);
+    int guard = 0;
+    while (f->async && f->hasPending && !f->finished && guard++ < 100000) {
+        CheckEvent ev = f->pending;
+        f->hasPending = 0;
+        check_step(req, &ev);
+    }
+}
+
+static const char* okBody = "<result>success</result><message>hello world</message>";
+
+// --- Tests ---
+
+static void test_body(int async) {
+    CheckRequest req;
+    CheckBuffer body;
+    Fake f;
+    check_buffer_init(&body, 5000);
+    EXPECT(body.data == NULL);
+
+    fake_script(&f, okBody, 200);
+    f.async = async;
+    run(&req, &f, &body, 3);
+    EXPECT(f.finished == 1);
+    EXPECT(req.state == CHECK_DONE);
+    EXPECT(req.outcome == CHECK_OUTCOME_BODY);
+    EXPECT(req.statusCode == 200);
+    EXPECT(req.attempt == 1);
+    EXPECT(f.closes == 1);
+    EXPECT(!body.truncated && !req.stoppedEarly && !req.readFailed);
+    EXPECT_STR(body.data, okBody);
+
+    // The buffer is reused by the next check without reallocating
+    char* data = body.data;
+    fake_script(&f, "<result>fail</result>", 200);
+    f.async = async;
+    run(&req, &f, &body, 3);
+    EXPECT(body.data == data);
+    EXPECT_STR(body.data, "<result>fail</result>");
+    check_buffer_free(&body);
+}
+
+static void test_retries(int async) {
+    CheckRequest req;
+    CheckBuffer body;
+    Fake f;
+    check_buffer_init(&body, 5000);
+
+    fake_script(&f, okBody, 200);
+    f.async = async;
+    f.failSends = 2;
+    run(&req, &f, &body, 3);
+    EXPECT(f.finished == 1);
+    EXPECT(req.outcome == CHECK_OUTCOME_BODY);
+    EXPECT(req.attempt == 3);
+    EXPECT(f.sends == 3);
+    EXPECT(f.waits == 2);
+    EXPECT(f.lastDelay == 2000);
+    EXPECT_STR(body.data, okBody);
+
+    fake_script(&f, okBody, 200);
+    f.async = async;
+    f.failSends = 5;
+    run(&req, &f, &body, 3);
+    EXPECT(f.finished == 1);
+    EXPECT(req.outcome == CHECK_OUTCOME_NETWORK_ERROR);
+    EXPECT(req.attempt == 3);
+    EXPECT(f.waits == 2);
+    EXPECT(req.error == 12029);
+    EXPECT_STR(req.errorMessage, "Request failed: 12029");
+
+    fake_script(&f, okBody, 200);
+    f.async = async;
+    f.failReceive = 1;
+    run(&req, &f, &body, 2);
+    EXPECT(req.outcome == CHECK_OUTCOME_NETWORK_ERROR);
+    EXPECT(req.attempt == 2);
+    EXPECT_STR(req.errorMessage, "No response: 12002");
+    check_buffer_free(&body);
+}
+
+static void test_status(void) {
+    CheckRequest req;
+    CheckBuffer body;
+    Fake f;
+    check_buffer_init(&body, 5000);
+
+    // HTTP errors are answers, not retried
+    fake_script(&f, okBody, 503);
+    run(&req, &f, &body, 3);
+    EXPECT(f.finished == 1);
+    EXPECT(req.outcome == CHECK_OUTCOME_HTTP_ERROR);
+    EXPECT(req.statusCode == 503);
+    EXPECT(req.attempt == 1);
+    EXPECT(f.pos == 0);
+    EXPECT_STR(req.errorMessage, "HTTP 503");
+
+    fake_script(&f, okBody, 304);
+    run(&req, &f, &body, 3);
+    EXPECT(req.outcome == CHECK_OUTCOME_NOT_MODIFIED);
+    EXPECT(req.statusCode == 304);
+    EXPECT(body.len == 0);
+    EXPECT(f.closes == 1);
+    check_buffer_free(&body);
+}
+
+static void test_truncation(void) {
+    static char big[10000];
+    CheckRequest req;
+    CheckBuffer body;
+    Fake f;
+    memset(big, 'x', sizeof(big) - 1);
+    check_buffer_init(&body, 5000);
+
+    fake_script(&f, big, 200);
+    f.chunk = 1500;
+    run(&req, &f, &body, 3);
+    EXPECT(req.outcome == CHECK_OUTCOME_BODY);
+    EXPECT(body.len == 5000);
+    EXPECT(body.cap == 5000);
+    EXPECT(body.truncated);
+    EXPECT(strlen(body.data) == 5000);
+    // The rest was drained so the connection can be reused
+    EXPECT(f.pos == sizeof(big) - 1);
+    check_buffer_free(&body);
+}
+
+static int stopAfter;
+static size_t seen;
+
+static int stop_sink(CheckRequest* req, const char* data, size_t len) {
+    seen += len;
+    return seen >= (size_t)stopAfter;
+}
+
+static void test_stop_early(void) {
+    CheckRequest req;
+    CheckBuffer body;
+    Fake f;
+    check_buffer_init(&body, 5000);
+
+    fake_script(&f, okBody, 200);
+    check_init(&req, &fakeTransport, &f, &body, 3, 2000);
+    req.onBody = stop_sink;
+    stopAfter = 24;
+    seen = 0;
+    check_start(&req);
+    EXPECT(f.finished == 1);
+    EXPECT(req.outcome == CHECK_OUTCOME_BODY);
+    EXPECT(req.stoppedEarly && !req.readFailed);
+    EXPECT(body.len == 28);   // Four 7-byte chunks
+    EXPECT(f.pos < f.bodyLen);
+    EXPECT(f.closes == 1);
+    check_buffer_free(&body);
+}
+
+static void test_error_mid_body(void) {
+    CheckRequest req;
+    CheckBuffer body;
+    Fake f;
+    check_buffer_init(&body, 5000);
+
+    // A failure while reading keeps what arrived and is not retried
+    fake_script(&f, okBody, 200);
+    f.errorAfter = 14;
+    run(&req, &f, &body, 3);
+    EXPECT(f.finished == 1);
+    EXPECT(req.outcome == CHECK_OUTCOME_BODY);
+    EXPECT(req.readFailed);
+    EXPECT(req.attempt == 1);
+    EXPECT(body.len == 14);
+    EXPECT(strncmp(body.data, okBody, 14) == 0);
+    check_buffer_free(&body);
+}
+
+static void test_stale_events(void) {
+    CheckRequest req;
+    CheckBuffer body;
+    Fake f;
+    check_buffer_init(&body, 5000);
+
+    fake_script(&f, okBody, 200);
+    f.async = 1;
+    check_init(&req, &fakeTransport, &f, &body, 3, 2000);
+    check_start(&req);
+    EXPECT(req.state == CHECK_SENDING);
+
+    // Completions that do not match the current state are ignored
+    CheckEvent stale = {0};
+    stale.type = CHECK_EV_READ_COMPLETE;
+    stale.size = 5;
+    check_step(&req, &stale);
+    stale.type = CHECK_EV_RETRY_TIMER;
+    check_step(&req, &stale);
+    EXPECT(req.state == CHECK_SENDING);
+    EXPECT(f.sends == 1);
+    EXPECT(body.len == 0);
+    check_buffer_free(&body);
+}
+
+static void test_buffer(void) {
+    CheckBuffer buf;
+    check_buffer_init(&buf, 10);
+    check_buffer_append(&buf, "hello", 5);
+    check_buffer_append(&buf, " world", 6);
+    EXPECT(buf.len == 10);
+    EXPECT(buf.truncated);
+    EXPECT_STR(buf.data, "hello worl");
+    check_buffer_reset(&buf);
+    EXPECT(buf.len == 0 && !buf.truncated);
+    EXPECT_STR(buf.data, "");
+    check_buffer_free(&buf);
+    EXPECT(buf.data == NULL && buf.cap == 0);
+
+    EXPECT_STR(check_state_name(CHECK_RETRY_WAIT), "retry-wait");
+}
+
+int main(void) {
+    test_body(0);
+    test_body(1);
+    test_retries(0);
+    test_retries(1);
+    test_status();
+    test_truncation();
+    test_stop_early();
+    test_error_mid_body();
+    test_stale_events();
+    test_buffer();
+    return test_report("check");
+}
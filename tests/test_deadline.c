@@ -0,0 +1,224 @@
+// test_deadline.c
+// Deadline heap ordering, fixed-rate grid arithmetic, and a virtual-clock
+// run of thousands of endpoints through the same loop as RefreshTimer.
+#include "deadline.h"
+#include "test.h"
+
+typedef unsigned long long U64;
+
+static U64 rng = 88172645463325252ULL;
+
+static U64 next_random(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+}
+
+// --- Heap ---
+
+static void test_heap_basics(void) {
+    Scheduler s;
+    U64 due;
+    EXPECT(sched_init(&s, 8));
+    EXPECT(!sched_next(&s, &due));
+    EXPECT(sched_pop_due(&s, ~0ULL, &due) == -1);
+
+    sched_set(&s, 3, 300);
+    sched_set(&s, 1, 100);
+    sched_set(&s, 5, 500);
+    sched_set(&s, 2, 200);
+    EXPECT(sched_next(&s, &due) && due == 100);
+    EXPECT(sched_due(&s, 5, &due) && due == 500);
+    EXPECT(!sched_due(&s, 4, &due));
+
+    // Moving an item earlier and later, and cancelling one
+    sched_set(&s, 5, 50);
+    sched_set(&s, 1, 400);
+    sched_cancel(&s, 2);
+    sched_cancel(&s, 2);
+    EXPECT(s.count == 3);
+
+    EXPECT(sched_pop_due(&s, 49, &due) == -1);
+    EXPECT(sched_pop_due(&s, 1000, &due) == 5 && due == 50);
+    EXPECT(sched_pop_due(&s, 1000, &due) == 3 && due == 300);
+    EXPECT(sched_pop_due(&s, 1000, &due) == 1 && due == 400);
+    EXPECT(sched_pop_due(&s, 1000, &due) == -1);
+    EXPECT(!sched_due(&s, 5, &due));
+    sched_free(&s);
+}
+
+// Random sets, moves, cancels and pops against a brute-force table
+static void test_heap_random(void) {
+    enum { ITEMS = 400 };
+    Scheduler s;
+    U64 ref[ITEMS];
+    int has[ITEMS] = {0};
+    long bad = 0;
+
+    EXPECT(sched_init(&s, ITEMS));
+    for (long op = 0; op < 400000; op++) {
+        int item = (int)(next_random() % ITEMS);
+        int kind = (int)(next_random() % 4);
+        U64 now = next_random() % 100000;
+
+        if (kind < 2) {
+            U64 due = next_random() % 100000;
+            sched_set(&s, item, due);
+            ref[item] = due;
+            has[item] = 1;
+        } else if (kind == 2) {
+            sched_cancel(&s, item);
+            has[item] = 0;
+        } else {
+            U64 due, best = ~0ULL;
+            int got = sched_pop_due(&s, now, &due);
+            for (int i = 0; i < ITEMS; i++) {
+                if (has[i] && ref[i] < best) best = ref[i];
+            }
+            if (best <= now) {
+                if (got < 0 || due != best || ref[got] != best) bad++;
+                if (got >= 0) has[got] = 0;
+            } else if (got != -1) {
+                bad++;
+            }
+        }
+
+        int count = 0;
+        for (int i = 0; i < ITEMS; i++) count += has[i];
+        if (count != s.count) bad++;
+    }
+    EXPECT(bad == 0);
+    sched_free(&s);
+}
+
+// --- Fixed-rate grid ---
+
+static void test_next_rate(void) {
+    unsigned missed = 99;
+    EXPECT(sched_next_rate(1000, 500, 1200, &missed) == 1500 && missed == 0);
+    // A deadline landing exactly on now is already due: skip it
+    EXPECT(sched_next_rate(1000, 500, 1500, &missed) == 2000 && missed == 1);
+    // Grid points 1500 to 3000 have all passed: four skipped, the next one stays on the grid
+    EXPECT(sched_next_rate(1000, 500, 3200, &missed) == 3500 && missed == 4);
+    EXPECT(sched_next_rate(1000, 500, 2999, &missed) == 3000 && missed == 3);
+    EXPECT(sched_next_rate(1000, 500, 0, NULL) == 1500);
+    EXPECT(sched_next_rate(1000, 0, 1005, &missed) == 1006);
+}
+
+// --- Virtual clock ---
+
+typedef struct {
+    U64 runs;
+    U64 wakeups;            // Timer callbacks that found work
+    U64 lateTotal;
+    U64 lateMax;
+    U64 missed;
+    U64 offGrid;            // Fixed rate: deadlines not on the endpoint's grid
+    U64 tooSoon;            // Fixed delay: runs closer than interval to the previous finish
+} SimStats;
+
+// Runs endpoints for a simulated day. The timer fires 0-40 ms after the
+// earliest deadline, each check takes 50 ms to 9 s, and stallAt (if non-zero)
+// suspends the machine for stallMs, as a sleeping laptop would.
+static SimStats simulate(SchedMode mode, int endpoints, U64 stallAt, U64 stallMs) {
+    enum { MAX_ENDPOINTS = 5000 };
+    const U64 interval = 60000;
+    const U64 end = 24ULL * 3600 * 1000;
+    static U64 phase[MAX_ENDPOINTS];
+    static U64 finishedAt[MAX_ENDPOINTS];
+    Scheduler s, finish;
+    SimStats st = {0};
+    U64 now = 0, due;
+    int stalled = 0;
+
+    sched_init(&s, endpoints);
+    sched_init(&finish, endpoints);
+    for (int i = 0; i < endpoints; i++) {
+        phase[i] = next_random() % interval;
+        finishedAt[i] = 0;
+        sched_set(&s, i, phase[i]);
+    }
+
+    while (now < end) {
+        U64 next = ~0ULL;
+        if (sched_next(&s, &due)) next = due;
+        if (sched_next(&finish, &due) && due < next) next = due;
+        now = next + next_random() % 41;
+        if (stallAt && !stalled && now >= stallAt) {
+            now += stallMs;
+            stalled = 1;
+        }
+
+        // Finished checks: fixed delay schedules the next one from here
+        int item;
+        while ((item = sched_pop_due(&finish, now, &due)) >= 0) {
+            finishedAt[item] = due;
+            if (mode == SCHED_FIXED_DELAY) sched_set(&s, item, due + interval);
+        }
+
+        int any = 0;
+        while ((item = sched_pop_due(&s, now, &due)) >= 0) {
+            unsigned missed = 0;
+            U64 late = now - due;
+            any = 1;
+            st.runs++;
+            st.lateTotal += late;
+            if (late > st.lateMax) st.lateMax = late;
+
+            if (mode == SCHED_FIXED_RATE) {
+                if ((due - phase[item]) % interval != 0) st.offGrid++;
+                U64 following = sched_next_rate(due, interval, now, &missed);
+                st.missed += missed;
+                sched_set(&s, item, following);
+            } else {
+                if (finishedAt[item] && now < finishedAt[item] + interval) st.tooSoon++;
+                sched_set(&s, item, now + 10 * interval);   // Fallback, moved when the check finishes
+            }
+            sched_set(&finish, item, now + 50 + next_random() % 8951);
+        }
+        if (any) st.wakeups++;
+    }
+    sched_free(&s);
+    sched_free(&finish);
+    return st;
+}
+
+static void test_virtual_clock(void) {
+    const int endpoints = 1000;
+    const U64 perEndpoint = 24 * 60;
+
+    SimStats rate = simulate(SCHED_FIXED_RATE, endpoints, 0, 0);
+    printf("  fixed rate:  %llu runs, %llu wakeups, late mean %.1f ms max %llu ms\n",
+           rate.runs, rate.wakeups, (double)rate.lateTotal / rate.runs, rate.lateMax);
+    // Every deadline stays on its grid: no drift whatever the check latency
+    EXPECT(rate.offGrid == 0);
+    EXPECT(rate.missed == 0);
+    EXPECT(rate.lateMax <= 40);
+    EXPECT(rate.runs >= endpoints * (perEndpoint - 1) && rate.runs <= endpoints * (perEndpoint + 1));
+    // Deadlines that fall due together share one wakeup
+    EXPECT(rate.wakeups < rate.runs);
+
+    SimStats delay = simulate(SCHED_FIXED_DELAY, endpoints, 0, 0);
+    printf("  fixed delay: %llu runs, %llu wakeups, late mean %.1f ms max %llu ms\n",
+           delay.runs, delay.wakeups, (double)delay.lateTotal / delay.runs, delay.lateMax);
+    EXPECT(delay.tooSoon == 0);
+    EXPECT(delay.lateMax <= 40);
+    EXPECT(delay.runs < rate.runs);
+
+    // After a 5-minute stall each endpoint runs once, not once per missed period
+    SimStats stall = simulate(SCHED_FIXED_RATE, endpoints, 6ULL * 3600 * 1000, 5 * 60000);
+    printf("  fixed rate, 5 min stall: %llu runs, %llu periods skipped, late max %llu ms\n",
+           stall.runs, stall.missed, stall.lateMax);
+    EXPECT(stall.offGrid == 0);
+    EXPECT(stall.missed >= (U64)endpoints * 4 && stall.missed <= (U64)endpoints * 5);
+    EXPECT(stall.runs <= rate.runs - (U64)endpoints * 4);
+}
+
+int main(void) {
+    test_heap_basics();
+    test_heap_random();
+    test_next_rate();
+    test_virtual_clock();
+    return test_report("deadline");
+}
@@ -0,0 +1,151 @@
+// test_decoder.c
+// Runs each response decoder over bodies delivered in chunks of every size.
+#include "decoder.h"
+#include "test.h"
+
+typedef struct {
+    DecodeVerdict verdict;
+    char message[256];
+    const char* reason;
+    int stopped;              // feed() ended the download early
+    size_t received;          // Bytes of the body the caller kept
+} Decoded;
+
+// Feeds body in chunks like the fetch loop, then evaluates what was received
+static Decoded decode(const DecoderConfig* cfg, unsigned long status, const char* body, size_t chunk) {
+    DecoderState st;
+    Decoded out;
+    size_t len = strlen(body);
+    size_t pos = 0;
+
+    memset(&out, 0, sizeof(out));
+    decoder_begin(&st, cfg);
+    while (pos < len) {
+        size_t n = len - pos < chunk ? len - pos : chunk;
+        pos += n;
+        if (decoder_feed(&st, body + pos - n, n)) {
+            out.stopped = 1;
+            break;
+        }
+    }
+    out.received = pos;
+    out.verdict = decoder_finish(&st, status, body, pos, out.message, sizeof(out.message), &out.reason);
+    return out;
+}
+
+static void expect_decode(const char* spec, unsigned long status, const char* body,
+                          DecodeVerdict verdict, const char* message) {
+    DecoderConfig cfg;
+    int bad = 0;
+    EXPECT(decoder_parse(spec, &cfg));
+
+    for (size_t chunk = 1; chunk <= strlen(body) + 1; chunk++) {
+        Decoded r = decode(&cfg, status, body, chunk);
+        if (r.verdict != verdict || strcmp(r.message, message) != 0) {
+            if (bad++ == 0) {
+                fprintf(stderr, "  %s \"%s\" in %zu-byte chunks: %d \"%s\"\n",
+                        spec, body, chunk, r.verdict, r.message);
+            }
+        }
+    }
+    EXPECT(bad == 0);
+}
+
+static void test_specs(void) {
+    DecoderConfig cfg;
+
+    EXPECT(decoder_parse("", &cfg));
+    EXPECT_STR(decoder_name(&cfg), "xml");
+    EXPECT(decoder_parse(NULL, &cfg));
+    EXPECT_STR(decoder_name(&cfg), "xml");
+    EXPECT(decoder_parse("json:status=UP", &cfg));
+    EXPECT_STR(decoder_name(&cfg), "json");
+    EXPECT_STR(cfg.path, "status");
+    EXPECT_STR(cfg.expect, "UP");
+    EXPECT(decoder_parse("text:All Good", &cfg));
+    EXPECT_STR(decoder_name(&cfg), "text");
+    EXPECT_STR(cfg.expect, "all good");
+    EXPECT(decoder_parse("http", &cfg));
+    EXPECT_STR(decoder_name(&cfg), "http");
+
+    // Rejected specs fall back to xml
+    const char* bad[] = { "json:", "json:=x", "json:path", "text:", "yaml", "http:x", "xml:x", "JSON:a=b" };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        EXPECT(!decoder_parse(bad[i], &cfg));
+        EXPECT_STR(decoder_name(&cfg), "xml");
+    }
+}
+
+static void test_xml(void) {
+    expect_decode("xml", 200, "<r>success</r><message>ok</message>", DECODE_SUCCESS, "ok");
+    expect_decode("xml", 200, "<result>fail</result><message>db</message>", DECODE_FAIL, "db");
+    expect_decode("xml", 200, "<html></html>", DECODE_INVALID, "No result tag");
+
+    DecoderConfig cfg;
+    decoder_parse("xml", &cfg);
+    Decoded r = decode(&cfg, 200, "<r>success</r><message>ok</message><diag>xxxxxxxxxxxxxxxx</diag>", 8);
+    EXPECT(r.stopped);
+    EXPECT(r.received == 40);
+}
+
+static void test_json(void) {
+    expect_decode("json:status=UP", 200, "{\"status\":\"up\"}", DECODE_SUCCESS, "status=up");
+    expect_decode("json:status=UP", 200, " {\"a\":[1,{\"b\":\"}\"}],\"status\" : \"DOWN\" }",
+                  DECODE_FAIL, "status=DOWN (expected UP)");
+    expect_decode("json:checks.1.state=ok", 200,
+                  "{\"checks\":[{\"state\":\"bad\"},{\"x\":null,\"state\":\"OK\"}]}",
+                  DECODE_SUCCESS, "checks.1.state=OK");
+    expect_decode("json:0.up=true", 200, "[{\"up\":true},{\"up\":false}]", DECODE_SUCCESS, "0.up=true");
+    expect_decode("json:healthy=true", 200, "{\"healthy\": true}", DECODE_SUCCESS, "healthy=true");
+    expect_decode("json:n=1", 200, "{\"n\": 1.5e3}", DECODE_FAIL, "n=1.5e3 (expected 1)");
+    expect_decode("json:s=x", 200, "{\"q\":\"a\\\"b\",\"s\":\"x\"}", DECODE_SUCCESS, "s=x");
+    expect_decode("json:a.b=1", 200, "{\"a\":{\"c\":1}}", DECODE_INVALID, "Key path not found");
+    expect_decode("json:a=1", 200, "{\"a\":", DECODE_INVALID, "Key path not found");
+    expect_decode("json:a=1", 200, "<html>", DECODE_INVALID, "Not a JSON document");
+    expect_decode("json:a=1", 200, "  ", DECODE_INVALID, "Empty response");
+
+    // json needs the whole body: it never stops the download
+    DecoderConfig cfg;
+    decoder_parse("json:a=1", &cfg);
+    Decoded r = decode(&cfg, 200, "{\"a\":1,\"b\":2}", 3);
+    EXPECT(!r.stopped);
+    EXPECT(r.verdict == DECODE_SUCCESS);
+}
+
+static void test_text(void) {
+    expect_decode("text:All Systems Go", 200, "status: all systems go!", DECODE_SUCCESS, "Found 'all systems go'");
+    expect_decode("text:all good", 200, "xx ALL GOOD", DECODE_SUCCESS, "Found 'all good'");
+    // Partial matches that must fall back rather than restart
+    expect_decode("text:aab", 200, "aaab", DECODE_SUCCESS, "Found 'aab'");
+    expect_decode("text:abab", 200, "ababab", DECODE_SUCCESS, "Found 'abab'");
+    expect_decode("text:abac", 200, "abab abax", DECODE_FAIL, "'abac' not found");
+    expect_decode("text:ok", 200, "", DECODE_INVALID, "Empty response");
+
+    DecoderConfig cfg;
+    decoder_parse("text:go", &cfg);
+    Decoded r = decode(&cfg, 200, "go xxxxxxxx", 1);
+    EXPECT(r.stopped);
+    EXPECT(r.received == 2);
+}
+
+static void test_http(void) {
+    expect_decode("http", 204, "", DECODE_SUCCESS, "HTTP 204");
+    expect_decode("http", 200, "anything", DECODE_SUCCESS, "HTTP 200");
+
+    DecoderConfig cfg;
+    decoder_parse("http", &cfg);
+    Decoded r = decode(&cfg, 302, "moved", 4);
+    EXPECT(r.verdict == DECODE_INVALID);
+    EXPECT_STR(r.reason, "Unexpected status");
+    // The status alone decides, so nothing of the body is needed
+    EXPECT(r.stopped);
+}
+
+int main(void) {
+    test_specs();
+    test_xml();
+    test_json();
+    test_text();
+    test_http();
+    return test_report("decoder");
+}
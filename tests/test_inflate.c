@@ -0,0 +1,217 @@
+// test_inflate.c
+// Decodes recorded compressed bodies in tests/data cut at every byte
+// boundary, and checks that corrupt streams are rejected.
+//
+// The vectors were produced with Python's gzip and zlib modules (level 9,
+// gzip mtime 0) from status.xml, a small status document, and
+// diagnostics.xml, ~96 KB of log entries behind the verdict, which crosses
+// the 32 KB window and the 64 KB stored-block limit:
+//   *.gz                          gzip with FNAME (empty.gz: no content)
+//   status-fields.xml.gz          gzip with FEXTRA, FNAME, FCOMMENT and FHCRC
+//   *.zlib, *.deflate             zlib-wrapped and raw deflate
+//   status-fixed.xml.zlib         fixed Huffman codes only (Z_FIXED)
+//   diagnostics-stored.xml.zlib   stored blocks only (level 0)
+//   diagnostics-huffman.xml.deflate  literals only (Z_HUFFMAN_ONLY)
+#include "inflate.h"
+#include "test.h"
+#include <stdlib.h>
+
+#ifndef TEST_DATA
+#define TEST_DATA "tests/data/"
+#endif
+
+#define SPLIT_ALL_MAX 4096   // Two-way splits at every offset up to this compressed size
+
+typedef struct {
+    unsigned char* data;
+    size_t len;
+} Blob;
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t cap;
+    size_t stopAt;           // Ask the inflater to stop once this much arrived (0 = never)
+    int calls;
+} Output;
+
+static Blob load(const char* name) {
+    char path[256];
+    Blob b = { NULL, 0 };
+    snprintf(path, sizeof(path), "%s%s", TEST_DATA, name);
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return b;
+    }
+    fseek(f, 0, SEEK_END);
+    b.len = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    b.data = (unsigned char*)malloc(b.len + 1);
+    b.len = fread(b.data, 1, b.len, f);
+    fclose(f);
+    return b;
+}
+
+static int collect(void* ctx, const char* data, size_t len) {
+    Output* out = (Output*)ctx;
+    if (out->len + len > out->cap) {
+        out->cap = (out->len + len) * 2;
+        out->data = (char*)realloc(out->data, out->cap);
+    }
+    memcpy(out->data + out->len, data, len);
+    out->len += len;
+    out->calls++;
+    return out->stopAt && out->len >= out->stopAt;
+}
+
+// Feeds the stream as a first piece of split bytes, then pieces of chunk
+// bytes (random sizes up to -chunk when chunk is negative)
+static InflateStatus run(InflateFormat format, const Blob* in, size_t split, long chunk,
+                         Output* out, const char** error) {
+    Inflater z;
+    size_t pos = 0;
+    InflateStatus st = INFLATE_MORE;
+
+    memset(out, 0, sizeof(*out));
+    inflate_init(&z, format);
+    while (st == INFLATE_MORE && pos < in->len) {
+        size_t n;
+        if (pos == 0 && split) n = split;
+        else if (chunk < 0) n = (size_t)(rand() % -chunk) + 1;
+        else n = (size_t)chunk;
+        if (n > in->len - pos) n = in->len - pos;
+        st = inflate_feed(&z, in->data + pos, n, collect, out);
+        pos += n;
+    }
+    if (st == INFLATE_MORE) st = inflate_feed(&z, "", 0, collect, out);
+    if (st == INFLATE_DONE && inflate_total_out(&z) != out->len) st = INFLATE_ERROR;
+    *error = z.error;
+    inflate_free(&z);
+    return st;
+}
+
+static int same(const Output* out, const Blob* plain) {
+    return out->len == plain->len && (plain->len == 0 || memcmp(out->data, plain->data, plain->len) == 0);
+}
+
+// One vector, whole, byte by byte, in random chunks and split in two pieces
+static void expect_vector(const char* name, const char* plainName, InflateFormat format) {
+    Blob in = load(name);
+    Blob plain = load(plainName);
+    Output out;
+    const char* error;
+    long bad = 0;
+    EXPECT(in.data != NULL && plain.data != NULL);
+    if (!in.data || !plain.data) return;
+
+    long chunks[] = { (long)in.len, 1, 2, 3, 7, 1024, -5, -700, -8192 };
+    for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        if (run(format, &in, 0, chunks[i], &out, &error) != INFLATE_DONE || !same(&out, &plain)) {
+            fprintf(stderr, "  %s in chunks of %ld: %s\n", name, chunks[i], error ? error : "wrong output");
+            bad++;
+        }
+        free(out.data);
+    }
+
+    // Larger vectors are already cut everywhere by the 1-byte run; split them
+    // across the headers and at ~500 offsets spread over the rest
+    size_t step = in.len <= SPLIT_ALL_MAX ? 1 : in.len / 500 + 1;
+    for (size_t split = 1; split < in.len; split += split < 64 ? 1 : step) {
+        if (run(format, &in, split, (long)in.len, &out, &error) != INFLATE_DONE || !same(&out, &plain)) {
+            if (bad++ < 5) fprintf(stderr, "  %s split at %zu: %s\n", name, split, error ? error : "wrong output");
+        }
+        free(out.data);
+    }
+    EXPECT(bad == 0);
+    free(in.data);
+    free(plain.data);
+}
+
+static void test_vectors(void) {
+    expect_vector("status.xml.gz", "status.xml", INFLATE_GZIP);
+    expect_vector("status-fields.xml.gz", "status.xml", INFLATE_GZIP);
+    expect_vector("status.xml.zlib", "status.xml", INFLATE_DEFLATE);
+    expect_vector("status.xml.deflate", "status.xml", INFLATE_DEFLATE);
+    expect_vector("status-fixed.xml.zlib", "status.xml", INFLATE_DEFLATE);
+    expect_vector("diagnostics.xml.gz", "diagnostics.xml", INFLATE_GZIP);
+    expect_vector("diagnostics-stored.xml.zlib", "diagnostics.xml", INFLATE_DEFLATE);
+    expect_vector("diagnostics-huffman.xml.deflate", "diagnostics.xml", INFLATE_DEFLATE);
+
+    Blob empty = load("empty.gz");
+    Output out;
+    const char* error;
+    EXPECT(run(INFLATE_GZIP, &empty, 0, 1, &out, &error) == INFLATE_DONE);
+    EXPECT(out.len == 0);
+    free(out.data);
+    free(empty.data);
+}
+
+// Flips one byte of a vector and expects the given error
+static void expect_corrupt(const char* name, InflateFormat format, long offset, const char* expected) {
+    Blob in = load(name);
+    Output out;
+    const char* error = NULL;
+    if (!in.data) {
+        EXPECT(in.data != NULL);
+        return;
+    }
+    size_t at = offset < 0 ? in.len + offset : (size_t)offset;
+    in.data[at] ^= 0x01;
+    EXPECT(run(format, &in, 0, 3, &out, &error) == INFLATE_ERROR);
+    EXPECT_STR(error, expected);
+    free(out.data);
+    free(in.data);
+}
+
+static void test_corrupt(void) {
+    expect_corrupt("status.xml.gz", INFLATE_GZIP, 0, "not gzip data");
+    expect_corrupt("status.xml.gz", INFLATE_GZIP, -8, "gzip CRC mismatch");
+    expect_corrupt("status.xml.gz", INFLATE_GZIP, -4, "gzip length mismatch");
+    expect_corrupt("status.xml.zlib", INFLATE_DEFLATE, -1, "zlib checksum mismatch");
+    expect_corrupt("diagnostics-stored.xml.zlib", INFLATE_DEFLATE, 4, "stored block length mismatch");
+
+    // An uncompressed body sent with Content-Encoding: gzip
+    Blob html = { (unsigned char*)"<html>not gzip</html>", 21 };
+    Output out;
+    const char* error = NULL;
+    EXPECT(run(INFLATE_GZIP, &html, 0, 21, &out, &error) == INFLATE_ERROR);
+    EXPECT_STR(error, "not gzip data");
+    free(out.data);
+
+    // Truncated streams never report DONE
+    Blob in = load("diagnostics.xml.gz");
+    in.len /= 2;
+    EXPECT(run(INFLATE_GZIP, &in, 0, 100, &out, &error) == INFLATE_MORE);
+    EXPECT(out.len > 0);
+    free(out.data);
+    free(in.data);
+}
+
+// The sink can end decoding once the verdict is in, like the status parser
+static void test_stop(void) {
+    Blob in = load("diagnostics.xml.gz");
+    Blob plain = load("diagnostics.xml");
+    Inflater z;
+    Output out;
+    memset(&out, 0, sizeof(out));
+    out.stopAt = 1000;
+
+    // Output reaches the sink a window at a time, so it stops within 32 KB
+    inflate_init(&z, INFLATE_GZIP);
+    EXPECT(inflate_feed(&z, in.data, in.len, collect, &out) == INFLATE_STOPPED);
+    EXPECT(out.len >= 1000 && out.len <= INFLATE_WINDOW && out.len < plain.len);
+    EXPECT(inflate_feed(&z, in.data, in.len, collect, &out) == INFLATE_STOPPED);
+    inflate_free(&z);
+    free(out.data);
+    free(in.data);
+    free(plain.data);
+}
+
+int main(void) {
+    srand(22);
+    test_vectors();
+    test_corrupt();
+    test_stop();
+    return test_report("inflate");
+}
@@ -0,0 +1,171 @@
+// test_intern.c
+// Interned string IDs, reference counting, slot reuse, chain growth and
+// arena compaction, checked against a brute-force reference count.
+#include "intern.h"
+#include "test.h"
+#include <stdlib.h>
+
+static unsigned add(InternTable* t, const char* s) {
+    return intern_add(t, s, strlen(s));
+}
+
+static void test_basics(void) {
+    InternTable t;
+    intern_init(&t);
+    EXPECT_STR(intern_get(&t, INTERN_EMPTY), "");
+    EXPECT(add(&t, "") == INTERN_EMPTY);
+    EXPECT(intern_add(&t, NULL, 5) == INTERN_EMPTY);
+
+    // One ID per distinct string, whatever the source buffer
+    unsigned ok = add(&t, "OK");
+    unsigned down = add(&t, "Connection failed");
+    char copy[] = "OK!";
+    EXPECT(ok != INTERN_EMPTY && down != INTERN_EMPTY && ok != down);
+    EXPECT(intern_add(&t, copy, 2) == ok);
+    EXPECT(add(&t, "ok") != ok);
+    EXPECT_STR(intern_get(&t, ok), "OK");
+    EXPECT_STR(intern_get(&t, down), "Connection failed");
+    EXPECT(t.live == 3);
+
+    // "OK" now holds two references: the first release keeps it
+    intern_release(&t, ok);
+    EXPECT_STR(intern_get(&t, ok), "OK");
+    intern_retain(&t, ok);
+    intern_release(&t, ok);
+    intern_release(&t, ok);
+    EXPECT_STR(intern_get(&t, ok), "");
+    EXPECT(t.live == 2);
+
+    // Releasing a free slot, the empty ID or an unknown ID changes nothing
+    intern_release(&t, ok);
+    intern_release(&t, INTERN_EMPTY);
+    intern_release(&t, 12345);
+    intern_retain(&t, 12345);
+    EXPECT_STR(intern_get(&t, 12345), "");
+    EXPECT(t.live == 2);
+
+    // The freed slot is reused, and the old text is no longer found
+    unsigned again = add(&t, "Timeout");
+    EXPECT(again == ok);
+    EXPECT_STR(intern_get(&t, again), "Timeout");
+    EXPECT(add(&t, "OK") != again);
+    intern_free(&t);
+    EXPECT(intern_memory(&t) == 0);
+}
+
+static void test_long(void) {
+    InternTable t;
+    size_t len = INTERN_MAX_LEN + 100;
+    char* s = (char*)malloc(len);
+    memset(s, 'x', len);
+    intern_init(&t);
+
+    // Cut to INTERN_MAX_LEN, so anything longer with the same prefix shares it
+    unsigned id = intern_add(&t, s, len);
+    EXPECT(strlen(intern_get(&t, id)) == INTERN_MAX_LEN);
+    EXPECT(intern_add(&t, s, INTERN_MAX_LEN + 1) == id);
+    EXPECT(intern_add(&t, s, INTERN_MAX_LEN) == id);
+    EXPECT(intern_add(&t, s, INTERN_MAX_LEN - 1) != id);
+    intern_free(&t);
+    free(s);
+}
+
+// Thousands of strings grow the slots and hash chains; releasing most of
+// them compacts the arena without moving the survivors' IDs
+static void test_grow_and_compact(void) {
+    enum { COUNT = 20000 };
+    InternTable t;
+    char text[64];
+    static unsigned ids[COUNT];
+    long wrong = 0;
+    intern_init(&t);
+
+    for (int i = 0; i < COUNT; i++) {
+        snprintf(text, sizeof(text), "HTTP %d: response %d was not understood", 400 + i % 200, i);
+        ids[i] = add(&t, text);
+    }
+    EXPECT(t.live == COUNT);
+    EXPECT(t.bucketCount >= COUNT);
+    size_t before = t.arenaUsed;
+    for (int i = 0; i < COUNT; i++) {
+        snprintf(text, sizeof(text), "HTTP %d: response %d was not understood", 400 + i % 200, i);
+        if (strcmp(intern_get(&t, ids[i]), text) != 0) wrong++;
+    }
+
+    for (int i = 0; i < COUNT; i++) {
+        if (i % 10) intern_release(&t, ids[i]);
+    }
+    EXPECT(t.live == COUNT / 10);
+    EXPECT(t.arenaUsed < before / 2);
+    EXPECT(t.arenaGarbage <= t.arenaUsed);
+    for (int i = 0; i < COUNT; i += 10) {
+        snprintf(text, sizeof(text), "HTTP %d: response %d was not understood", 400 + i % 200, i);
+        if (strcmp(intern_get(&t, ids[i]), text) != 0) wrong++;
+        if (add(&t, text) != ids[i]) wrong++;
+    }
+    EXPECT(wrong == 0);
+    intern_free(&t);
+}
+
+// Random adds and releases against a count kept by hand
+static void test_random(void) {
+    enum { STRINGS = 300 };
+    InternTable t;
+    unsigned id[STRINGS];
+    int refs[STRINGS] = {0};
+    char text[STRINGS][64];
+    unsigned rng = 2463534242u;
+    long wrong = 0, compactions = 0;
+    size_t garbage = 0;
+    intern_init(&t);
+
+    for (int i = 0; i < STRINGS; i++) {
+        // Long enough that released text passes the compaction threshold
+        snprintf(text[i], sizeof(text[i]), "message %d %.*s", i, 10 + i % 40,
+                 "abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyz");
+    }
+    for (long op = 0; op < 300000; op++) {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        int i = (int)(rng % STRINGS);
+        if ((rng >> 16) % 2 == 0) {
+            unsigned got = add(&t, text[i]);
+            if (refs[i] && got != id[i]) wrong++;
+            id[i] = got;
+            refs[i]++;
+        } else if (refs[i]) {
+            intern_release(&t, id[i]);
+            refs[i]--;
+        }
+
+        unsigned live = 0;
+        for (int k = 0; k < STRINGS; k++) {
+            if (!refs[k]) continue;
+            live++;
+            if (strcmp(intern_get(&t, id[k]), text[k]) != 0) wrong++;
+        }
+        if (live != t.live) wrong++;
+        if (t.arenaGarbage < garbage) compactions++;
+        garbage = t.arenaGarbage;
+    }
+    EXPECT(wrong == 0);
+    EXPECT(compactions > 0);
+
+    // Distinct live strings never share an ID
+    for (int a = 0; a < STRINGS; a++) {
+        for (int b = a + 1; b < STRINGS; b++) {
+            if (refs[a] && refs[b] && id[a] == id[b]) wrong++;
+        }
+    }
+    EXPECT(wrong == 0);
+    intern_free(&t);
+}
+
+int main(void) {
+    test_basics();
+    test_long();
+    test_grow_and_compact();
+    test_random();
+    return test_report("intern");
+}
@@ -0,0 +1,242 @@
+// test_journal.c
+// Journal round trips, torn and corrupt tails cut off on open, appends
+// after recovery, reset, and files that are not journals.
+#include <windows.h>
+#include "journal.h"
+#include "test.h"
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <signal.h>
+
+// Layout is measured rather than assumed: DWORD is wider on the host shim
+static long headerSize;       // File header: magic and version
+static long recordHeader;     // Length and CRC before each payload
+#define RECORD_SIZE(len) (recordHeader + (long)(len))
+
+static char dir[] = "/tmp/apimonitor-journal-XXXXXX";
+static char path[MAX_PATH];
+
+typedef struct {
+    int count;
+    size_t lens[16];
+    unsigned char first[16];  // First payload byte of each record
+} Replayed;
+
+static void collect(void* ctx, const void* data, size_t len) {
+    Replayed* r = (Replayed*)ctx;
+    if (r->count < 16) {
+        r->lens[r->count] = len;
+        r->first[r->count] = len ? *(const unsigned char*)data : 0;
+    }
+    r->count++;
+}
+
+static long file_size(void) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (long)st.st_size : -1;
+}
+
+// Overwrites one byte of the file, or cuts it at offset when value is negative
+static void damage(long offset, int value) {
+    if (value < 0) {
+        EXPECT(truncate(path, offset) == 0);
+        return;
+    }
+    FILE* f = fopen(path, "r+b");
+    fseek(f, offset, SEEK_SET);
+    fputc(value, f);
+    fclose(f);
+}
+
+// Three records of 10, 0 and 3000 bytes (the last one larger than the stack buffer)
+static void write_three(void) {
+    static unsigned char big[3000];
+    Journal j;
+    memset(big, 'c', sizeof(big));
+    unlink(path);
+    EXPECT(journal_open(&j, path, NULL, NULL));
+    headerSize = (long)j.size;
+    EXPECT(j.records == 0 && file_size() == headerSize);
+    EXPECT(journal_append(&j, "aaaaaaaaaa", 10));
+    recordHeader = (long)j.size - headerSize - 10;
+    EXPECT(recordHeader >= 8);
+    EXPECT(journal_append(&j, "", 0));
+    EXPECT(journal_append(&j, big, sizeof(big)));
+    EXPECT(journal_sync(&j));
+    EXPECT(j.records == 3 && (long)j.size == headerSize + RECORD_SIZE(10) + RECORD_SIZE(0) + RECORD_SIZE(3000));
+    journal_close(&j);
+}
+
+static void test_round_trip(void) {
+    Replayed r = {0};
+    write_three();
+    EXPECT(file_size() == headerSize + RECORD_SIZE(10) + RECORD_SIZE(0) + RECORD_SIZE(3000));
+
+    EXPECT(journal_replay(path, collect, &r) == 3);
+    EXPECT(r.count == 3);
+    EXPECT(r.lens[0] == 10 && r.first[0] == 'a');
+    EXPECT(r.lens[1] == 0);
+    EXPECT(r.lens[2] == 3000 && r.first[2] == 'c');
+
+    // Reopening replays the same records and appends after them
+    Journal j;
+    memset(&r, 0, sizeof(r));
+    EXPECT(journal_open(&j, path, collect, &r));
+    EXPECT(r.count == 3 && j.records == 3 && j.discarded == 0);
+    EXPECT(journal_append(&j, "d", 1));
+    journal_close(&j);
+    memset(&r, 0, sizeof(r));
+    EXPECT(journal_replay(path, collect, &r) == 4);
+    EXPECT(r.first[3] == 'd');
+
+    // Records over the limit are refused
+    EXPECT(journal_open(&j, path, NULL, NULL));
+    static unsigned char huge[JOURNAL_MAX_RECORD + 1];
+    EXPECT(!journal_append(&j, huge, sizeof(huge)));
+    EXPECT(journal_append(&j, huge, JOURNAL_MAX_RECORD));
+    EXPECT(j.records == 5);
+    journal_close(&j);
+    EXPECT(journal_replay(path, NULL, NULL) == 5);
+}
+
+// A crash part-way through a write leaves a torn last record
+static void test_torn_tail(void) {
+    for (int i = 0; i < 3; i++) {
+        Replayed r = {0};
+        Journal j;
+        write_three();
+
+        // Cut inside the payload, inside the record header, and one byte short
+        const long intact = headerSize + RECORD_SIZE(10) + RECORD_SIZE(0);
+        long cuts[] = { intact + 100, intact + 3, intact + RECORD_SIZE(3000) - 1 };
+        damage(cuts[i], -1);
+        EXPECT(journal_replay(path, NULL, NULL) == 2);
+
+        EXPECT(journal_open(&j, path, collect, &r));
+        EXPECT(r.count == 2 && j.records == 2);
+        EXPECT(j.discarded == (size_t)(cuts[i] - intact));
+        EXPECT(j.size == (size_t)intact && file_size() == intact);
+
+        // Appends continue from the clean end
+        EXPECT(journal_append(&j, "e", 1));
+        journal_close(&j);
+        memset(&r, 0, sizeof(r));
+        EXPECT(journal_replay(path, collect, &r) == 3);
+        EXPECT(r.lens[2] == 1 && r.first[2] == 'e');
+    }
+}
+
+// Anything after the first bad record is dropped, even if later ones are intact
+static void test_corrupt(void) {
+    Replayed r = {0};
+    Journal j;
+
+    // Payload byte of the first record: its CRC no longer matches
+    write_three();
+    damage(headerSize + recordHeader + 4, 'x');
+    EXPECT(journal_replay(path, collect, &r) == 0);
+    EXPECT(r.count == 0);
+    EXPECT(journal_open(&j, path, NULL, NULL));
+    EXPECT(j.records == 0 && file_size() == headerSize);
+    journal_close(&j);
+
+    // Length field of the last record beyond JOURNAL_MAX_RECORD
+    write_three();
+    damage(headerSize + RECORD_SIZE(10) + RECORD_SIZE(0) + 2, 0x7F);
+    EXPECT(journal_replay(path, NULL, NULL) == 2);
+    EXPECT(journal_open(&j, path, NULL, NULL));
+    EXPECT(j.records == 2 && (long)j.discarded == RECORD_SIZE(3000));
+    journal_close(&j);
+}
+
+// A write that fails part-way (here: the file size limit) is cut off again,
+// so records appended after it are not lost behind a tear
+static void test_failed_append(void) {
+    static unsigned char big[3000];
+    struct rlimit limit, saved;
+    Replayed r = {0};
+    Journal j;
+
+    write_three();
+    EXPECT(journal_open(&j, path, NULL, NULL));
+    long before = file_size();
+
+    signal(SIGXFSZ, SIG_IGN);
+    getrlimit(RLIMIT_FSIZE, &saved);
+    limit = saved;
+    limit.rlim_cur = (rlim_t)before + 100;
+    EXPECT(setrlimit(RLIMIT_FSIZE, &limit) == 0);
+    memset(big, 'h', sizeof(big));
+    EXPECT(!journal_append(&j, big, sizeof(big)));
+    EXPECT(setrlimit(RLIMIT_FSIZE, &saved) == 0);
+
+    EXPECT(file_size() == before && (long)j.size == before && j.records == 3);
+    EXPECT(journal_append(&j, "i", 1));
+    journal_close(&j);
+    EXPECT(journal_replay(path, collect, &r) == 4);
+    EXPECT(r.lens[3] == 1 && r.first[3] == 'i');
+}
+
+static void test_reset(void) {
+    Journal j;
+    write_three();
+    EXPECT(journal_open(&j, path, NULL, NULL));
+    EXPECT(journal_reset(&j));
+    EXPECT(j.records == 0 && (long)j.size == headerSize && file_size() == headerSize);
+    EXPECT(journal_append(&j, "f", 1));
+    journal_close(&j);
+    EXPECT(journal_replay(path, NULL, NULL) == 1);
+
+    // Closed journals refuse appends
+    EXPECT(!journal_append(&j, "g", 1));
+    EXPECT(!journal_sync(&j));
+}
+
+static void test_not_a_journal(void) {
+    Journal j;
+    unlink(path);
+    EXPECT(journal_replay(path, NULL, NULL) == -1);
+
+    // Empty, short or foreign files replay as nothing
+    FILE* f = fopen(path, "wb");
+    fclose(f);
+    EXPECT(journal_replay(path, NULL, NULL) == -1);
+    f = fopen(path, "wb");
+    fputs("APM", f);
+    fclose(f);
+    EXPECT(journal_replay(path, NULL, NULL) == -1);
+    f = fopen(path, "wb");
+    fputs("not a journal at all", f);
+    fclose(f);
+    EXPECT(journal_replay(path, NULL, NULL) == -1);
+
+    // Opening one for appending starts it over
+    EXPECT(journal_open(&j, path, NULL, NULL));
+    EXPECT(j.records == 0 && j.discarded == 20 && file_size() == headerSize);
+    journal_close(&j);
+    EXPECT(journal_replay(path, NULL, NULL) == 0);
+
+    // A newer format version is not read either
+    write_three();
+    damage(headerSize / 2, 2);
+    EXPECT(journal_replay(path, NULL, NULL) == -1);
+}
+
+int main(void) {
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    snprintf(path, sizeof(path), "%s/history.journal", dir);
+
+    test_round_trip();
+    test_torn_tail();
+    test_corrupt();
+    test_failed_append();
+    test_reset();
+    test_not_a_journal();
+
+    unlink(path);
+    rmdir(dir);
+    return test_report("journal");
+}
@@ -0,0 +1,211 @@
+// test_logger.c
+// Stress-tests the log ring with concurrent writers and checks repeat
+// suppression and rotation in the written files.
+#include <windows.h>
+#include "logger.h"
+#include "test.h"
+#include <sys/stat.h>
+
+#define STRESS_THREADS 8
+#define STRESS_LINES   20000
+
+static char dir[] = "/tmp/apimonitor-logger-XXXXXX";
+
+static void log_line(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    logger_write(format, args);
+    va_end(args);
+}
+
+static char* read_file(const char* name) {
+    char path[MAX_PATH];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* data = (char*)malloc((size_t)size + 1);
+    size_t n = fread(data, 1, (size_t)size, f);
+    data[n] = '\0';
+    fclose(f);
+    return data;
+}
+
+static long file_size(const char* name) {
+    char path[MAX_PATH];
+    struct stat st;
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    return stat(path, &st) == 0 ? (long)st.st_size : -1;
+}
+
+static int start(const char* name) {
+    char path[MAX_PATH];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    return logger_start(path);
+}
+
+// --- Concurrent writers ---
+
+typedef struct {
+    int lines;               // Per writer
+    int burst;               // Lines between pauses
+    int pauseUs;
+} StressLoad;
+
+typedef struct {
+    long lines;
+    long dropped;
+    long reordered;
+    long malformed;
+} StressResult;
+
+static StressLoad load;
+
+static void* stress_writer(void* arg) {
+    int id = (int)(long)arg;
+    for (int i = 0; i < load.lines; i++) {
+        log_line("stress %d %d", id, i);
+        if (i % load.burst == load.burst - 1) usleep(load.pauseUs);
+    }
+    return NULL;
+}
+
+static StressResult run_stress(const char* name) {
+    pthread_t threads[STRESS_THREADS];
+    int next[STRESS_THREADS] = {0};
+    StressResult r = {0};
+
+    logger_configure(1024 * 1024, 1, 0);
+    EXPECT(start(name));
+    for (long i = 0; i < STRESS_THREADS; i++) pthread_create(&threads[i], NULL, stress_writer, (void*)i);
+    for (int i = 0; i < STRESS_THREADS; i++) pthread_join(threads[i], NULL);
+    logger_stop();
+
+    // Every line is either written whole, in its writer's order, or counted as dropped
+    char* data = read_file(name);
+    EXPECT(data != NULL);
+    for (char* line = data; line && *line; ) {
+        char* end = strchr(line, '\n');
+        if (!end) {
+            r.malformed++;
+            break;
+        }
+        *end = '\0';
+        const char* message = strstr(line, "] ");
+        message = message ? strstr(message + 2, "] ") : NULL;
+        int id, seq;
+        long n;
+        if (line[0] != '[' || !strstr(line, "[TID:") || !message) {
+            r.malformed++;
+        } else if (sscanf(message + 2, "stress %d %d", &id, &seq) == 2 && id >= 0 && id < STRESS_THREADS) {
+            if (seq < next[id]) r.reordered++;
+            next[id] = seq + 1;
+            r.lines++;
+        } else if (sscanf(message + 2, "WARNING: %ld log line(s) dropped", &n) == 1) {
+            r.dropped += n;
+        } else {
+            r.malformed++;
+        }
+        line = end + 1;
+    }
+    free(data);
+    printf("  %s: %ld lines written, %ld dropped\n", name, r.lines, r.dropped);
+    return r;
+}
+
+// Writers that together outpace the disk: the ring fills and lines are
+// dropped, but never corrupted or reordered, and the first ringful always
+// gets through
+static void test_stress(void) {
+    load.lines = STRESS_LINES;
+    load.burst = 256;
+    load.pauseUs = 1000;
+    StressResult r = run_stress("stress.log");
+    EXPECT(r.malformed == 0);
+    EXPECT(r.reordered == 0);
+    EXPECT(r.lines >= LOGGER_RING_SLOTS);
+    EXPECT(r.lines + r.dropped == (long)STRESS_THREADS * STRESS_LINES);
+}
+
+// Bursts that together fill half the ring, with pauses the writer can keep
+// up with, like polls logging their results: nothing is dropped
+static void test_paced(void) {
+    load.lines = 2048;
+    load.burst = LOGGER_RING_SLOTS / 2 / STRESS_THREADS;
+    load.pauseUs = 20000;
+    StressResult r = run_stress("paced.log");
+    EXPECT(r.malformed == 0);
+    EXPECT(r.reordered == 0);
+    EXPECT(r.dropped == 0);
+    EXPECT(r.lines == (long)STRESS_THREADS * 2048);
+}
+
+// --- Repeats ---
+
+static void test_repeats(void) {
+    EXPECT(start("repeats.log"));
+    log_line("first");
+    for (int i = 0; i < 5; i++) log_line("same %d", 7);
+    log_line("last");
+    logger_stop();
+
+    char* data = read_file("repeats.log");
+    EXPECT(data != NULL);
+    if (!data) return;
+    const char* same = strstr(data, "] same 7\n");
+    const char* count = strstr(data, "] Previous message repeated 4 more time(s).\n");
+    const char* last = strstr(data, "] last\n");
+    EXPECT(strstr(data, "] first\n") != NULL);
+    EXPECT(same && count && last && same < count && count < last);
+    EXPECT(same && !strstr(same + strlen("] same 7"), "same 7"));
+    free(data);
+}
+
+// --- Rotation ---
+
+static void test_rotation(void) {
+    char text[900];
+    memset(text, 'r', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+
+    logger_configure(64, 2, 1);
+    EXPECT(start("APIMonitor.log"));
+    for (int i = 0; i < 600; i++) {
+        log_line("rotate %d %s", i, text);
+        if (i % 100 == 99) usleep((LOGGER_FLUSH_INTERVAL_MS + 50) * 1000);
+    }
+    logger_stop();
+
+    // Archives shift up and the oldest beyond the limit is deleted
+    EXPECT(file_size("APIMonitor.1.log") > 0);
+    EXPECT(file_size("APIMonitor.2.log") > 0);
+    EXPECT(file_size("APIMonitor.3.log") < 0);
+    const char* names[] = { "APIMonitor.log", "APIMonitor.1.log", "APIMonitor.2.log" };
+    for (int i = 0; i < 3; i++) {
+        EXPECT(file_size(names[i]) <= 64 * 1024 + 512);
+    }
+
+    char* data = read_file("APIMonitor.log");
+    EXPECT(data && strstr(data, "] Log rotated, previous entries are in ") != NULL);
+    EXPECT(data && strstr(data, "APIMonitor.1.log.\n") != NULL);
+    EXPECT(data && strstr(data, "] rotate 599 ") != NULL);
+    free(data);
+}
+
+int main(void) {
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    test_stress();
+    test_paced();
+    test_repeats();
+    test_rotation();
+
+    char command[MAX_PATH + 16];
+    snprintf(command, sizeof(command), "rm -rf %s", dir);
+    if (system(command) != 0) fprintf(stderr, "could not remove %s\n", dir);
+    return test_report("logger");
+}
@@ -0,0 +1,116 @@
+// test_mailbox.c
+// Many producers post records while one consumer drains them, as workers
+// post poll results to the UI thread. The consumer applies each record to a
+// history ring that it alone owns and pages through it between drains, as
+// the History dialog does. Run under ThreadSanitizer by make test-tsan.
+#include <windows.h>
+#include "mailbox.h"
+#include "test.h"
+
+#define PRODUCERS 8
+#define RECORDS   50000      // Per producer
+#define HISTORY   1000
+#define PAGE      64
+
+typedef struct {
+    MailboxNode node;
+    int producer;
+    int seq;
+    char message[32];
+} Record;
+
+static Mailbox mailbox;
+static volatile LONG producersDone;
+static volatile LONG wakeups;
+
+static void* producer(void* arg) {
+    int id = (int)(long)arg;
+    for (int i = 0; i < RECORDS; i++) {
+        Record* r = (Record*)malloc(sizeof(Record));
+        r->producer = id;
+        r->seq = i;
+        snprintf(r->message, sizeof(r->message), "p%d-%d", id, i);
+        // Only the post that finds the mailbox empty wakes the consumer
+        if (mailbox_post(&mailbox, &r->node)) InterlockedIncrement(&wakeups);
+        if (i % 64 == 63) sched_yield();
+    }
+    InterlockedIncrement(&producersDone);
+    return NULL;
+}
+
+static void test_producers(void) {
+    static char history[HISTORY][32];
+    char page[PAGE][32];
+    int next[PRODUCERS] = {0};
+    long total = 0, reordered = 0, corrupt = 0, batches = 0, pages = 0;
+    int head = 0, count = 0;
+    pthread_t threads[PRODUCERS];
+
+    mailbox_init(&mailbox);
+    EXPECT(mailbox_take(&mailbox) == NULL);
+    for (long i = 0; i < PRODUCERS; i++) pthread_create(&threads[i], NULL, producer, (void*)i);
+
+    for (;;) {
+        int finished = InterlockedCompareExchange(&producersDone, 0, 0) == PRODUCERS;
+        MailboxNode* node = mailbox_take(&mailbox);
+        if (node) batches++;
+        else sched_yield();   // The UI thread would wait for the wakeup
+        while (node) {
+            Record* r = (Record*)node;
+            char expected[32];
+            node = node->next;
+
+            // Each producer's records arrive in the order it posted them
+            if (r->seq != next[r->producer]) reordered++;
+            next[r->producer] = r->seq + 1;
+            snprintf(expected, sizeof(expected), "p%d-%d", r->producer, r->seq);
+            if (strcmp(r->message, expected) != 0) corrupt++;
+
+            memcpy(history[head], r->message, sizeof(history[head]));
+            head = (head + 1) % HISTORY;
+            if (count < HISTORY) count++;
+            total++;
+            free(r);
+        }
+
+        // Page the newest entries; nothing else touches the ring
+        for (int i = 0; i < PAGE && i < count; i++) {
+            memcpy(page[i], history[(head - 1 - i + HISTORY) % HISTORY], sizeof(page[i]));
+        }
+        if (count) pages++;
+        // Everything posted before the producers finished was in this take
+        if (finished) break;
+    }
+    for (int i = 0; i < PRODUCERS; i++) pthread_join(threads[i], NULL);
+
+    printf("  %ld records in %ld batches, %ld wakeups, %ld pages\n", total, batches, (long)wakeups, pages);
+    EXPECT(total == (long)PRODUCERS * RECORDS);
+    EXPECT(reordered == 0);
+    EXPECT(corrupt == 0);
+    for (int i = 0; i < PRODUCERS; i++) EXPECT(next[i] == RECORDS);
+    // Each batch holds exactly one post that found the mailbox empty
+    EXPECT(wakeups == batches);
+    EXPECT(count == 0 || page[0][0] == 'p');
+}
+
+static void test_order(void) {
+    Record records[3];
+    mailbox_init(&mailbox);
+    EXPECT(mailbox_post(&mailbox, &records[0].node));
+    EXPECT(!mailbox_post(&mailbox, &records[1].node));
+    EXPECT(!mailbox_post(&mailbox, &records[2].node));
+
+    MailboxNode* node = mailbox_take(&mailbox);
+    EXPECT(node == &records[0].node);
+    EXPECT(node && node->next == &records[1].node);
+    EXPECT(node && node->next && node->next->next == &records[2].node);
+    EXPECT(node && node->next && node->next->next && node->next->next->next == NULL);
+    EXPECT(mailbox_take(&mailbox) == NULL);
+    EXPECT(mailbox_post(&mailbox, &records[0].node));
+}
+
+int main(void) {
+    test_order();
+    test_producers();
+    return test_report("mailbox");
+}
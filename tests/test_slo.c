@@ -0,0 +1,84 @@
+// test_slo.c
+// Slow-poll counts of the latency window against a brute-force history,
+// for every window size.
+#include "slo.h"
+#include "test.h"
+
+static void test_basics(void) {
+    LatencyWindow w;
+
+    // Sizes are clamped to 1..SLO_WINDOW_MAX
+    slo_init(&w, 0);
+    EXPECT(w.size == 1);
+    slo_init(&w, -5);
+    EXPECT(w.size == 1);
+    slo_init(&w, 1000);
+    EXPECT(w.size == SLO_WINDOW_MAX);
+
+    // A poll exactly at the threshold is not slow
+    slo_init(&w, 5);
+    EXPECT(slo_record(&w, 500, 500) == 0);
+    EXPECT(slo_record(&w, 501, 500) == 1);
+
+    // 3 of the last 5: slow polls age out as fast ones arrive
+    EXPECT(slo_record(&w, 900, 500) == 2);
+    EXPECT(slo_record(&w, 100, 500) == 2);
+    EXPECT(slo_record(&w, 700, 500) == 3);
+    EXPECT(slo_record(&w, 100, 500) == 3);   // The first poll (fast) drops out
+    EXPECT(slo_record(&w, 100, 500) == 2);
+    EXPECT(slo_record(&w, 100, 500) == 1);
+    EXPECT(slo_record(&w, 100, 500) == 1);
+    EXPECT(slo_record(&w, 100, 500) == 0);
+
+    // N = 1 follows the last poll only
+    slo_init(&w, 1);
+    EXPECT(slo_record(&w, 900, 500) == 1);
+    EXPECT(slo_record(&w, 900, 500) == 1);
+    EXPECT(slo_record(&w, 100, 500) == 0);
+
+    // Re-initialising forgets everything
+    slo_init(&w, 5);
+    EXPECT(w.slowCount == 0 && w.slow == 0);
+}
+
+// A full 64-poll window saturates and drains exactly
+static void test_full_window(void) {
+    LatencyWindow w;
+    int count = 0;
+    slo_init(&w, SLO_WINDOW_MAX);
+    for (int i = 0; i < 200; i++) count = slo_record(&w, 1000, 10);
+    EXPECT(count == SLO_WINDOW_MAX);
+    for (int i = 1; i <= SLO_WINDOW_MAX; i++) {
+        count = slo_record(&w, 0, 10);
+        if (count != SLO_WINDOW_MAX - i) break;
+    }
+    EXPECT(count == 0);
+}
+
+// Random latencies for every size, against the last N results kept by hand
+static void test_random(void) {
+    unsigned rng = 1;
+    long wrong = 0;
+    for (int size = 1; size <= SLO_WINDOW_MAX; size++) {
+        LatencyWindow w;
+        int history[5000];
+        slo_init(&w, size);
+        for (int i = 0; i < 5000; i++) {
+            rng = rng * 1103515245u + 12345u;
+            unsigned latency = (rng >> 16) % 2000;
+            history[i] = latency > 800;
+
+            int expected = 0;
+            for (int k = i; k >= 0 && k > i - size; k--) expected += history[k];
+            if (slo_record(&w, latency, 800) != expected) wrong++;
+        }
+    }
+    EXPECT(wrong == 0);
+}
+
+int main(void) {
+    test_basics();
+    test_full_window();
+    test_random();
+    return test_report("slo");
+}
@@ -0,0 +1,225 @@
+// test_tseries.c
+// Latency histogram buckets and p95, rollover into minute and hour rollups,
+// rollup rings that grow after wrapping, same-period merges across a
+// restart, and the journal: replay, expiry and compaction.
+#include "tseries.c"
+#include "test.h"
+#include <sys/stat.h>
+
+// Hour-aligned, like a real FILETIME would be after % period
+#define BASE (1000LL * TSERIES_TICKS_PER_HOUR)
+
+static char dir[] = "/tmp/apimonitor-tseries-XXXXXX";
+static char path[MAX_PATH];
+
+static void record(TSeriesStore* s, int series, long long time, unsigned latencyMs, int ok) {
+    TSeriesSample sample = {0};
+    sample.time = time;
+    sample.latencyMs = latencyMs;
+    sample.series = (short)series;
+    sample.ok = (unsigned char)ok;
+    sample.attempts = 1;
+    tseries_record(s, &sample);
+}
+
+// Reopens the journal at now into a fresh store
+static void reopen(TSeriesStore* s, int days, long long now) {
+    EXPECT(tseries_init(s, days));
+    EXPECT(tseries_open(s, path, now));
+}
+
+static void test_hist(void) {
+    // 0-15 ms exact, then 8 buckets per power of two
+    EXPECT(tseries_hist_index(15) == 15 && tseries_hist_upper(15) == 15);
+    EXPECT(tseries_hist_index(16) == 16 && tseries_hist_index(17) == 16);
+    EXPECT(tseries_hist_upper(16) == 17);
+    EXPECT(tseries_hist_index(18) == 17);
+    EXPECT(tseries_hist_index(31) == 23 && tseries_hist_index(32) == 24);
+
+    // The last bucket ends at 2^22 - 1 ms and takes everything beyond
+    EXPECT(tseries_hist_index((1u << 22) - 1) == TSERIES_HIST_BUCKETS - 1);
+    EXPECT(tseries_hist_upper(TSERIES_HIST_BUCKETS - 1) == (1u << 22) - 1);
+    EXPECT(tseries_hist_index(1u << 22) == TSERIES_HIST_BUCKETS - 1);
+    EXPECT(tseries_hist_index(0xFFFFFFFFu) == TSERIES_HIST_BUCKETS - 1);
+
+    // Every value lands in the bucket whose range holds it, no wider than an eighth
+    long wrong = 0;
+    for (unsigned ms = 0; ms < (1u << 22); ms++) {
+        unsigned i = tseries_hist_index(ms);
+        unsigned lower = i ? tseries_hist_upper(i - 1) + 1 : 0;
+        if (i >= TSERIES_HIST_BUCKETS || ms > tseries_hist_upper(i) || ms < lower) wrong++;
+        if (ms >= 16 && tseries_hist_upper(i) - lower + 1 > lower / 8 + 1) wrong++;
+    }
+    EXPECT(wrong == 0);
+}
+
+static void test_rollover(void) {
+    TSeriesStore s;
+    TSeriesRollup r[8];
+    EXPECT(tseries_init(&s, 1));
+    int id = tseries_series(&s, "http://a/");
+    EXPECT(id == 0 && tseries_series(&s, "http://a/") == 0 && tseries_find(&s, "http://b/") == -1);
+
+    // 10, 20, ... 1000 ms in the first minute, every tenth one failed
+    for (int i = 1; i <= 100; i++) record(&s, id, BASE + i * 1000 * TSERIES_TICKS_PER_MS / 2, i * 10, i % 10);
+    EXPECT(tseries_rollups(&s, id, TSERIES_MINUTE, 0, r, 8) == 0);
+
+    // The next minute closes the first
+    record(&s, id, BASE + TSERIES_TICKS_PER_MINUTE, 5, 1);
+    EXPECT(tseries_rollups(&s, id, TSERIES_MINUTE, 0, r, 8) == 1);
+    EXPECT(r[0].start == BASE && r[0].count == 100 && r[0].errors == 10);
+    EXPECT(r[0].minMs == 10 && r[0].maxMs == 1000 && r[0].avgMs == 505);
+    // Exact p95 is 950; the estimate is the top of its bucket, within an eighth
+    EXPECT(r[0].p95Ms >= 950 && r[0].p95Ms <= 950 + 950 / 8);
+    EXPECT(tseries_rollups(&s, id, TSERIES_HOUR, 0, r, 8) == 0);
+
+    // The next hour closes the hour bucket, which holds both minutes
+    record(&s, id, BASE + TSERIES_TICKS_PER_HOUR + 1, 7, 1);
+    EXPECT(tseries_rollups(&s, id, TSERIES_MINUTE, 0, r, 8) == 2);
+    EXPECT(r[1].start == BASE + TSERIES_TICKS_PER_MINUTE && r[1].count == 1 && r[1].p95Ms == 5);
+    EXPECT(tseries_rollups(&s, id, TSERIES_HOUR, 0, r, 8) == 1);
+    EXPECT(r[0].start == BASE && r[0].count == 101 && r[0].minMs == 5 && r[0].maxMs == 1000);
+
+    // from skips older rollups; raw samples are kept per series
+    EXPECT(tseries_rollups(&s, id, TSERIES_MINUTE, BASE + 1, r, 8) == 1);
+    TSeriesSample samples[4];
+    EXPECT(tseries_samples(&s, id, BASE + TSERIES_TICKS_PER_MINUTE, samples, 4) == 2);
+    EXPECT(samples[0].latencyMs == 5 && samples[1].latencyMs == 7);
+    EXPECT(tseries_samples(&s, 1, 0, samples, 4) == 0);
+    EXPECT(tseries_live(&s) == 3);
+    tseries_free(&s);
+}
+
+// A ring that wrapped at its current size (an earlier grow failed) keeps its
+// order when it grows later
+static void test_ring_grow(void) {
+    TSeriesRing ring = {0};
+    TSeriesRollup r = {0};
+    ring.max = 4;
+    for (int i = 1; i <= 6; i++) {
+        r.start = i;
+        tseries_ring_push(&ring, &r);
+    }
+    EXPECT(ring.cap == 4 && ring.count == 4 && ring.head != 0);
+
+    ring.max = 8;
+    for (int i = 7; i <= 9; i++) {
+        r.start = i;
+        tseries_ring_push(&ring, &r);
+    }
+    EXPECT(ring.cap == 8 && ring.count == 7);
+    long wrong = 0;
+    for (unsigned i = 0; i < ring.count; i++) {
+        if (tseries_ring_at(&ring, i)->start != 3 + (long long)i) wrong++;
+    }
+    EXPECT(wrong == 0);
+    free(ring.items);
+}
+
+// A bucket flushed at exit and reopened after a restart is merged into the
+// rollup written before
+static void test_restart_merge(void) {
+    TSeriesStore s;
+    TSeriesRollup r[4];
+    unlink(path);
+
+    reopen(&s, 1, BASE);
+    int id = tseries_series(&s, "http://a/");
+    record(&s, id, BASE + 1, 100, 1);
+    record(&s, id, BASE + 2, 300, 1);
+    tseries_close(&s);
+    tseries_free(&s);
+
+    reopen(&s, 1, BASE + 3);
+    id = tseries_find(&s, "http://a/");
+    EXPECT(id == 0);
+    EXPECT(tseries_rollups(&s, id, TSERIES_MINUTE, 0, r, 4) == 1);
+    EXPECT(r[0].count == 2 && r[0].avgMs == 200);
+    record(&s, id, BASE + 4, 50, 0);
+    record(&s, id, BASE + TSERIES_TICKS_PER_MINUTE, 10, 1);
+    EXPECT(tseries_rollups(&s, id, TSERIES_MINUTE, 0, r, 4) == 1);
+    EXPECT(r[0].start == BASE && r[0].count == 3 && r[0].errors == 1);
+    EXPECT(r[0].minMs == 50 && r[0].maxMs == 300 && r[0].avgMs == 150);
+    tseries_close(&s);
+    tseries_free(&s);
+
+    // Replay merges the two records of that minute the same way
+    reopen(&s, 1, BASE + 5);
+    EXPECT(tseries_rollups(&s, 0, TSERIES_MINUTE, 0, r, 4) == 2);
+    EXPECT(r[0].start == BASE && r[0].count == 3 && r[1].count == 1);
+    EXPECT(tseries_rollups(&s, 0, TSERIES_HOUR, 0, r, 4) == 1);
+    EXPECT(r[0].count == 4);
+    tseries_free(&s);
+}
+
+// 100 hours of one poll a minute, with a day of minutes and hours kept
+static void test_journal(void) {
+    enum { MINUTES = 6000 };
+    TSeriesStore s;
+    static TSeriesRollup r[TSERIES_MINUTE_SLOTS + 1];
+    const long long end = BASE + MINUTES * TSERIES_TICKS_PER_MINUTE;
+    unlink(path);
+
+    reopen(&s, 1, BASE);
+    int a = tseries_series(&s, "http://a/");
+    int b = tseries_series(&s, "http://b/");
+    long piledUp = 0;
+    for (int m = 0; m < MINUTES; m++) {
+        record(&s, a, BASE + m * TSERIES_TICKS_PER_MINUTE + 1, (unsigned)m, 1);
+        // Stale records are compacted away as they pile up
+        if (s.journal.records > 2 * tseries_live(&s) + TSERIES_COMPACT_SLACK) piledUp++;
+    }
+    EXPECT(piledUp == 0);
+    record(&s, b, end - 1, 1, 1);
+    EXPECT(tseries_live(&s) == TSERIES_MINUTE_SLOTS + 24);
+    tseries_close(&s);
+    tseries_free(&s);
+
+    // Replay keeps only what is newer than a day
+    reopen(&s, 1, end);
+    EXPECT(tseries_find(&s, "http://a/") == a && tseries_find(&s, "http://b/") == b);
+    EXPECT(tseries_rollups(&s, a, TSERIES_MINUTE, 0, r, TSERIES_MINUTE_SLOTS + 1) == TSERIES_MINUTE_SLOTS);
+    EXPECT(r[0].start == end - TSERIES_MINUTE_SLOTS * TSERIES_TICKS_PER_MINUTE);
+    EXPECT(r[TSERIES_MINUTE_SLOTS - 1].start == end - TSERIES_TICKS_PER_MINUTE);
+    EXPECT(r[TSERIES_MINUTE_SLOTS - 1].maxMs == MINUTES - 1);
+    EXPECT(tseries_rollups(&s, a, TSERIES_HOUR, 0, r, 32) == 24);
+    EXPECT(r[0].start == end - 24 * TSERIES_TICKS_PER_HOUR && r[0].count == 60);
+    EXPECT(tseries_rollups(&s, b, TSERIES_MINUTE, 0, r, 4) == 1 && r[0].count == 1);
+    size_t records = s.journal.records;
+    EXPECT(records >= tseries_live(&s));
+    tseries_free(&s);
+
+    // Two days later everything has expired, and opening rewrites the file empty
+    reopen(&s, 1, end + 48 * TSERIES_TICKS_PER_HOUR);
+    EXPECT(records > TSERIES_COMPACT_SLACK);
+    EXPECT(tseries_live(&s) == 0 && s.journal.records == 0);
+    EXPECT(journal_replay(path, NULL, NULL) == 0);
+    tseries_free(&s);
+
+    // Without a file the store still works in memory
+    EXPECT(tseries_init(&s, 1));
+    EXPECT(!tseries_open(&s, "/nonexistent/dir/tseries.journal", BASE));
+    a = tseries_series(&s, "http://a/");
+    record(&s, a, BASE, 1, 1);
+    tseries_close(&s);
+    EXPECT(tseries_live(&s) == 2);
+    tseries_free(&s);
+}
+
+int main(void) {
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    snprintf(path, sizeof(path), "%s/tseries.journal", dir);
+
+    test_hist();
+    test_rollover();
+    test_ring_grow();
+    test_restart_merge();
+    test_journal();
+
+    unlink(path);
+    rmdir(dir);
+    return test_report("tseries");
+}
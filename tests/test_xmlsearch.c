@@ -0,0 +1,46 @@
+// test_xmlsearch.c
+// Checks every '<' search the CPU supports against the scalar one.
+//
+// Includes xmlstatus.c to reach its static search functions.
+#include "xmlstatus.c"
+#include "test.h"
+#include <stdlib.h>
+
+#define SEARCH_BUF 200
+
+typedef size_t (*SearchFn)(const char* s, size_t n);
+
+// Every start offset (alignment) and length over buffers with no '<', one
+// '<' at each position, and random text with sparse '<'
+static int compare(SearchFn fn) {
+    static char buf[SEARCH_BUF + 64];
+    int mismatches = 0;
+
+    for (int pattern = 0; pattern < SEARCH_BUF + 2; pattern++) {
+        if (pattern <= SEARCH_BUF) {
+            memset(buf, 'a', sizeof(buf));
+            if (pattern < SEARCH_BUF) buf[pattern] = '<';
+        } else {
+            for (size_t i = 0; i < sizeof(buf); i++) buf[i] = (rand() % 40) ? (char)(rand() % 256) : '<';
+            for (size_t i = 0; i < sizeof(buf); i++) if (buf[i] == '<' && rand() % 2) buf[i] = '>';
+        }
+        for (size_t off = 0; off < 64; off++) {
+            for (size_t n = 0; n + off <= SEARCH_BUF; n++) {
+                if (fn(buf + off, n) != xml_find_lt_scalar(buf + off, n)) mismatches++;
+            }
+        }
+    }
+    return mismatches;
+}
+
+int main(void) {
+    srand(1);
+    printf("'<' search in use: %s\n", xml_status_simd_name());
+#ifdef XML_STATUS_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) EXPECT(compare(xml_find_lt_sse2) == 0);
+    if (__builtin_cpu_supports("avx2")) EXPECT(compare(xml_find_lt_avx2) == 0);
+#endif
+    EXPECT(compare(xml_find_lt) == 0);
+    return test_report("xmlsearch");
+}
@@ -0,0 +1,140 @@
+// test_xmlstatus.c
+// Feeds status documents to the streaming parser split at every chunk
+// boundary and checks the verdict never depends on where the cuts fall.
+#include "xmlstatus.h"
+#include "test.h"
+#include <stdlib.h>
+
+typedef struct {
+    XmlStatusVerdict verdict;
+    char message[256];
+    size_t consumed;          // Bytes fed before the parser said DONE
+} Parsed;
+
+// Feeds doc as pieces of at most chunk bytes, the first one cut at split
+static Parsed parse(const char* doc, size_t len, size_t split, size_t chunk) {
+    XmlStatusParser p;
+    Parsed out;
+    const char* reason;
+    size_t pos = 0;
+
+    xml_status_init(&p);
+    out.consumed = len;
+    while (pos < len) {
+        size_t n = pos == 0 && split ? split : chunk;
+        if (n > len - pos) n = len - pos;
+        if (xml_status_feed(&p, doc + pos, n) == XML_STATUS_DONE) {
+            out.consumed = pos + n;
+            break;
+        }
+        pos += n;
+    }
+    out.verdict = xml_status_verdict(&p, out.message, sizeof(out.message), &reason);
+    return out;
+}
+
+static int failedDocs;
+
+// Every chunk size and every two-way split must give the same verdict
+static void expect_doc(const char* doc, XmlStatusVerdict verdict, const char* message) {
+    size_t len = strlen(doc);
+    int bad = 0;
+
+    for (size_t chunk = 1; chunk <= len + 1; chunk++) {
+        Parsed r = parse(doc, len, 0, chunk);
+        if (r.verdict != verdict || strcmp(r.message, message) != 0) bad++;
+    }
+    for (size_t split = 1; split < len; split++) {
+        Parsed r = parse(doc, len, split, len);
+        if (r.verdict != verdict || strcmp(r.message, message) != 0) bad++;
+    }
+    if (bad && failedDocs++ < 10) {
+        Parsed r = parse(doc, len, 0, len);
+        fprintf(stderr, "  \"%s\": whole document gives %d \"%s\"\n", doc, r.verdict, r.message);
+    }
+    EXPECT(bad == 0);
+}
+
+static void test_verdicts(void) {
+    expect_doc("<status><result>success</result><message> All good </message></status>",
+               XML_STATUS_SUCCESS, "All good");
+    expect_doc("<r> FAIL </r><message>db down</message>", XML_STATUS_FAIL, "db down");
+    expect_doc("<r>Success</r>", XML_STATUS_SUCCESS, "Invalid XML");
+    expect_doc("<result code=\"1\">fail</result>", XML_STATUS_FAIL, "Invalid XML");
+    expect_doc("<message>x < y </mess</message><r>success</r>", XML_STATUS_SUCCESS, "x < y </mess");
+    expect_doc("<<r>success<</r><message>m</message>", XML_STATUS_INVALID, "m");
+    expect_doc("<<r>success</r><message>m<</message>", XML_STATUS_SUCCESS, "m<");
+    expect_doc("<r>maybe</r><message>hm</message>", XML_STATUS_INVALID, "hm");
+    expect_doc("<results>no</results><rx>no</rx><r>success</r>", XML_STATUS_SUCCESS, "Invalid XML");
+    expect_doc("<d>x</d><m><mess>y<r>success</r></m><message>ok</message>", XML_STATUS_SUCCESS, "ok");
+}
+
+static void test_invalid(void) {
+    expect_doc("", XML_STATUS_INVALID, "Empty response");
+    expect_doc("<html>nope</html>", XML_STATUS_INVALID, "No result tag");
+    expect_doc("<r>success", XML_STATUS_INVALID, "Unclosed <r> tag");
+    expect_doc("<result>success</resul", XML_STATUS_INVALID, "Unclosed <result> tag");
+    expect_doc("<result a=<b>success</result>", XML_STATUS_INVALID, "Malformed <result> tag");
+
+    const char* reason = NULL;
+    char message[64];
+    XmlStatusParser p;
+    xml_status_init(&p);
+    xml_status_feed(&p, "<r>ok", 5);
+    EXPECT(xml_status_verdict(&p, message, sizeof(message), &reason) == XML_STATUS_INVALID);
+    EXPECT_STR(reason, "Unclosed <r> tag");
+}
+
+static void test_long_fields(void) {
+    // Text beyond the field sizes is dropped, not overflowed
+    char doc[1200];
+    char expected[256];
+    strcpy(doc, "<r>success</r><message>");
+    size_t len = strlen(doc);
+    memset(doc + len, 'm', 1000);
+    strcpy(doc + len + 1000, "</message>");
+    memset(expected, 'm', 255);
+    expected[255] = '\0';
+
+    Parsed r = parse(doc, strlen(doc), 0, 13);
+    EXPECT(r.verdict == XML_STATUS_SUCCESS);
+    EXPECT_STR(r.message, expected);
+}
+
+static void test_stops_early(void) {
+    // The verdict at the top ends the read; diagnostics behind it are never fed
+    size_t len = 200000;
+    char* doc = (char*)malloc(len + 1);
+    const char* head = "<r>success</r><message>ok</message>";
+    memset(doc, 'x', len);
+    memcpy(doc, head, strlen(head));
+    doc[len] = '\0';
+
+    Parsed r = parse(doc, len, 0, 4096);
+    EXPECT(r.verdict == XML_STATUS_SUCCESS);
+    EXPECT_STR(r.message, "ok");
+    EXPECT(r.consumed == 4096);
+
+    // Without a <message> the parser cannot know it is done
+    memset(doc + 14, 'x', strlen(head) - 14);
+    r = parse(doc, len, 0, 4096);
+    EXPECT(r.verdict == XML_STATUS_SUCCESS);
+    EXPECT(r.consumed == len);
+
+    // Feeding after DONE is harmless
+    XmlStatusParser p;
+    xml_status_init(&p);
+    EXPECT(xml_status_feed(&p, head, strlen(head)) == XML_STATUS_DONE);
+    EXPECT(xml_status_feed(&p, "<r>fail</r>", 11) == XML_STATUS_DONE);
+    char message[64];
+    EXPECT(xml_status_verdict(&p, message, sizeof(message), NULL) == XML_STATUS_SUCCESS);
+    free(doc);
+}
+
+int main(void) {
+    test_verdicts();
+    test_invalid();
+    test_long_fields();
+    test_stops_early();
+    return test_report("xmlstatus");
+}
@@ -0,0 +1,314 @@
+// tseries.c
+#include "tseries.h"
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TSERIES_RING_INITIAL  64
+#define TSERIES_COMPACT_SLACK 1024    // Stale journal records tolerated beyond the live count
+
+static const long long tseries_period[TSERIES_LEVELS] = { TSERIES_TICKS_PER_MINUTE, TSERIES_TICKS_PER_HOUR };
+
+// On-disk record; the series URL follows, urlLen bytes, unterminated
+typedef struct {
+    BYTE level;
+    BYTE reserved[3];
+    DWORD urlLen;
+    TSeriesRollup rollup;
+} TSeriesRecord;
+
+// --- Latency histogram ---
+// Values below 16 ms get a bucket each; above that every power of two is
+// split into 8 buckets, so a bucket is never wider than 1/8 of its values.
+
+static unsigned tseries_hist_index(unsigned ms) {
+    if (ms < 16) return ms;
+    unsigned octave = 4;
+    while (octave < 21 && (ms >> (octave + 1))) octave++;
+    if (ms >> 22) return TSERIES_HIST_BUCKETS - 1;
+    return 16 + (octave - 4) * 8 + ((ms >> (octave - 3)) & 7);
+}
+
+// Largest value that falls into a bucket
+static unsigned tseries_hist_upper(unsigned index) {
+    if (index < 16) return index;
+    unsigned octave = 4 + (index - 16) / 8;
+    unsigned sub = (index - 16) % 8;
+    return ((8 + sub + 1) << (octave - 3)) - 1;
+}
+
+static unsigned tseries_percentile(const TSeriesBucket* b, unsigned pct) {
+    unsigned long long rank = ((unsigned long long)b->count * pct + 99) / 100;
+    unsigned long long seen = 0;
+    if (rank == 0) rank = 1;
+    for (unsigned i = 0; i < TSERIES_HIST_BUCKETS; i++) {
+        seen += b->hist[i];
+        if (seen >= rank) {
+            unsigned v = tseries_hist_upper(i);
+            if (v < b->minMs) v = b->minMs;
+            if (v > b->maxMs) v = b->maxMs;
+            return v;
+        }
+    }
+    return b->maxMs;
+}
+
+// --- Rollup rings ---
+
+static void tseries_merge(TSeriesRollup* into, const TSeriesRollup* r) {
+    unsigned long long total = (unsigned long long)into->avgMs * into->count + (unsigned long long)r->avgMs * r->count;
+    into->count += r->count;
+    into->errors += r->errors;
+    if (r->minMs < into->minMs) into->minMs = r->minMs;
+    if (r->maxMs > into->maxMs) into->maxMs = r->maxMs;
+    // The histograms are gone by now; the larger p95 is the safe estimate
+    if (r->p95Ms > into->p95Ms) into->p95Ms = r->p95Ms;
+    into->avgMs = into->count ? (unsigned)(total / into->count) : 0;
+}
+
+static const TSeriesRollup* tseries_ring_at(const TSeriesRing* ring, unsigned i) {
+    return &ring->items[(ring->head + ring->cap - ring->count + i) % ring->cap];
+}
+
+// Adds a rollup, folding it into the newest one when both cover the same period
+// (a bucket flushed at exit and reopened after a restart)
+static void tseries_ring_push(TSeriesRing* ring, const TSeriesRollup* r) {
+    if (ring->count > 0) {
+        TSeriesRollup* newest = &ring->items[(ring->head + ring->cap - 1) % ring->cap];
+        if (newest->start == r->start) {
+            tseries_merge(newest, r);
+            return;
+        }
+    }
+
+    if (ring->count == ring->cap && ring->cap < ring->max) {
+        unsigned cap = ring->cap ? ring->cap * 2 : TSERIES_RING_INITIAL;
+        if (cap > ring->max) cap = ring->max;
+        TSeriesRollup* items = (TSeriesRollup*)malloc(cap * sizeof(TSeriesRollup));
+        if (items) {
+            // Copied oldest first: after a failed grow the full ring may have wrapped
+            for (unsigned i = 0; i < ring->count; i++) items[i] = *tseries_ring_at(ring, i);
+            free(ring->items);
+            ring->items = items;
+            ring->cap = cap;
+            ring->head = ring->count;
+        }
+    }
+    if (ring->cap == 0) return;
+
+    ring->items[ring->head] = *r;
+    ring->head = (ring->head + 1) % ring->cap;
+    if (ring->count < ring->cap) ring->count++;
+}
+
+// --- Persistence ---
+
+static int tseries_append(Journal* j, const TSeries* series, TSeriesLevel level, const TSeriesRollup* r) {
+    BYTE buf[sizeof(TSeriesRecord) + TSERIES_URL_SIZE];
+    TSeriesRecord rec = {0};
+    size_t urlLen = strlen(series->url);
+    rec.level = (BYTE)level;
+    rec.urlLen = (DWORD)urlLen;
+    rec.rollup = *r;
+    memcpy(buf, &rec, sizeof(rec));
+    memcpy(buf + sizeof(rec), series->url, urlLen);
+    return journal_append(j, buf, sizeof(rec) + urlLen);
+}
+
+// Rewrites the file with only the rollups held in memory
+static int tseries_compact(TSeriesStore* s) {
+    char temp[sizeof(s->path) + 4];
+    snprintf(temp, sizeof(temp), "%s.tmp", s->path);
+    DeleteFileA(temp);
+
+    Journal out;
+    if (!journal_open(&out, temp, NULL, NULL)) return 0;
+    int ok = 1;
+    for (int i = 0; i < s->seriesCount && ok; i++) {
+        for (int level = 0; level < TSERIES_LEVELS && ok; level++) {
+            const TSeriesRing* ring = &s->series[i]->closed[level];
+            for (unsigned k = 0; k < ring->count && ok; k++) {
+                ok = tseries_append(&out, s->series[i], (TSeriesLevel)level, tseries_ring_at(ring, k));
+            }
+        }
+    }
+    ok = ok && journal_sync(&out);
+    journal_close(&out);
+
+    journal_close(&s->journal);
+    ok = ok && MoveFileExA(temp, s->path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+    if (!ok) DeleteFileA(temp);
+    journal_open(&s->journal, s->path, NULL, NULL);
+    return ok;
+}
+
+static void tseries_compact_if_stale(TSeriesStore* s) {
+    if (s->journal.file && s->journal.records > 2 * tseries_live(s) + TSERIES_COMPACT_SLACK) {
+        tseries_compact(s);
+    }
+}
+
+typedef struct {
+    TSeriesStore* store;
+    long long cutoff[TSERIES_LEVELS];   // Rollups starting before this have expired
+} TSeriesLoad;
+
+static void tseries_replay(void* ctx, const void* data, size_t len) {
+    TSeriesLoad* load = (TSeriesLoad*)ctx;
+    TSeriesRecord rec;
+    char url[TSERIES_URL_SIZE];
+    if (len < sizeof(rec)) return;
+    memcpy(&rec, data, sizeof(rec));
+    if (rec.level >= TSERIES_LEVELS || rec.urlLen >= sizeof(url) || len != sizeof(rec) + rec.urlLen) return;
+    if (rec.rollup.start < load->cutoff[rec.level]) return;
+
+    memcpy(url, (const char*)data + sizeof(rec), rec.urlLen);
+    url[rec.urlLen] = '\0';
+    int id = tseries_series(load->store, url);
+    if (id >= 0) tseries_ring_push(&load->store->series[id]->closed[rec.level], &rec.rollup);
+}
+
+// --- Store ---
+
+int tseries_init(TSeriesStore* s, int days) {
+    memset(s, 0, sizeof(*s));
+    if (days < 1) days = 1;
+    if (days > TSERIES_MAX_DAYS) days = TSERIES_MAX_DAYS;
+    s->days = days;
+    s->raw = (TSeriesSample*)calloc(TSERIES_RAW_SLOTS, sizeof(TSeriesSample));
+    return s->raw != NULL;
+}
+
+int tseries_open(TSeriesStore* s, const char* path, long long now) {
+    TSeriesLoad load;
+    load.store = s;
+    load.cutoff[TSERIES_MINUTE] = now - (long long)TSERIES_MINUTE_SLOTS * TSERIES_TICKS_PER_MINUTE;
+    load.cutoff[TSERIES_HOUR] = now - (long long)s->days * 24 * TSERIES_TICKS_PER_HOUR;
+
+    strncpy(s->path, path, sizeof(s->path) - 1);
+    if (!journal_open(&s->journal, path, tseries_replay, &load)) return 0;
+    tseries_compact_if_stale(s);
+    return 1;
+}
+
+static void tseries_close_bucket(TSeriesStore* s, int id, TSeriesLevel level) {
+    TSeries* series = s->series[id];
+    TSeriesBucket* b = &series->open[level];
+    if (b->count == 0) return;
+
+    TSeriesRollup r;
+    r.start = b->start;
+    r.count = b->count;
+    r.errors = b->errors;
+    r.minMs = b->minMs;
+    r.avgMs = (unsigned)(b->sumMs / b->count);
+    r.p95Ms = tseries_percentile(b, 95);
+    r.maxMs = b->maxMs;
+    b->count = 0;
+
+    tseries_ring_push(&series->closed[level], &r);
+    if (s->journal.file) tseries_append(&s->journal, series, level, &r);
+}
+
+void tseries_close(TSeriesStore* s) {
+    for (int i = 0; i < s->seriesCount; i++) {
+        for (int level = 0; level < TSERIES_LEVELS; level++) {
+            tseries_close_bucket(s, i, (TSeriesLevel)level);
+        }
+    }
+    if (!s->journal.file) return;
+    tseries_compact_if_stale(s);
+    journal_sync(&s->journal);
+    journal_close(&s->journal);
+}
+
+void tseries_free(TSeriesStore* s) {
+    for (int i = 0; i < s->seriesCount; i++) {
+        for (int level = 0; level < TSERIES_LEVELS; level++) {
+            free(s->series[i]->closed[level].items);
+        }
+        free(s->series[i]);
+    }
+    free(s->raw);
+    memset(s, 0, sizeof(*s));
+}
+
+int tseries_find(const TSeriesStore* s, const char* url) {
+    for (int i = 0; i < s->seriesCount; i++) {
+        if (strcmp(s->series[i]->url, url) == 0) return i;
+    }
+    return -1;
+}
+
+int tseries_series(TSeriesStore* s, const char* url) {
+    int id = tseries_find(s, url);
+    if (id >= 0 || s->seriesCount == TSERIES_MAX_SERIES) return id;
+
+    TSeries* series = (TSeries*)calloc(1, sizeof(TSeries));
+    if (!series) return -1;
+    strncpy(series->url, url, sizeof(series->url) - 1);
+    series->closed[TSERIES_MINUTE].max = TSERIES_MINUTE_SLOTS;
+    series->closed[TSERIES_HOUR].max = (unsigned)s->days * 24;
+    s->series[s->seriesCount] = series;
+    return s->seriesCount++;
+}
+
+void tseries_record(TSeriesStore* s, const TSeriesSample* sample) {
+    if (!s->raw || sample->series < 0 || sample->series >= s->seriesCount) return;
+
+    s->raw[s->rawHead] = *sample;
+    s->rawHead = (s->rawHead + 1) % TSERIES_RAW_SLOTS;
+    if (s->rawCount < TSERIES_RAW_SLOTS) s->rawCount++;
+
+    TSeries* series = s->series[sample->series];
+    for (int level = 0; level < TSERIES_LEVELS; level++) {
+        TSeriesBucket* b = &series->open[level];
+        long long start = sample->time - sample->time % tseries_period[level];
+        if (b->count > 0 && b->start != start) tseries_close_bucket(s, sample->series, (TSeriesLevel)level);
+        if (b->count == 0) {
+            memset(b, 0, sizeof(*b));
+            b->start = start;
+            b->minMs = sample->latencyMs;
+        }
+        b->count++;
+        if (!sample->ok) b->errors++;
+        if (sample->latencyMs < b->minMs) b->minMs = sample->latencyMs;
+        if (sample->latencyMs > b->maxMs) b->maxMs = sample->latencyMs;
+        b->sumMs += sample->latencyMs;
+        b->hist[tseries_hist_index(sample->latencyMs)]++;
+    }
+    tseries_compact_if_stale(s);
+}
+
+size_t tseries_rollups(const TSeriesStore* s, int series, TSeriesLevel level, long long from,
+                       TSeriesRollup* out, size_t max) {
+    if (series < 0 || series >= s->seriesCount || level >= TSERIES_LEVELS) return 0;
+    const TSeriesRing* ring = &s->series[series]->closed[level];
+    size_t n = 0;
+    for (unsigned i = 0; i < ring->count && n < max; i++) {
+        const TSeriesRollup* r = tseries_ring_at(ring, i);
+        if (r->start >= from) out[n++] = *r;
+    }
+    return n;
+}
+
+size_t tseries_samples(const TSeriesStore* s, int series, long long from, TSeriesSample* out, size_t max) {
+    size_t n = 0;
+    if (!s->raw) return 0;
+    for (unsigned i = 0; i < s->rawCount && n < max; i++) {
+        const TSeriesSample* sample = &s->raw[(s->rawHead + TSERIES_RAW_SLOTS - s->rawCount + i) % TSERIES_RAW_SLOTS];
+        if (sample->series == series && sample->time >= from) out[n++] = *sample;
+    }
+    return n;
+}
+
+size_t tseries_live(const TSeriesStore* s) {
+    size_t live = 0;
+    for (int i = 0; i < s->seriesCount; i++) {
+        for (int level = 0; level < TSERIES_LEVELS; level++) {
+            live += s->series[i]->closed[level].count;
+        }
+    }
+    return live;
+}
@@ -0,0 +1,132 @@
+// tseries.h
+// Per-poll time-series store.
+//
+// Every finished poll is recorded as a sample in a fixed raw ring meant to
+// cover the last hour. Each sample is also folded into the open minute and
+// hour bucket of its series (one series per endpoint URL). When a bucket's
+// period ends it becomes a rollup: poll count, error count and min/avg/p95/max
+// latency. p95 comes from a log-linear histogram kept per open bucket, so it
+// is within an eighth of the exact value.
+//
+// Closed rollups stay in memory (minutes for a day, hours for the retention
+// period) and are appended to a journal file. Loading drops rollups older
+// than the retention period, and the file is rewritten with only the live
+// rollups once most of its records are stale.
+// Not thread-safe: callers serialize access.
+#ifndef TSERIES_H
+#define TSERIES_H
+
+#include <stddef.h>
+#include "journal.h"
+
+#define TSERIES_MAX_SERIES    512      // Distinct endpoint URLs tracked
+#define TSERIES_URL_SIZE      512
+#define TSERIES_RAW_SLOTS     16384    // Raw samples kept, at most an hour's worth
+#define TSERIES_MINUTE_SLOTS  1440     // Minute rollups kept per series (one day)
+#define TSERIES_HIST_BUCKETS  160      // 0-15 ms exact, then 8 buckets per power of two up to ~70 min
+#define TSERIES_DEFAULT_DAYS  30       // Hour rollups kept
+#define TSERIES_MAX_DAYS      365
+
+// Times are FILETIME ticks (100 ns, UTC)
+#define TSERIES_TICKS_PER_MS      10000LL
+#define TSERIES_TICKS_PER_MINUTE  (60LL * 1000 * TSERIES_TICKS_PER_MS)
+#define TSERIES_TICKS_PER_HOUR    (60LL * TSERIES_TICKS_PER_MINUTE)
+
+typedef enum {
+    TSERIES_MINUTE,
+    TSERIES_HOUR,
+    TSERIES_LEVELS
+} TSeriesLevel;
+
+typedef struct {
+    long long time;               // When the poll finished
+    unsigned latencyMs;           // Check start to verdict, retry delays included
+    unsigned bytes;               // Response body bytes kept
+    short series;
+    unsigned char ok;             // Verdict was success
+    unsigned char attempts;
+} TSeriesSample;
+
+typedef struct {
+    long long start;              // Start of the minute or hour
+    unsigned count;
+    unsigned errors;              // Polls whose verdict was not success
+    unsigned minMs;
+    unsigned avgMs;
+    unsigned p95Ms;
+    unsigned maxMs;
+} TSeriesRollup;
+
+// Bucket still collecting samples
+typedef struct {
+    long long start;
+    unsigned count;
+    unsigned errors;
+    unsigned minMs;
+    unsigned maxMs;
+    unsigned long long sumMs;
+    unsigned hist[TSERIES_HIST_BUCKETS];
+} TSeriesBucket;
+
+// Closed rollups, oldest overwritten once max is reached; grows on demand
+typedef struct {
+    TSeriesRollup* items;
+    unsigned cap;
+    unsigned max;
+    unsigned head;                // Next slot written
+    unsigned count;
+} TSeriesRing;
+
+typedef struct {
+    char url[TSERIES_URL_SIZE];
+    TSeriesBucket open[TSERIES_LEVELS];
+    TSeriesRing closed[TSERIES_LEVELS];
+} TSeries;
+
+typedef struct {
+    TSeriesSample* raw;
+    unsigned rawHead;
+    unsigned rawCount;
+
+    TSeries* series[TSERIES_MAX_SERIES];
+    int seriesCount;
+    int days;
+
+    Journal journal;              // Closed rollups; file is NULL when not persisted
+    char path[260];
+} TSeriesStore;
+
+// Allocates the raw ring; days bounds the hour rollups (1..TSERIES_MAX_DAYS)
+int tseries_init(TSeriesStore* s, int days);
+
+// Loads the rollups saved at path (dropping expired ones) and keeps
+// appending to it. Returns 0 if the file cannot be opened; the store then
+// works in memory only.
+int tseries_open(TSeriesStore* s, const char* path, long long now);
+
+// Closes the open buckets into rollups and writes them out
+void tseries_close(TSeriesStore* s);
+
+void tseries_free(TSeriesStore* s);
+
+// Series for a URL, created on first use; -1 when the table is full
+int tseries_series(TSeriesStore* s, const char* url);
+
+// Series for a URL, or -1 if it has none
+int tseries_find(const TSeriesStore* s, const char* url);
+
+// Records a finished poll; sample->series must come from tseries_series()
+void tseries_record(TSeriesStore* s, const TSeriesSample* sample);
+
+// Copies the series' closed rollups starting at or after from, oldest first.
+// Returns the number copied (at most max).
+size_t tseries_rollups(const TSeriesStore* s, int series, TSeriesLevel level, long long from,
+                       TSeriesRollup* out, size_t max);
+
+// Copies the series' raw samples taken at or after from, oldest first
+size_t tseries_samples(const TSeriesStore* s, int series, long long from, TSeriesSample* out, size_t max);
+
+// Rollups currently held in memory, across all series and levels
+size_t tseries_live(const TSeriesStore* s);
+
+#endif // TSERIES_H
@@ -0,0 +1,159 @@
+// url.c
+#include "url.h"
+#include <string.h>
+
+static int url_hex(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static int url_lower(int c) {
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+// Characters a request target may carry unescaped: unreserved, sub-delims, ':', '@', '/', '?'
+static int url_target_char(unsigned char c) {
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) return 1;
+    return strchr("-._~!$&'()*+,;=:@/?", c) != NULL && c != '\0';
+}
+
+// Copies [s, e) into out, decoding %XX; returns 0 on a bad escape, an
+// embedded NUL or if it does not fit
+static int url_decode(const char* s, const char* e, char* out, size_t outSize) {
+    size_t n = 0;
+    while (s < e) {
+        char c = *s++;
+        if (c == '%') {
+            if (e - s < 2 || url_hex(s[0]) < 0 || url_hex(s[1]) < 0) return 0;
+            c = (char)(url_hex(s[0]) * 16 + url_hex(s[1]));
+            if (c == '\0') return 0;
+            s += 2;
+        }
+        if (n + 1 >= outSize) return 0;
+        out[n++] = c;
+    }
+    out[n] = '\0';
+    return 1;
+}
+
+// Parses the host (and port) in [s, e)
+static const char* url_parse_host(const char* s, const char* e, UrlParts* out) {
+    const char* portStart = NULL;
+
+    if (s < e && *s == '[') {
+        // IPv6 literal, optionally with a zone ("%25eth0")
+        const char* close = memchr(s, ']', (size_t)(e - s));
+        if (!close) return "unterminated IPv6 address";
+        const char* zone = memchr(s, '%', (size_t)(close - s));
+        const char* addrEnd = zone ? zone : close;
+        if (addrEnd - s - 1 < 2) return "bad IPv6 address";
+        for (const char* p = s + 1; p < addrEnd; p++) {
+            if (url_hex(*p) < 0 && *p != ':' && *p != '.') return "bad IPv6 address";
+        }
+        if (!url_decode(s + 1, close, out->host, sizeof(out->host))) return "bad IPv6 zone";
+        if (close + 1 < e) {
+            if (close[1] != ':') return "unexpected characters after IPv6 address";
+            portStart = close + 2;
+        }
+    } else {
+        const char* colon = memchr(s, ':', (size_t)(e - s));
+        const char* hostEnd = colon ? colon : e;
+        if (hostEnd == s) return "missing host";
+        for (const char* p = s; p < hostEnd; p++) {
+            unsigned char c = (unsigned char)*p;
+            if (c <= ' ' || c == 0x7F || strchr("\"<>\\^`{|}[]", c)) return "invalid character in host";
+        }
+        if (!url_decode(s, hostEnd, out->host, sizeof(out->host))) return "bad host";
+        if (colon) portStart = colon + 1;
+    }
+
+    if (portStart && portStart < e) {
+        unsigned long port = 0;
+        for (const char* p = portStart; p < e; p++) {
+            if (*p < '0' || *p > '9') return "bad port";
+            port = port * 10 + (unsigned long)(*p - '0');
+            if (port > 65535) return "port out of range";
+        }
+        if (port == 0) return "port out of range";
+        out->port = (unsigned short)port;
+    }
+    return NULL;
+}
+
+const char* url_parse(const char* text, UrlParts* out) {
+    memset(out, 0, sizeof(*out));
+    if (!text) return "empty URL";
+
+    // Surrounding whitespace is a typing accident, not part of the URL
+    const char* s = text;
+    while (*s == ' ' || *s == '\t' || *s == '\r' || *s == '\n') s++;
+    const char* end = s + strlen(s);
+    while (end > s && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) end--;
+    if (s == end) return "empty URL";
+
+    // Scheme
+    out->port = 80;
+    const char* sep = NULL;
+    for (const char* p = s; p + 2 < end; p++) {
+        if (p[0] == ':' && p[1] == '/' && p[2] == '/') { sep = p; break; }
+        if (p[0] == '/' || p[0] == '?' || p[0] == '#' || p[0] == '@') break;
+    }
+    if (sep) {
+        size_t len = (size_t)(sep - s);
+        if (len == 4 && url_lower(s[0]) == 'h' && url_lower(s[1]) == 't' && url_lower(s[2]) == 't' &&
+            url_lower(s[3]) == 'p') {
+            out->secure = 0;
+        } else if (len == 5 && url_lower(s[0]) == 'h' && url_lower(s[1]) == 't' && url_lower(s[2]) == 't' &&
+                   url_lower(s[3]) == 'p' && url_lower(s[4]) == 's') {
+            out->secure = 1;
+            out->port = 443;
+        } else {
+            return "unsupported scheme";
+        }
+        s = sep + 3;
+    }
+
+    // Authority ends at the first '/', '?' or '#'
+    const char* authEnd = s;
+    while (authEnd < end && *authEnd != '/' && *authEnd != '?' && *authEnd != '#') authEnd++;
+
+    // Userinfo is everything before the authority's last '@'
+    const char* hostStart = s;
+    for (const char* p = authEnd; p > s; p--) {
+        if (p[-1] == '@') { hostStart = p; break; }
+    }
+    if (hostStart != s) {
+        const char* infoEnd = hostStart - 1;
+        const char* colon = memchr(s, ':', (size_t)(infoEnd - s));
+        const char* userEnd = colon ? colon : infoEnd;
+        if (!url_decode(s, userEnd, out->user, sizeof(out->user))) return "bad user name";
+        if (colon && !url_decode(colon + 1, infoEnd, out->password, sizeof(out->password))) return "bad password";
+        out->hasUserinfo = 1;
+    }
+
+    const char* error = url_parse_host(hostStart, authEnd, out);
+    if (error) return error;
+
+    // Request target: path and query, fragment dropped
+    const char* targetEnd = memchr(authEnd, '#', (size_t)(end - authEnd));
+    if (!targetEnd) targetEnd = end;
+    size_t n = 0;
+    if (authEnd == targetEnd || *authEnd != '/') out->target[n++] = '/';
+    for (const char* p = authEnd; p < targetEnd; p++) {
+        unsigned char c = (unsigned char)*p;
+        int keep = url_target_char(c) ||
+                   (c == '%' && targetEnd - p > 2 && url_hex(p[1]) >= 0 && url_hex(p[2]) >= 0);
+        if (n + (keep ? 1 : 3) >= sizeof(out->target)) return "URL too long";
+        if (keep) {
+            out->target[n++] = (char)c;
+        } else {
+            out->target[n++] = '%';
+            out->target[n++] = "0123456789ABCDEF"[c >> 4];
+            out->target[n++] = "0123456789ABCDEF"[c & 15];
+        }
+    }
+    out->target[n] = '\0';
+    return NULL;
+}
@@ -0,0 +1,32 @@
+// url.h
+// HTTP(S) URL parser for endpoint URLs (the RFC 3986 subset a poller needs).
+//
+// Splits "scheme://userinfo@host:port/path?query#fragment" into the pieces
+// WinHTTP wants: host (percent-decoded, IPv6 literals without brackets),
+// port (explicit or the scheme's default), the TLS flag, decoded userinfo
+// and the request target. The target is the path plus query, always
+// starting with '/', with the fragment dropped and every byte that may not
+// appear in a request line percent-encoded; existing %XX escapes are kept
+// as they are. A URL without "scheme://" is taken as http.
+// Pure string code: no allocation, no Windows dependency.
+#ifndef URL_H
+#define URL_H
+
+#define URL_HOST_MAX   256
+#define URL_USER_MAX   128
+#define URL_TARGET_MAX 2048
+
+typedef struct {
+    int secure;                    // https
+    char host[URL_HOST_MAX];
+    unsigned short port;
+    int hasUserinfo;               // user (and password) were given
+    char user[URL_USER_MAX];
+    char password[URL_USER_MAX];
+    char target[URL_TARGET_MAX];   // Request target: "/path?query"
+} UrlParts;
+
+// Returns NULL on success, otherwise why the URL was rejected
+const char* url_parse(const char* text, UrlParts* out);
+
+#endif // URL_H
@@ -0,0 +1,303 @@
+// xmlstatus.c
+#include "xmlstatus.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+// Vector search for '<' on x86 GCC/Clang builds; everything else uses memchr
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define XML_STATUS_SIMD 1
+#endif
+
+// Tokenizer states
+#define SCAN_TEXT          0   // Looking for '<'
+#define SCAN_TAG_NAME      1   // Reading a tag name
+#define SCAN_RESULT_ATTRS  2   // Inside <result ...>, waiting for '>'
+#define SCAN_DONE          3
+
+// Capture targets
+#define CAPTURE_NONE       0
+#define CAPTURE_RESULT     1
+#define CAPTURE_MESSAGE    2
+
+// --- '<' search ---
+// Almost every byte of a status document is text between tags, so the parser
+// spends its time skipping to the next '<'. The widest available search runs.
+
+static size_t xml_find_lt_scalar(const char* s, size_t n) {
+    const char* q = (const char*)memchr(s, '<', n);
+    return q ? (size_t)(q - s) : n;
+}
+
+#ifdef XML_STATUS_SIMD
+__attribute__((target("sse2")))
+static size_t xml_find_lt_sse2(const char* s, size_t n) {
+    const __m128i lt = _mm_set1_epi8('<');
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, lt));
+        if (mask) return i + (size_t)__builtin_ctz(mask);
+    }
+    return i + xml_find_lt_scalar(s + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static size_t xml_find_lt_avx2(const char* s, size_t n) {
+    const __m256i lt = _mm256_set1_epi8('<');
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(s + i));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, lt));
+        if (mask) return i + (size_t)__builtin_ctz(mask);
+    }
+    return i + xml_find_lt_sse2(s + i, n - i);
+}
+#endif
+
+typedef size_t (*XmlFindFn)(const char* s, size_t n);
+static XmlFindFn xml_find_lt_impl = NULL;
+
+// Picks the implementation on first use; racing threads pick the same one
+static size_t xml_find_lt_select(const char* s, size_t n) {
+    XmlFindFn fn = xml_find_lt_impl;
+    if (!fn) {
+        fn = xml_find_lt_scalar;
+#ifdef XML_STATUS_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) fn = xml_find_lt_avx2;
+        else if (__builtin_cpu_supports("sse2")) fn = xml_find_lt_sse2;
+#endif
+        xml_find_lt_impl = fn;
+    }
+    return fn(s, n);
+}
+
+// Runs shorter than a vector (tag names, captured values, the gap between
+// adjacent tags) are cheaper to walk than to dispatch
+static size_t xml_find_lt(const char* s, size_t n) {
+    if (n < 16) {
+        size_t i = 0;
+        while (i < n && s[i] != '<') i++;
+        return i;
+    }
+    return xml_find_lt_select(s, n);
+}
+
+const char* xml_status_simd_name(void) {
+    xml_find_lt_select("", 0);
+#ifdef XML_STATUS_SIMD
+    if (xml_find_lt_impl == xml_find_lt_avx2) return "avx2";
+    if (xml_find_lt_impl == xml_find_lt_sse2) return "sse2";
+#endif
+    return "scalar";
+}
+
+void xml_status_init(XmlStatusParser* p) {
+    memset(p, 0, sizeof(*p));
+    p->scan = SCAN_TEXT;
+}
+
+static int xml_status_complete(const XmlStatusParser* p) {
+    return p->malformed || (p->result == XML_TAG_CLOSED && p->message == XML_TAG_CLOSED);
+}
+
+static void xml_status_start_capture(XmlStatusParser* p, int target, const char* closing) {
+    p->scan = SCAN_TEXT;
+    p->capture = target;
+    p->closing = closing;
+    p->closingMatched = 0;
+    if (target == CAPTURE_RESULT) p->result = XML_TAG_OPEN;
+    else p->message = XML_TAG_OPEN;
+}
+
+// Appends captured text; anything beyond the field size is dropped
+static void xml_status_append(XmlStatusParser* p, const char* s, size_t n) {
+    char* dst;
+    size_t* len;
+    size_t cap;
+
+    if (p->capture == CAPTURE_RESULT) {
+        dst = p->resultValue;
+        len = &p->resultLen;
+        cap = sizeof(p->resultValue) - 1;
+    } else {
+        dst = p->messageText;
+        len = &p->messageLen;
+        cap = sizeof(p->messageText) - 1;
+    }
+    if (*len >= cap) return;
+    if (n > cap - *len) n = cap - *len;
+    memcpy(dst + *len, s, n);
+    *len += n;
+    dst[*len] = '\0';
+}
+
+static void xml_status_end_capture(XmlStatusParser* p) {
+    if (p->capture == CAPTURE_RESULT) p->result = XML_TAG_CLOSED;
+    else p->message = XML_TAG_CLOSED;
+    p->capture = CAPTURE_NONE;
+    p->closingMatched = 0;
+    p->scan = SCAN_TEXT;
+}
+
+// Text inside a captured element runs until its closing tag. The closing tag
+// starts with the only '<' it contains, so a mismatch restarts the match at
+// either 0 or 1 characters (a plain substring search, like strstr).
+static void xml_status_capture_char(XmlStatusParser* p, char c) {
+    if (c == p->closing[p->closingMatched]) {
+        if (p->closing[++p->closingMatched] == '\0') xml_status_end_capture(p);
+        return;
+    }
+
+    // Partial match was ordinary text after all
+    xml_status_append(p, p->closing, p->closingMatched);
+    if (c == '<') {
+        p->closingMatched = 1;
+    } else {
+        p->closingMatched = 0;
+        xml_status_append(p, &c, 1);
+    }
+}
+
+// A tag name ended at c; start capturing if it is one we are looking for
+static void xml_status_tag(XmlStatusParser* p, char c) {
+    p->tag[p->tagLen] = '\0';
+    p->scan = SCAN_TEXT;
+
+    if (p->result == XML_TAG_NONE && strcmp(p->tag, "r") == 0 && c == '>') {
+        p->resultShort = 1;
+        xml_status_start_capture(p, CAPTURE_RESULT, "</r>");
+    } else if (p->result == XML_TAG_NONE && strcmp(p->tag, "result") == 0) {
+        p->resultShort = 0;
+        if (c == '>') {
+            xml_status_start_capture(p, CAPTURE_RESULT, "</result>");
+        } else {
+            p->scan = SCAN_RESULT_ATTRS;
+        }
+    } else if (p->message == XML_TAG_NONE && strcmp(p->tag, "message") == 0 && c == '>') {
+        xml_status_start_capture(p, CAPTURE_MESSAGE, "</message>");
+    }
+}
+
+XmlStatusFeed xml_status_feed(XmlStatusParser* p, const char* data, size_t len) {
+    if (p->scan == SCAN_DONE) return XML_STATUS_DONE;
+    p->fed += len;
+
+    for (size_t i = 0; i < len; i++) {
+        // Skip (or copy) a whole run of text up to the next '<' in one search
+        if (p->scan == SCAN_TEXT && p->closingMatched == 0) {
+            size_t run = xml_find_lt(data + i, len - i);
+            if (p->capture != CAPTURE_NONE) xml_status_append(p, data + i, run);
+            i += run;
+            if (i == len) break;
+        }
+
+        char c = data[i];
+
+        if (p->capture != CAPTURE_NONE) {
+            // A closing tag that lies whole in this chunk is matched in one compare
+            size_t closingLen = strlen(p->closing);
+            if (p->closingMatched == 0 && len - i >= closingLen && memcmp(data + i, p->closing, closingLen) == 0) {
+                xml_status_end_capture(p);
+                i += closingLen - 1;
+            } else {
+                xml_status_capture_char(p, c);
+            }
+            if (p->capture == CAPTURE_NONE && xml_status_complete(p)) {
+                p->scan = SCAN_DONE;
+                return XML_STATUS_DONE;
+            }
+            continue;
+        }
+
+        switch (p->scan) {
+            case SCAN_TEXT:
+                if (c == '<') {
+                    // Most tags are ruled out by their first character; skip it here
+                    // when it is in this chunk rather than entering the tag state
+                    if (i + 1 < len && data[i + 1] != 'r' && data[i + 1] != 'm' && data[i + 1] != '<') {
+                        i++;
+                        break;
+                    }
+                    p->scan = SCAN_TAG_NAME;
+                    p->tagLen = 0;
+                }
+                break;
+
+            case SCAN_TAG_NAME:
+                if (c == '<') {
+                    p->tagLen = 0;
+                } else if (p->tagLen == 0 && c != 'r' && c != 'm') {
+                    p->scan = SCAN_TEXT;   // Not <r>, <result> or <message>
+                } else if (c == '>' || isspace((unsigned char)c)) {
+                    xml_status_tag(p, c);
+                } else if (p->tagLen < sizeof(p->tag) - 1) {
+                    p->tag[p->tagLen++] = c;
+                } else {
+                    p->scan = SCAN_TEXT;   // Longer than any name we look for
+                }
+                break;
+
+            case SCAN_RESULT_ATTRS:
+                if (c == '>') {
+                    xml_status_start_capture(p, CAPTURE_RESULT, "</result>");
+                } else if (c == '<') {
+                    p->malformed = 1;
+                    p->scan = SCAN_DONE;
+                    return XML_STATUS_DONE;
+                }
+                break;
+        }
+    }
+    return XML_STATUS_MORE;
+}
+
+// Copies s into out with surrounding whitespace removed
+static void xml_status_trim(const char* s, char* out, size_t outLen) {
+    while (*s && isspace((unsigned char)*s)) s++;
+    size_t n = strlen(s);
+    while (n > 0 && isspace((unsigned char)s[n - 1])) n--;
+    if (n >= outLen) n = outLen - 1;
+    memcpy(out, s, n);
+    out[n] = '\0';
+}
+
+static XmlStatusVerdict xml_status_invalid(const char* what, char* message, size_t messageLen,
+                                           const char** reason) {
+    snprintf(message, messageLen, "%s", what);
+    if (reason) *reason = what;
+    return XML_STATUS_INVALID;
+}
+
+XmlStatusVerdict xml_status_verdict(const XmlStatusParser* p, char* message, size_t messageLen,
+                                    const char** reason) {
+    if (reason) *reason = NULL;
+
+    if (p->fed == 0) return xml_status_invalid("Empty response", message, messageLen, reason);
+    if (p->malformed) return xml_status_invalid("Malformed <result> tag", message, messageLen, reason);
+    if (p->result == XML_TAG_NONE) return xml_status_invalid("No result tag", message, messageLen, reason);
+    if (p->result == XML_TAG_OPEN) {
+        return xml_status_invalid(p->resultShort ? "Unclosed <r> tag" : "Unclosed <result> tag",
+                                  message, messageLen, reason);
+    }
+
+    // An unterminated <message> is ignored rather than failing the verdict
+    if (p->message == XML_TAG_CLOSED) {
+        xml_status_trim(p->messageText, message, messageLen);
+    } else {
+        snprintf(message, messageLen, "%s", "Invalid XML");
+    }
+
+    char value[sizeof(p->resultValue)];
+    xml_status_trim(p->resultValue, value, sizeof(value));
+    for (char* c = value; *c; c++) {
+        *c = (char)tolower((unsigned char)*c);
+    }
+
+    if (strcmp(value, "success") == 0) return XML_STATUS_SUCCESS;
+    if (strcmp(value, "fail") == 0) return XML_STATUS_FAIL;
+    if (reason) *reason = "Unknown result value";
+    return XML_STATUS_INVALID;
+}
@@ -0,0 +1,66 @@
+// xmlstatus.h
+// Incremental parser for the status document returned by a monitored API.
+//
+// The body is fed chunk by chunk as it arrives; tags may be split across any
+// chunk boundary. Once both the <r>/<result> value and the <message> text are
+// known the parser reports XML_STATUS_DONE, so the caller can stop reading
+// and skip whatever diagnostics follow the verdict.
+#ifndef XMLSTATUS_H
+#define XMLSTATUS_H
+
+#include <stddef.h>
+
+typedef enum {
+    XML_STATUS_MORE,     // Keep feeding
+    XML_STATUS_DONE      // Verdict is known (or the document is malformed)
+} XmlStatusFeed;
+
+typedef enum {
+    XML_STATUS_INVALID,
+    XML_STATUS_SUCCESS,
+    XML_STATUS_FAIL
+} XmlStatusVerdict;
+
+typedef enum {
+    XML_TAG_NONE,
+    XML_TAG_OPEN,        // Opening tag seen, collecting its text
+    XML_TAG_CLOSED
+} XmlTagState;
+
+typedef struct {
+    int scan;                 // Tokenizer state (see xmlstatus.c)
+    char tag[16];             // Name of the tag being read
+    size_t tagLen;
+
+    int capture;              // Field receiving text, 0 when none
+    const char* closing;      // Closing tag that ends the capture
+    size_t closingMatched;    // Characters of it matched so far
+
+    XmlTagState result;
+    int resultShort;          // <r> rather than <result>
+    char resultValue[32];
+    size_t resultLen;
+
+    XmlTagState message;
+    char messageText[256];
+    size_t messageLen;
+
+    int malformed;            // <result ...> never closed its opening tag
+    size_t fed;               // Total bytes fed
+} XmlStatusParser;
+
+void xml_status_init(XmlStatusParser* p);
+
+// Feeds the next chunk; returns XML_STATUS_DONE once more data cannot change the outcome
+XmlStatusFeed xml_status_feed(XmlStatusParser* p, const char* data, size_t len);
+
+// Evaluates everything fed so far. message receives the trimmed <message> text,
+// or a short description when the document is unusable; *reason (optional) is
+// set to why the verdict is XML_STATUS_INVALID and NULL otherwise.
+XmlStatusVerdict xml_status_verdict(const XmlStatusParser* p, char* message, size_t messageLen,
+                                    const char** reason);
+
+// Name of the '<' search in use: "avx2", "sse2" or "scalar"
+const char* xml_status_simd_name(void);
+
+#endif // XMLSTATUS_H